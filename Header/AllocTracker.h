@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+// Heap instrumentation, compiled in with the AC_TRACK_ALLOCATIONS build option. It replaces the
+// global operator new/delete (and malloc/free on glibc) and counts every allocation: in total,
+// per frame and per zone. Without the option every call below is a no-op and the counters stay
+// zero, so callers do not need to check.
+#ifndef AC_TRACK_ALLOCATIONS
+#define AC_TRACK_ALLOCATIONS 0
+#endif
+
+struct AllocCounts
+{
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+namespace AllocTracker
+{
+    constexpr bool kEnabled = AC_TRACK_ALLOCATIONS != 0;
+
+    // Counts over all threads since startup.
+    AllocCounts totals();
+    // Closes the current frame; returns and remembers what it allocated on all threads.
+    AllocCounts endFrame();
+    AllocCounts lastFrame();
+
+    // Captures the call stack of every `everyN`th allocation into a fixed ring (0 turns it off).
+    void setSampling(unsigned everyN);
+    // While forbidden every allocation is a violation and its stack is always captured.
+    void setForbidden(bool forbidden);
+    uint64_t violations();
+
+    // Zone totals and captured stacks, written without allocating.
+    void writeReport(FILE* out);
+}
+
+// Attributes allocations made on this thread to `name` (a string literal) while in scope.
+// Zones nest; the innermost one is charged.
+class AllocZone
+{
+public:
+#if AC_TRACK_ALLOCATIONS
+    explicit AllocZone(const char* name);
+    ~AllocZone();
+#else
+    explicit AllocZone(const char*) {}
+#endif
+    AllocZone(const AllocZone&) = delete;
+    AllocZone& operator=(const AllocZone&) = delete;
+
+#if AC_TRACK_ALLOCATIONS
+private:
+    int m_previous = -1;
+#endif
+};
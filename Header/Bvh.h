@@ -0,0 +1,118 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+struct Aabb
+{
+    glm::vec3 min{ 1e30f };
+    glm::vec3 max{ -1e30f };
+
+    void grow(const glm::vec3& p);
+    void grow(const Aabb& b);
+    bool valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    // Half the surface area; only ratios matter for the SAH.
+    float halfArea() const;
+};
+
+struct RayHit
+{
+    float t = 1e30f;
+    int objectId = -1;
+    int triangle = -1; // mesh objects only
+    bool hit() const { return objectId >= 0; }
+};
+
+// Bottom level: a static triangle mesh in model space, split with binned SAH.
+class TriangleBvh
+{
+public:
+    // `positions` holds three vertices per triangle. Subtrees of big meshes are built as jobs
+    // when a job system is given.
+    void build(const std::vector<glm::vec3>& positions, JobSystem* jobs = nullptr);
+    bool empty() const { return m_nodes.empty(); }
+    const Aabb& bounds() const { return m_nodes[0].bounds; }
+    size_t triangleCount() const { return m_indices.size(); }
+
+    // Nearest hit closer than `t`; on a hit updates `t` and `triangle` and returns true.
+    bool intersect(const glm::vec3& origin, const glm::vec3& dir, float& t, int& triangle) const;
+
+private:
+    struct Node
+    {
+        Aabb bounds;
+        uint32_t first = 0; // leaf: first index into m_indices; inner: left child (right is first + 1)
+        uint32_t count = 0; // 0 for inner nodes
+    };
+    struct BuildContext;
+
+    void subdivide(BuildContext& ctx, uint32_t nodeIndex, int depth);
+    bool intersectTriangle(uint32_t tri, const glm::vec3& origin, const glm::vec3& dir, float& t) const;
+
+    std::vector<glm::vec3> m_vertices; // three per triangle
+    std::vector<glm::vec3> m_centroids;
+    std::vector<uint32_t> m_indices;   // triangle order after partitioning
+    std::vector<Node> m_nodes;
+};
+
+// Top level over the pickable scene objects. Objects are world-space boxes or instanced
+// triangle meshes; the tree is rebuilt when objects are added and only refit when they move.
+class SceneBvh
+{
+public:
+    int addBox(const glm::vec3& center, const glm::vec3& halfExtents);
+    // The mesh must outlive the scene.
+    int addMesh(const TriangleBvh* mesh, const glm::mat4& transform);
+    // Setters compare against the stored value and only schedule a refit on change.
+    void setBox(int id, const glm::vec3& center, const glm::vec3& halfExtents);
+    void setTransform(int id, const glm::mat4& transform);
+    void setEnabled(int id, bool enabled);
+
+    // Applies pending changes; call before querying. Cheap when nothing changed.
+    void update();
+
+    // Nearest enabled object along the ray (t in units of `dir`), or a hit() == false result.
+    RayHit intersect(const glm::vec3& origin, const glm::vec3& dir) const;
+    // Four rays traversed as one packet (SSE when available); each result matches intersect().
+    void intersect4(const glm::vec3 (&origins)[4], const glm::vec3 (&dirs)[4], RayHit (&hits)[4]) const;
+    // Batch query; rays are grouped into packets of four.
+    void intersect(const std::vector<glm::vec3>& origins, const std::vector<glm::vec3>& dirs, std::vector<RayHit>& hits) const;
+    // Ids of enabled objects whose world box overlaps `box`.
+    void overlap(const Aabb& box, std::vector<int>& out) const;
+
+    const Aabb& worldBounds(int id) const { return m_objects[static_cast<size_t>(id)].worldBounds; }
+
+private:
+    struct Object
+    {
+        Aabb box;                      // box objects: world box
+        const TriangleBvh* mesh = nullptr;
+        glm::mat4 transform{ 1.0f };
+        glm::mat4 inverse{ 1.0f };
+        Aabb worldBounds;              // empty while disabled
+        bool enabled = true;
+    };
+    struct Node
+    {
+        Aabb bounds;
+        uint32_t first = 0; // leaf: index into m_order; inner: left child (right is first + 1)
+        uint32_t count = 0;
+    };
+
+    void updateWorldBounds(Object& object);
+    void rebuild();
+    void buildNode(uint32_t nodeIndex, int depth);
+    void refit();
+    bool intersectObject(int id, const glm::vec3& origin, const glm::vec3& dir, float& t, int& triangle) const;
+
+    std::vector<Object> m_objects;
+    std::vector<uint32_t> m_order;
+    std::vector<Node> m_nodes;
+    bool m_needsRebuild = false;
+    bool m_needsRefit = false;
+};
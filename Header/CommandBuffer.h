@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Linear list of recorded commands. Each command is a small callable stored inline in
+// fixed-size blocks (no allocation per command, and blocks are reused every frame), so
+// recording is a bump allocation and execution walks memory in order.
+class CommandBuffer
+{
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    CommandBuffer() = default;
+    ~CommandBuffer();
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+    // Stores a copy of `fn`; captures must not refer to data that changes before execute().
+    template <typename F>
+    void record(F&& fn)
+    {
+        using Fn = std::decay_t<F>;
+        static_assert(alignof(Fn) <= kAlign, "command capture is over-aligned");
+        static_assert(sizeof(Fn) + kHeaderSize <= kBlockSize, "command capture is too large");
+
+        const size_t size = kHeaderSize + alignUp(sizeof(Fn));
+        unsigned char* mem = allocate(size);
+        new (mem) Header{ &invoke<Fn>, std::is_trivially_destructible<Fn>::value ? nullptr : &destroy<Fn>, static_cast<uint32_t>(size) };
+        new (mem + kHeaderSize) Fn(std::forward<F>(fn));
+        ++m_count;
+    }
+
+    // Runs every command in recording order, then empties the list (keeping its blocks).
+    void execute();
+    // Drops the recorded commands without running them.
+    void clear();
+
+    size_t commandCount() const { return m_count; }
+    size_t bytesUsed() const;
+
+private:
+    struct Header
+    {
+        void (*run)(void*);
+        void (*destroy)(void*);
+        uint32_t size; // header + payload
+    };
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> data;
+        size_t used = 0;
+    };
+
+    static constexpr size_t kAlign = alignof(std::max_align_t);
+    static constexpr size_t alignUp(size_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+    static constexpr size_t kHeaderSize = (sizeof(Header) + kAlign - 1) & ~(kAlign - 1);
+
+    template <typename Fn>
+    static void invoke(void* p) { (*static_cast<Fn*>(p))(); }
+    template <typename Fn>
+    static void destroy(void* p) { static_cast<Fn*>(p)->~Fn(); }
+
+    unsigned char* allocate(size_t size);
+    void walk(bool run);
+
+    std::vector<Block> m_blocks;
+    size_t m_current = 0; // block being filled
+    size_t m_count = 0;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../Header/GlHandle.h"
+#include "../Header/Renderer2D.h"
+#include "../Header/TemperatureUI.h"
+
+#include <GL/glew.h>
+#include <array>
+#include <memory>
+
+struct AppState;
+class TextRenderer;
+
+// Everything the panel shows; the texture is only redrawn when this changes.
+struct DisplayPanelContent
+{
+    int desiredTemp = 0;
+    int currentTemp = 0;
+    bool isOn = false;
+    StatusCategory status = StatusCategory::Holding;
+
+    bool operator==(const DisplayPanelContent& other) const
+    {
+        return desiredTemp == other.desiredTemp && currentTemp == other.currentTemp
+            && isOn == other.isOn && status == other.status;
+    }
+    bool operator!=(const DisplayPanelContent& other) const { return !(*this == other); }
+};
+
+// Composites the three AC screens (desired temp, current temp, status icon) into one
+// FBO-backed texture, so the model shows them with a single textured draw. Gaps between
+// the screens are left transparent.
+class DisplayPanel
+{
+public:
+    // `screens` are in layout pixels; the texture is rendered `pixelScale` times larger.
+    DisplayPanel(const std::array<RectShape, 3>& screens, float pixelScale = 2.0f);
+    DisplayPanel(const DisplayPanel&) = delete;
+    DisplayPanel& operator=(const DisplayPanel&) = delete;
+
+    // Creates the framebuffer; needs a current GL context.
+    bool init();
+    void setColors(const Color& screenOn, const Color& screenOff, const Color& digits);
+
+    // Re-renders the texture if the displayed content changed; returns true when it did.
+    bool update(const AppState& state, TextRenderer& textRenderer);
+
+    GLuint texture() const { return m_texture; }
+    // Union of the screens in layout pixels; the texture covers exactly this rect.
+    const RectShape& bounds() const { return m_bounds; }
+
+private:
+    void render(TextRenderer& textRenderer);
+
+    std::array<RectShape, 3> m_screens{};   // relative to m_bounds, in layout pixels
+    RectShape m_bounds{};
+    float m_pixelScale = 2.0f;
+    int m_width = 0;
+    int m_height = 0;
+
+    Color m_screenOn{ 0.18f, 0.68f, 0.72f, 1.0f };
+    Color m_screenOff{ 0.08f, 0.10f, 0.12f, 1.0f };
+    Color m_digits{ 0.96f, 0.98f, 1.0f, 1.0f };
+
+    GlFramebuffer m_fbo;
+    GlTexture m_texture;
+    std::unique_ptr<Renderer2D> m_renderer;
+
+    DisplayPanelContent m_content;
+    bool m_valid = false;
+};
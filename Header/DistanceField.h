@@ -0,0 +1,7 @@
+#pragma once
+
+// Converts an 8-bit coverage bitmap (width x height) into a signed distance field of
+// (width + 2 * spread) x (height + 2 * spread) pixels written to `out`.
+// 128 marks the glyph outline; values ramp linearly to 255 `spread` pixels inside
+// and to 0 `spread` pixels outside.
+void buildSignedDistanceField(const unsigned char* coverage, int width, int height, int spread, unsigned char* out);
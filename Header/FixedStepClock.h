@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+// Accumulates variable frame time and hands it out as whole simulation steps of a fixed
+// length, so the simulation behaves the same at any frame rate. Rendering blends the last
+// two simulation states with alpha().
+class FixedStepClock
+{
+public:
+    explicit FixedStepClock(double tickRate = 120.0, int maxStepsPerFrame = 8);
+
+    void setTickRate(double tickRate);
+    void setMaxStepsPerFrame(int maxSteps);
+
+    // Adds frame time and returns how many steps to run now. When more than the clamp would
+    // be due (a long stall), the surplus time is dropped instead of spiralling.
+    int advance(double frameSeconds);
+
+    float step() const { return static_cast<float>(m_step); }
+    double tickRate() const { return 1.0 / m_step; }
+    // Fraction of a step left in the accumulator, for interpolating previous -> current state.
+    float alpha() const { return static_cast<float>(m_accumulator / m_step); }
+    uint64_t ticks() const { return m_ticks; }
+    uint64_t droppedSteps() const { return m_dropped; }
+
+private:
+    double m_step = 1.0 / 120.0;
+    int m_maxSteps = 8;
+    double m_accumulator = 0.0;
+    uint64_t m_ticks = 0;
+    uint64_t m_dropped = 0;
+};
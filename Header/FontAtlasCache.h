@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Metrics of one preloaded atlas cell as stored in a baked atlas file.
+struct BakedGlyph
+{
+    uint32_t codepoint = 0;
+    int32_t slot = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t bearingX = 0;
+    int32_t bearingY = 0;
+    uint32_t advance = 0;
+};
+
+// Read-only view of a baked glyph atlas (header, glyph table, R8 pixels) written by
+// writeFontAtlasFile. The file is memory mapped so the pixels can go straight to
+// glTexImage2D without an intermediate copy; on Windows it is read into memory instead.
+class FontAtlasFile
+{
+public:
+    FontAtlasFile() = default;
+    ~FontAtlasFile();
+    FontAtlasFile(const FontAtlasFile&) = delete;
+    FontAtlasFile& operator=(const FontAtlasFile&) = delete;
+
+    // Fails (without logging) when the file is missing, truncated or baked for a different key.
+    bool open(const std::string& path, uint64_t key);
+    void close();
+
+    int atlasWidth() const { return m_atlasWidth; }
+    int atlasHeight() const { return m_atlasHeight; }
+    int cellSize() const { return m_cellSize; }
+    size_t glyphCount() const { return m_glyphCount; }
+    const BakedGlyph* glyphs() const { return m_glyphs; }
+    const unsigned char* pixels() const { return m_pixels; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<unsigned char> m_buffer; // used when the file could not be mapped
+
+    int m_atlasWidth = 0;
+    int m_atlasHeight = 0;
+    int m_cellSize = 0;
+    size_t m_glyphCount = 0;
+    const BakedGlyph* m_glyphs = nullptr;
+    const unsigned char* m_pixels = nullptr;
+};
+
+// Writes through a temporary file and renames it, so a crash never leaves a half-written cache.
+bool writeFontAtlasFile(const std::string& path, uint64_t key, int atlasWidth, int atlasHeight, int cellSize,
+                        const std::vector<BakedGlyph>& glyphs, const unsigned char* pixels);
+
+// 64-bit FNV-1a; pass a previous result as seed to chain several inputs into one key.
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+bool hashFile(const std::string& path, uint64_t& outHash);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../Header/MemoryLedger.h"
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+// Bump allocator for data that only lives until the end of a frame. Use it through std::pmr
+// containers; deallocation is a no-op and reset() releases everything at once. When a frame
+// needs more than the block holds, the excess comes from the heap and the block is grown at the
+// next reset, so a steady-state frame never touches the global heap. Not thread-safe: each
+// thread that needs one owns its own.
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+    explicit FrameArena(size_t capacity = 256 * 1024);
+    ~FrameArena() override;
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Call at frame end; everything allocated since the last reset becomes invalid.
+    void reset();
+
+    size_t capacity() const { return m_capacity; }
+    size_t bytesUsed() const { return m_used + m_overflowBytes; }
+    // Largest bytesUsed() seen at a reset.
+    size_t highWater() const { return m_highWater; }
+    // Frames that spilled to the heap; stays flat once the block has grown to fit.
+    size_t overflowFrames() const { return m_overflowFrames; }
+
+private:
+    struct Overflow
+    {
+        Overflow* next;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::unique_ptr<unsigned char[]> m_block;
+    size_t m_capacity = 0;
+    size_t m_used = 0;
+    MemoryCharge m_memory;
+
+    Overflow* m_overflow = nullptr;
+    size_t m_overflowBytes = 0;
+    size_t m_highWater = 0;
+    size_t m_overflowFrames = 0;
+};
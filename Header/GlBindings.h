@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../Header/GlHandle.h"
+#include "../Header/RenderStats.h"
+
+#include <GL/glew.h>
+
+// Shadow of the current program and of the GL_TEXTURE_2D binding on texture unit 0, the only
+// unit the renderers sample from. Binding through here drops calls that would not change
+// anything, and the stats passed in count only the binds that reach the driver. Every bind of
+// these two must go through this class, or the shadow goes stale; like GlDeletionQueue, every
+// call must come from the thread that has the context current.
+class GlBindings
+{
+public:
+    // Each returns true when the binding changed.
+    static bool useProgram(GLuint program, RenderStats* stats = nullptr);
+    static bool bindTexture2D(GLuint texture, RenderStats* stats = nullptr);
+
+    // Called when a name is deleted: GL unbinds it, and a later object may reuse the name.
+    static void forget(GlObjectType type, GLuint id);
+};
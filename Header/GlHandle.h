@@ -0,0 +1,85 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+
+enum class GlObjectType : uint8_t
+{
+    Texture,
+    Buffer,
+    VertexArray,
+    Program,
+    Framebuffer,
+    Renderbuffer,
+};
+
+// GL objects are not deleted when their owner lets go of them: a draw that samples a texture
+// may still be queued in the driver. Deletions made during a frame are fenced when the frame
+// ends and only carried out once the GPU has passed that fence. Every call must come from the
+// thread that has the context current.
+class GlDeletionQueue
+{
+public:
+    using RetireFn = void (*)(GlObjectType type, GLuint id, uint64_t key);
+
+    static void defer(GlObjectType type, GLuint id);
+    // Like defer, but once the GPU is done the name is handed to `retire` instead of being deleted.
+    static void recycle(GlObjectType type, GLuint id, RetireFn retire, uint64_t key);
+    // Call once per frame after its last draw: fences the deletions made during the frame and
+    // frees earlier batches whose fence has signaled.
+    static void endFrame();
+    // Waits for every fence and frees everything queued. Deletions made afterwards are dropped,
+    // since the context that owns the objects is about to go away with them.
+    static void shutdown();
+    static size_t pendingCount();
+};
+
+// Move-only owner of one GL object name; converts to the name so it can be passed to GL calls
+// directly. Letting go of the name defers its deletion through GlDeletionQueue.
+template <GlObjectType Type>
+class GlHandle
+{
+public:
+    GlHandle() = default;
+    // Adopts a name created elsewhere (e.g. a linked program).
+    explicit GlHandle(GLuint id) : m_id(id) {}
+    ~GlHandle() { reset(); }
+
+    GlHandle(GlHandle&& other) noexcept : m_id(other.release()) {}
+    GlHandle& operator=(GlHandle&& other) noexcept
+    {
+        if (this != &other) reset(other.release());
+        return *this;
+    }
+    GlHandle(const GlHandle&) = delete;
+    GlHandle& operator=(const GlHandle&) = delete;
+
+    // Generates a fresh name (not valid for programs, which are adopted).
+    static GlHandle create();
+
+    GLuint get() const { return m_id; }
+    operator GLuint() const { return m_id; }
+
+    void reset(GLuint id = 0)
+    {
+        if (m_id != 0) GlDeletionQueue::defer(Type, m_id);
+        m_id = id;
+    }
+    GLuint release()
+    {
+        GLuint id = m_id;
+        m_id = 0;
+        return id;
+    }
+
+private:
+    GLuint m_id = 0;
+};
+
+using GlTexture = GlHandle<GlObjectType::Texture>;
+using GlBuffer = GlHandle<GlObjectType::Buffer>;
+using GlVertexArray = GlHandle<GlObjectType::VertexArray>;
+using GlProgram = GlHandle<GlObjectType::Program>;
+using GlFramebuffer = GlHandle<GlObjectType::Framebuffer>;
+using GlRenderbuffer = GlHandle<GlObjectType::Renderbuffer>;
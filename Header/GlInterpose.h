@@ -0,0 +1,236 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <cstdio>
+
+// Optional dispatch layer between the app and GLEW, compiled in with the AC_GL_INTERPOSE build
+// option. The build force-includes this header into every translation unit, which redirects
+// each GL entry point listed in AC_GL_CALLS to a wrapper. A wrapper can record the call with its
+// arguments, data and CPU time to a trace, and can answer it from a null backend that needs no
+// context. Without the option nothing is redirected and the functions below are no-ops.
+#ifndef AC_GL_INTERPOSE
+#define AC_GL_INTERPOSE 0
+#endif
+
+// Every GL function the app calls. A call missing here still works but bypasses the layer.
+#define AC_GL_CALLS(X) \
+    X(ActiveTexture) X(AttachShader) X(BindBuffer) X(BindFramebuffer) X(BindRenderbuffer) \
+    X(BindTexture) X(BindVertexArray) X(BlendFunc) X(BlendFuncSeparate) X(BlitFramebuffer) \
+    X(BufferData) X(BufferSubData) X(CheckFramebufferStatus) X(Clear) X(ClearBufferfv) \
+    X(ClearBufferuiv) X(ClearColor) X(ClientWaitSync) X(ColorMaski) X(CompileShader) \
+    X(CreateProgram) X(CreateShader) X(CullFace) X(DeleteBuffers) X(DeleteFramebuffers) \
+    X(DeleteProgram) X(DeleteRenderbuffers) X(DeleteShader) X(DeleteSync) X(DeleteTextures) \
+    X(DeleteVertexArrays) X(DepthMask) X(DetachShader) X(Disable) X(DrawArrays) \
+    X(DrawArraysInstanced) X(DrawBuffers) X(Enable) X(EnableVertexAttribArray) X(FenceSync) \
+    X(FramebufferRenderbuffer) X(FramebufferTexture2D) X(GenBuffers) X(GenFramebuffers) \
+    X(GenRenderbuffers) X(GenTextures) X(GenVertexArrays) X(GenerateMipmap) X(GetFloatv) \
+    X(GetIntegerv) X(GetProgramInfoLog) X(GetProgramiv) X(GetShaderInfoLog) X(GetShaderiv) \
+    X(GetUniformLocation) X(IsEnabled) X(LinkProgram) X(MapBufferRange) X(PixelStorei) \
+    X(ReadBuffer) X(ReadPixels) X(RenderbufferStorage) X(ShaderSource) X(TexImage2D) \
+    X(TexParameteri) X(TexSubImage2D) X(Uniform1f) X(Uniform1i) X(Uniform1ui) X(Uniform2f) \
+    X(Uniform3f) X(Uniform4f) X(UniformMatrix4fv) X(UnmapBuffer) X(UseProgram) \
+    X(VertexAttribDivisor) X(VertexAttribPointer) X(Viewport)
+
+namespace GlInterpose
+{
+    constexpr bool kEnabled = AC_GL_INTERPOSE != 0;
+
+    enum class Backend : uint8_t
+    {
+        Driver, // forward to GLEW
+        Null,   // accept every call without a context; generated names and queries are fake
+    };
+
+    void setBackend(Backend backend);
+    Backend backend();
+
+    // Records every GL call from now until frame `frame` (counted by endFrame, from 0) has
+    // ended, then closes `path`. Everything before the frame is kept so a replay can rebuild
+    // the state the frame draws with.
+    bool captureFrame(const char* path, uint64_t frame);
+    // Call after presenting each frame.
+    void endFrame();
+    // GL calls that went through the layer so far.
+    uint64_t callCount();
+
+    struct ReplayResult
+    {
+        uint64_t setupCalls = 0;
+        uint64_t frameCalls = 0;
+        double capturedFrameMs = 0.0; // CPU time the frame's calls took when recorded
+        double replayFrameMs = 0.0;   // average over the repeats
+        uint64_t nameMismatches = 0;  // generated names that differ from the capture
+    };
+
+    // Re-executes a trace on the current context: everything before the captured frame once,
+    // then the frame `repeats` times under a timer. Per-call timings go to `report`.
+    bool replay(const char* path, int repeats, ReplayResult& result, FILE* report);
+}
+
+#if AC_GL_INTERPOSE && !defined(AC_GL_INTERPOSE_IMPL)
+
+#define AC_GL_DECLARE_WRAPPER(name) extern decltype(+gl##name) const acgl##name;
+AC_GL_CALLS(AC_GL_DECLARE_WRAPPER)
+#undef AC_GL_DECLARE_WRAPPER
+
+// A directive cannot come out of a macro, so the redirects are spelled out; keep them in step
+// with AC_GL_CALLS.
+#undef glActiveTexture
+#define glActiveTexture acglActiveTexture
+#undef glAttachShader
+#define glAttachShader acglAttachShader
+#undef glBindBuffer
+#define glBindBuffer acglBindBuffer
+#undef glBindFramebuffer
+#define glBindFramebuffer acglBindFramebuffer
+#undef glBindRenderbuffer
+#define glBindRenderbuffer acglBindRenderbuffer
+#undef glBindTexture
+#define glBindTexture acglBindTexture
+#undef glBindVertexArray
+#define glBindVertexArray acglBindVertexArray
+#undef glBlendFunc
+#define glBlendFunc acglBlendFunc
+#undef glBlendFuncSeparate
+#define glBlendFuncSeparate acglBlendFuncSeparate
+#undef glBlitFramebuffer
+#define glBlitFramebuffer acglBlitFramebuffer
+#undef glBufferData
+#define glBufferData acglBufferData
+#undef glBufferSubData
+#define glBufferSubData acglBufferSubData
+#undef glCheckFramebufferStatus
+#define glCheckFramebufferStatus acglCheckFramebufferStatus
+#undef glClear
+#define glClear acglClear
+#undef glClearBufferfv
+#define glClearBufferfv acglClearBufferfv
+#undef glClearBufferuiv
+#define glClearBufferuiv acglClearBufferuiv
+#undef glClearColor
+#define glClearColor acglClearColor
+#undef glClientWaitSync
+#define glClientWaitSync acglClientWaitSync
+#undef glColorMaski
+#define glColorMaski acglColorMaski
+#undef glCompileShader
+#define glCompileShader acglCompileShader
+#undef glCreateProgram
+#define glCreateProgram acglCreateProgram
+#undef glCreateShader
+#define glCreateShader acglCreateShader
+#undef glCullFace
+#define glCullFace acglCullFace
+#undef glDeleteBuffers
+#define glDeleteBuffers acglDeleteBuffers
+#undef glDeleteFramebuffers
+#define glDeleteFramebuffers acglDeleteFramebuffers
+#undef glDeleteProgram
+#define glDeleteProgram acglDeleteProgram
+#undef glDeleteRenderbuffers
+#define glDeleteRenderbuffers acglDeleteRenderbuffers
+#undef glDeleteShader
+#define glDeleteShader acglDeleteShader
+#undef glDeleteSync
+#define glDeleteSync acglDeleteSync
+#undef glDeleteTextures
+#define glDeleteTextures acglDeleteTextures
+#undef glDeleteVertexArrays
+#define glDeleteVertexArrays acglDeleteVertexArrays
+#undef glDepthMask
+#define glDepthMask acglDepthMask
+#undef glDetachShader
+#define glDetachShader acglDetachShader
+#undef glDisable
+#define glDisable acglDisable
+#undef glDrawArrays
+#define glDrawArrays acglDrawArrays
+#undef glDrawArraysInstanced
+#define glDrawArraysInstanced acglDrawArraysInstanced
+#undef glDrawBuffers
+#define glDrawBuffers acglDrawBuffers
+#undef glEnable
+#define glEnable acglEnable
+#undef glEnableVertexAttribArray
+#define glEnableVertexAttribArray acglEnableVertexAttribArray
+#undef glFenceSync
+#define glFenceSync acglFenceSync
+#undef glFramebufferRenderbuffer
+#define glFramebufferRenderbuffer acglFramebufferRenderbuffer
+#undef glFramebufferTexture2D
+#define glFramebufferTexture2D acglFramebufferTexture2D
+#undef glGenBuffers
+#define glGenBuffers acglGenBuffers
+#undef glGenFramebuffers
+#define glGenFramebuffers acglGenFramebuffers
+#undef glGenRenderbuffers
+#define glGenRenderbuffers acglGenRenderbuffers
+#undef glGenTextures
+#define glGenTextures acglGenTextures
+#undef glGenVertexArrays
+#define glGenVertexArrays acglGenVertexArrays
+#undef glGenerateMipmap
+#define glGenerateMipmap acglGenerateMipmap
+#undef glGetFloatv
+#define glGetFloatv acglGetFloatv
+#undef glGetIntegerv
+#define glGetIntegerv acglGetIntegerv
+#undef glGetProgramInfoLog
+#define glGetProgramInfoLog acglGetProgramInfoLog
+#undef glGetProgramiv
+#define glGetProgramiv acglGetProgramiv
+#undef glGetShaderInfoLog
+#define glGetShaderInfoLog acglGetShaderInfoLog
+#undef glGetShaderiv
+#define glGetShaderiv acglGetShaderiv
+#undef glGetUniformLocation
+#define glGetUniformLocation acglGetUniformLocation
+#undef glIsEnabled
+#define glIsEnabled acglIsEnabled
+#undef glLinkProgram
+#define glLinkProgram acglLinkProgram
+#undef glMapBufferRange
+#define glMapBufferRange acglMapBufferRange
+#undef glPixelStorei
+#define glPixelStorei acglPixelStorei
+#undef glReadBuffer
+#define glReadBuffer acglReadBuffer
+#undef glReadPixels
+#define glReadPixels acglReadPixels
+#undef glRenderbufferStorage
+#define glRenderbufferStorage acglRenderbufferStorage
+#undef glShaderSource
+#define glShaderSource acglShaderSource
+#undef glTexImage2D
+#define glTexImage2D acglTexImage2D
+#undef glTexParameteri
+#define glTexParameteri acglTexParameteri
+#undef glTexSubImage2D
+#define glTexSubImage2D acglTexSubImage2D
+#undef glUniform1f
+#define glUniform1f acglUniform1f
+#undef glUniform1i
+#define glUniform1i acglUniform1i
+#undef glUniform1ui
+#define glUniform1ui acglUniform1ui
+#undef glUniform2f
+#define glUniform2f acglUniform2f
+#undef glUniform3f
+#define glUniform3f acglUniform3f
+#undef glUniform4f
+#define glUniform4f acglUniform4f
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv acglUniformMatrix4fv
+#undef glUnmapBuffer
+#define glUnmapBuffer acglUnmapBuffer
+#undef glUseProgram
+#define glUseProgram acglUseProgram
+#undef glVertexAttribDivisor
+#define glVertexAttribDivisor acglVertexAttribDivisor
+#undef glVertexAttribPointer
+#define glVertexAttribPointer acglVertexAttribPointer
+#undef glViewport
+#define glViewport acglViewport
+
+#endif
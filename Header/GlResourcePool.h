@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../Header/GlHandle.h"
+#include "../Header/MemoryLedger.h"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+
+// Texture owned through the pool; going out of scope returns it to its bucket.
+class PooledTexture
+{
+public:
+    PooledTexture() = default;
+    ~PooledTexture() { reset(); }
+    PooledTexture(PooledTexture&& other) noexcept;
+    PooledTexture& operator=(PooledTexture&& other) noexcept;
+    PooledTexture(const PooledTexture&) = delete;
+    PooledTexture& operator=(const PooledTexture&) = delete;
+
+    GLuint get() const { return m_id; }
+    operator GLuint() const { return m_id; }
+    GLenum internalFormat() const { return m_internalFormat; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    void reset();
+
+private:
+    friend class GlResourcePool;
+
+    GLuint m_id = 0;
+    GLenum m_internalFormat = 0;
+    int m_width = 0;
+    int m_height = 0;
+};
+
+// Buffer owned through the pool; its storage is at least the requested size.
+class PooledBuffer
+{
+public:
+    PooledBuffer() = default;
+    ~PooledBuffer() { reset(); }
+    PooledBuffer(PooledBuffer&& other) noexcept;
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    GLuint get() const { return m_id; }
+    operator GLuint() const { return m_id; }
+    size_t capacity() const { return m_capacity; }
+
+    void reset();
+
+private:
+    friend class GlResourcePool;
+
+    GLuint m_id = 0;
+    size_t m_capacity = 0;
+};
+
+struct GlPoolStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t liveBytes = 0;    // handed out
+    size_t coolingBytes = 0; // released, waiting for the GPU to finish with them
+    size_t idleBytes = 0;    // ready for reuse
+
+    float hitRate() const { return hits + misses > 0 ? static_cast<float>(hits) / static_cast<float>(hits + misses) : 0.0f; }
+};
+
+// Recycles textures by (internal format, width, height) and buffers by power-of-two size
+// class, so replacing a resource is a pool pop plus a sub-image or sub-data update instead of
+// re-specifying storage. Released objects go through GlDeletionQueue and only become reusable
+// once the GPU has finished the frame that last used them. GL thread only, like the queue.
+class GlResourcePool
+{
+public:
+    // Storage is allocated but its contents are undefined; sampler state is whatever the last
+    // user left, so set the parameters you rely on. `category` is what the memory ledger charges.
+    static PooledTexture acquireTexture(MemoryCategory category, GLenum internalFormat, int width, int height);
+    // Dynamic-draw buffer of at least `bytes`.
+    static PooledBuffer acquireBuffer(MemoryCategory category, size_t bytes);
+
+    static GlPoolStats stats();
+    // Frees every idle object and stops pooling; objects released later are deleted.
+    static void shutdown();
+
+private:
+    friend class PooledTexture;
+    friend class PooledBuffer;
+
+    static void release(PooledTexture& texture);
+    static void release(PooledBuffer& buffer);
+};
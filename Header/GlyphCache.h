@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Glyph
+{
+    int width = 0;
+    int height = 0;
+    int bearingX = 0;
+    int bearingY = 0;
+    unsigned int advance = 0;
+    // atlas region covering the glyph plus its padding on every side
+    float u0 = 0.0f;
+    float v0 = 0.0f;
+    float u1 = 0.0f;
+    float v1 = 0.0f;
+    int atlasSlot = -1;
+};
+
+// Codepoint -> Glyph map with O(1) lookups: ASCII/Latin-1 is indexed directly,
+// everything above goes through an open-addressing (linear probing) hash table.
+// Pointers returned by find/insert stay valid only until the next insert.
+class GlyphCache
+{
+public:
+    static constexpr uint32_t kDirectCount = 256;
+
+    GlyphCache();
+
+    Glyph* find(uint32_t codepoint);
+    const Glyph* find(uint32_t codepoint) const;
+    Glyph* insert(uint32_t codepoint, const Glyph& glyph);
+    void erase(uint32_t codepoint);
+    void clear();
+    bool empty() const { return m_count == 0; }
+    size_t size() const { return m_count; }
+    // Host memory held, including the direct table and spare probe capacity.
+    size_t memoryBytes() const { return sizeof(m_direct) + sizeof(m_directUsed) + m_table.capacity() * sizeof(Entry); }
+
+private:
+    enum class SlotState : uint8_t
+    {
+        Empty,
+        Used,
+        Deleted
+    };
+
+    struct Entry
+    {
+        uint32_t codepoint = 0;
+        SlotState state = SlotState::Empty;
+        Glyph glyph;
+    };
+
+    size_t probeStart(uint32_t codepoint) const;
+    void rehash(size_t capacity);
+
+    std::array<Glyph, kDirectCount> m_direct{};
+    std::array<bool, kDirectCount> m_directUsed{};
+    std::vector<Entry> m_table;
+    size_t m_count = 0;
+    size_t m_tableUsed = 0;     // live entries in m_table
+    size_t m_tableDeleted = 0;  // tombstones in m_table
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Number of jobs still outstanding for one batch of work; wait on it with JobSystem::wait().
+class JobCounter
+{
+public:
+    int value() const { return m_value.load(std::memory_order_acquire); }
+    bool done() const { return value() == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<int> m_value{ 0 };
+};
+
+// Work-stealing thread pool. Every thread that submits jobs owns a Chase-Lev deque: it pushes
+// and pops at the bottom, idle threads steal from the top. Waiting on a counter runs queued
+// jobs instead of blocking, so the waiting thread keeps working.
+class JobSystem
+{
+public:
+    // Inline capture storage per job; larger callables must be passed by pointer.
+    static constexpr size_t kJobStorage = 48;
+    // Threads outside the pool (main, simulation, ...) that may submit or wait.
+    static constexpr unsigned kMaxExternalThreads = 4;
+
+    // 0 workers: one per hardware thread, minus the submitting thread.
+    explicit JobSystem(unsigned workerThreads = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Queues fn() on the calling thread's deque; `counter` (optional) is decremented when it ran.
+    template <typename F>
+    void run(F&& fn, JobCounter* counter = nullptr)
+    {
+        using Fn = std::decay_t<F>;
+        static_assert(sizeof(Fn) <= kJobStorage, "job capture too large; capture by pointer");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "job capture is over-aligned");
+
+        Job* job = allocateJob();
+        if (job == nullptr)
+        {
+            // no deque for this thread, or its ring is still in use: run inline, which is always correct
+            fn();
+            return;
+        }
+        new (job->storage) Fn(std::forward<F>(fn));
+        job->invoke = [](Job& j)
+        {
+            Fn* f = reinterpret_cast<Fn*>(j.storage);
+            (*f)();
+            f->~Fn();
+        };
+        job->counter = counter;
+        submit(job);
+    }
+
+    // Returns once `counter` reaches zero, running queued or stolen jobs meanwhile.
+    void wait(const JobCounter& counter);
+
+    // Calls body(begin, end) over [0, count) in batches of at least `minBatch` items and
+    // returns when all are done. The calling thread takes the first batch itself.
+    template <typename F>
+    void parallelFor(size_t count, size_t minBatch, F&& body)
+    {
+        if (count == 0) return;
+        minBatch = std::max<size_t>(minBatch, 1);
+        size_t batches = std::min((count + minBatch - 1) / minBatch, static_cast<size_t>(threadCount()) * 4);
+        if (batches <= 1)
+        {
+            body(size_t(0), count);
+            return;
+        }
+        size_t batchSize = (count + batches - 1) / batches;
+
+        JobCounter counter;
+        auto* bodyPtr = &body;
+        for (size_t begin = batchSize; begin < count; begin += batchSize)
+        {
+            size_t end = std::min(begin + batchSize, count);
+            run([bodyPtr, begin, end]() { (*bodyPtr)(begin, end); }, &counter);
+        }
+        body(size_t(0), std::min(batchSize, count));
+        wait(counter);
+    }
+
+    unsigned workerCount() const { return static_cast<unsigned>(m_workers.size()); }
+    // Pool workers plus the external slots; an upper bound for threadIndex().
+    unsigned threadCount() const { return static_cast<unsigned>(m_slots.size()); }
+    // The calling thread's slot in [0, threadCount()), assigned on first use; external threads
+    // beyond kMaxExternalThreads get threadCount() and run their jobs inline.
+    unsigned threadIndex();
+
+private:
+    struct Job
+    {
+        void (*invoke)(Job&) = nullptr;
+        JobCounter* counter = nullptr;
+        std::atomic<bool> busy{ false }; // queued or running; cleared by execute()
+        alignas(std::max_align_t) unsigned char storage[kJobStorage];
+    };
+
+    // Fixed-capacity Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for
+    // Weak Memory Models"). push/pop belong to the owning thread, steal to everyone else.
+    class Deque
+    {
+    public:
+        static constexpr int64_t kCapacity = 4096;
+        bool push(Job* job);
+        Job* pop();
+        Job* steal();
+
+    private:
+        alignas(64) std::atomic<int64_t> m_top{ 0 };
+        alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+        std::unique_ptr<std::atomic<Job*>[]> m_jobs{ new std::atomic<Job*>[kCapacity] };
+    };
+
+    // Per-thread state. Jobs come from a ring that the owner reuses; when the next entry is
+    // still queued or running, allocateJob() fails and the new job runs inline.
+    struct Slot
+    {
+        static constexpr uint32_t kJobsPerSlot = 4096;
+        Deque deque;
+        std::unique_ptr<Job[]> jobs{ new Job[kJobsPerSlot] };
+        uint32_t nextJob = 0;
+    };
+
+    Job* allocateJob();
+    void submit(Job* job);
+    void execute(Job* job);
+    Job* findJob(unsigned slot);
+    void workerLoop(unsigned slot);
+
+    std::vector<std::unique_ptr<Slot>> m_slots;
+    std::vector<std::thread> m_workers;
+    std::atomic<unsigned> m_nextExternal{ 0 };
+    std::atomic<bool> m_running{ true };
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<int> m_sleeping{ 0 };
+};
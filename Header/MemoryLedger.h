@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+enum class GlObjectType : uint8_t;
+
+enum class MemoryCategory : uint8_t
+{
+    // GPU
+    Textures,       // images and small utility textures
+    RenderTargets,  // framebuffer attachments and readback buffers
+    Meshes,         // static vertex data (cube, loaded models)
+    DynamicBuffers, // per-frame vertex streams (2D batches, text)
+    GlyphAtlas,
+    PoolIdle,       // released to GlResourcePool, kept for reuse
+    // CPU
+    Droplets,
+    Glyphs,
+    MeshStaging,
+    FrameArenas,
+    Count,
+};
+
+constexpr size_t kMemoryCategoryCount = static_cast<size_t>(MemoryCategory::Count);
+
+struct MemoryCategoryTotals
+{
+    int64_t bytes = 0;
+    int64_t peakBytes = 0;
+    int64_t objects = 0;
+};
+
+// Byte counts per category for video memory (tagged per GL object) and long-lived host pools.
+// GL objects are tracked until GlDeletionQueue actually deletes them; anything still tracked at
+// shutdown is reported as a leak. Totals may be read from any thread.
+namespace MemoryLedger
+{
+    const char* name(MemoryCategory category);
+    bool isGpu(MemoryCategory category);
+
+    // Records (or re-tags) the storage behind a GL object; sizes are estimates from format and
+    // dimensions, since GL does not report real allocations.
+    void trackGl(MemoryCategory category, GlObjectType type, uint32_t id, size_t bytes);
+    void untrackGl(GlObjectType type, uint32_t id);
+
+    void addCpu(MemoryCategory category, int64_t bytes);
+
+    MemoryCategoryTotals totals(MemoryCategory category);
+    int64_t gpuBytes();
+    int64_t cpuBytes();
+
+    // Prints every GL object and CPU category still charged; returns false if there were any.
+    bool reportLeaks(FILE* out);
+
+    // Bytes per texel for the sized and unsized formats this app uses.
+    size_t texelBytes(uint32_t internalFormat);
+}
+
+// A host allocation charged to a category for as long as the owner holds it.
+class MemoryCharge
+{
+public:
+    explicit MemoryCharge(MemoryCategory category, size_t bytes = 0);
+    ~MemoryCharge();
+    MemoryCharge(const MemoryCharge&) = delete;
+    MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+    // Adjusts the charge to the owner's current footprint.
+    void set(size_t bytes);
+    size_t bytes() const { return m_bytes; }
+
+private:
+    MemoryCategory m_category;
+    size_t m_bytes = 0;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Hardware counters (cycles, instructions, last-level cache misses, branch misses) read through
+// Linux perf_event_open, per thread, around named zones and whole frames. Counting is opt-in
+// with PerfCounters::enable(). On other platforms, or when the kernel refuses the counters
+// (perf_event_paranoid, virtual machines without a PMU), samples stay empty and
+// unavailableReason() says why, so callers do not need to check.
+#if defined(__linux__)
+#define AC_PERF_COUNTERS 1
+#else
+#define AC_PERF_COUNTERS 0
+#endif
+
+enum class PerfCounter : uint8_t
+{
+    Cycles,
+    Instructions,
+    CacheMisses, // last-level cache
+    BranchMisses,
+    Count
+};
+
+constexpr size_t kPerfCounterCount = static_cast<size_t>(PerfCounter::Count);
+
+struct PerfSample
+{
+    uint64_t values[kPerfCounterCount] = {};
+    uint8_t valid = 0; // bit per PerfCounter that could be read
+
+    bool has(PerfCounter counter) const { return (valid >> static_cast<int>(counter)) & 1; }
+    uint64_t operator[](PerfCounter counter) const { return values[static_cast<size_t>(counter)]; }
+
+    double ipc() const
+    {
+        if (!has(PerfCounter::Cycles) || !has(PerfCounter::Instructions) || (*this)[PerfCounter::Cycles] == 0) return 0.0;
+        return static_cast<double>((*this)[PerfCounter::Instructions]) / static_cast<double>((*this)[PerfCounter::Cycles]);
+    }
+
+    PerfSample& operator+=(const PerfSample& other)
+    {
+        for (size_t i = 0; i < kPerfCounterCount; ++i) values[i] += other.values[i];
+        valid = valid ? valid & other.valid : other.valid;
+        return *this;
+    }
+
+    PerfSample& operator-=(const PerfSample& other)
+    {
+        for (size_t i = 0; i < kPerfCounterCount; ++i) values[i] -= other.values[i];
+        valid &= other.valid;
+        return *this;
+    }
+};
+
+struct PerfZoneTotals
+{
+    const char* name = nullptr;
+    uint64_t entries = 0;
+    PerfSample sample;
+};
+
+namespace PerfCounters
+{
+    constexpr bool kSupported = AC_PERF_COUNTERS != 0;
+
+    // Opens the counters of the calling thread (the frame loop) and lets zones on every other
+    // thread open theirs on first use. False, with the reason set, when even cycles are refused.
+    bool enable();
+    bool enabled();
+    // Null while counting.
+    const char* unavailableReason();
+
+    // Counts of the calling thread since its counters were opened.
+    PerfSample read();
+    // Closes the frame of the calling thread and returns its counts; the last few minutes of
+    // frames are kept for writeTrace.
+    PerfSample endFrame();
+
+    // Fills up to `max` zones in registration order; returns how many there are.
+    size_t zones(PerfZoneTotals* out, size_t max);
+    void writeReport(FILE* out);
+    // Per-frame counters as Chrome trace counter events (chrome://tracing, Perfetto).
+    bool writeTrace(const char* path);
+}
+
+// Adds the calling thread's counts over its scope to zone `name` (a string literal). Zones nest
+// and are inclusive: an inner zone's counts also show in the enclosing one.
+class PerfZone
+{
+public:
+#if AC_PERF_COUNTERS
+    explicit PerfZone(const char* name);
+    ~PerfZone();
+#else
+    explicit PerfZone(const char*) {}
+#endif
+    PerfZone(const PerfZone&) = delete;
+    PerfZone& operator=(const PerfZone&) = delete;
+
+#if AC_PERF_COUNTERS
+private:
+    int m_zone = -1;
+    PerfSample m_start;
+#endif
+};
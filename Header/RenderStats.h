@@ -0,0 +1,48 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+
+// Driver-facing work issued by one renderer since its stats were last reset. Each renderer
+// counts its own calls; the frame loop sums them and resets once per frame.
+struct RenderStats
+{
+    uint32_t drawCalls = 0;
+    uint32_t triangles = 0;
+    uint32_t vertices = 0;
+    // binds that changed the context's state; GlBindings drops the redundant ones
+    uint32_t programSwitches = 0;
+    uint32_t textureBinds = 0;
+    uint32_t uniformUploads = 0;
+    uint64_t bufferBytes = 0;
+    uint64_t textureBytes = 0;
+
+    void addDraw(GLenum mode, uint32_t count, uint32_t instances = 1)
+    {
+        ++drawCalls;
+        vertices += count * instances;
+        if (mode == GL_TRIANGLES) triangles += count / 3 * instances;
+        else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count >= 3) triangles += (count - 2) * instances;
+    }
+
+    RenderStats& operator+=(const RenderStats& other)
+    {
+        drawCalls += other.drawCalls;
+        triangles += other.triangles;
+        vertices += other.vertices;
+        programSwitches += other.programSwitches;
+        textureBinds += other.textureBinds;
+        uniformUploads += other.uniformUploads;
+        bufferBytes += other.bufferBytes;
+        textureBytes += other.textureBytes;
+        return *this;
+    }
+};
+
+// Number of uniform locations that exist, i.e. how many `if (loc >= 0) glUniform*` lines in a
+// block actually reached the driver.
+template <typename... Locations>
+uint32_t liveUniforms(Locations... locations)
+{
+    return ((locations >= 0 ? 1u : 0u) + ... + 0u);
+}
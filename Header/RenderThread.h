@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../Header/CommandBuffer.h"
+#include "../Header/FrameArena.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Owns the GL context on a dedicated thread. The main thread records each frame into a
+// CommandBuffer and submits it; the GL thread executes it and presents while the main thread
+// builds the next frame. In inline mode the same lists run on the calling thread at submit().
+class RenderThread
+{
+public:
+    // `framesInFlight` bounds how many submitted frames may wait for or be on the GL thread.
+    RenderThread(GLFWwindow* window, bool threaded, int framesInFlight = 1);
+    ~RenderThread();
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Moves the context from the calling thread to the GL thread.
+    void start();
+    // Drains submitted frames and makes the context current on the calling thread again.
+    void stop();
+
+    template <typename F>
+    void record(F&& fn) { m_buffers[m_recording]->record(std::forward<F>(fn)); }
+
+    // Ends the frame being recorded. Blocks while the pipeline is full.
+    void submit();
+
+    // Scratch memory for commands, reset after each frame is presented. Only commands may use it.
+    FrameArena& frameArena() { return m_frameArena; }
+
+    bool threaded() const { return m_threaded; }
+    uint64_t presentedFrames() const { return m_presented.load(std::memory_order_acquire); }
+    // When the first frame's swap returned; only valid once presentedFrames() > 0.
+    std::chrono::steady_clock::time_point firstPresentTime() const { return m_firstPresent; }
+    // Share of wall time the GL thread spent executing and presenting over the last second.
+    float utilization() const { return m_utilization.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    void executeAndPresent(CommandBuffer& buffer);
+
+    GLFWwindow* m_window = nullptr;
+    bool m_threaded = true;
+    int m_framesInFlight = 1;
+
+    std::vector<std::unique_ptr<CommandBuffer>> m_buffers; // framesInFlight + 1
+    size_t m_recording = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    size_t m_nextToExecute = 0;
+    int m_pending = 0;
+    bool m_stopping = false;
+
+    FrameArena m_frameArena;
+    std::thread m_thread;
+    std::atomic<uint64_t> m_presented{ 0 };
+    std::chrono::steady_clock::time_point m_firstPresent; // published by the m_presented increment
+    std::atomic<float> m_utilization{ 0.0f };
+};
@@ -2,6 +2,10 @@
 
 #include <string>
 #include <GL/glew.h>
+#include "GlHandle.h"
+#include "GlResourcePool.h"
+#include "MemoryLedger.h"
+#include "RenderStats.h"
 #include <glm/glm.hpp>
 #include <vector>
 
@@ -20,7 +24,8 @@ public:
 
   // draw cube but sample the provided texture (bound to GL_TEXTURE0)
   // color tints the sampled texture (use alpha for mask)
-  void drawTexturedCube(const glm::mat4& model, GLuint texture, const glm::vec3& color = glm::vec3(1.0f));
+  // flipV is for textures uploaded top row first; leave it off for render targets
+  void drawTexturedCube(const glm::mat4& model, GLuint texture, const glm::vec3& color = glm::vec3(1.0f), bool flipV = true);
   // draw semi-transparent particle (approximated sphere as cube)
   void drawParticle(const glm::mat4& model, const glm::vec3& color, float alpha);
 
@@ -39,19 +44,19 @@ private:
 
   std::string loadShaderSource(const char* path);
   unsigned int createShaderProgram(const char* vertPath, const char* fragPath);
-  unsigned int phongProgram_ = 0;
-  unsigned int blinnProgram_ = 0;
+  GlProgram phongProgram_;
+  GlProgram blinnProgram_;
 
 public:
   // set scene light explicitly (independent from AC/lamp)
   void setSceneLight(const glm::vec3& pos, const glm::vec3& color, float intensity);
 
   // cube mesh
-  unsigned int cubeVao_ = 0;
-  unsigned int cubeVbo_ = 0;
+  GlVertexArray cubeVao_;
+  GlBuffer cubeVbo_;
   unsigned int cubeVboCount_ = 0;
 
-  unsigned int defaultTex_ = 0;
+  GlTexture defaultTex_;
 
   // optional lamp parameters set by application
   glm::vec3 lampPos_ = glm::vec3(0.0f);
@@ -60,11 +65,68 @@ public:
   bool lampEnabled_ = false;
 
   // loaded models
-  struct ModelMesh { unsigned int vao; unsigned int vbo; int vertCount; };
+  // positions stay on the CPU (three per triangle) so models can be picked
+  struct ModelMesh { GlVertexArray vao; GlBuffer vbo; int vertCount = 0; std::vector<glm::vec3> positions; };
   std::vector<ModelMesh> models_;
+  // CPU copies of model positions kept for picking
+  MemoryCharge modelPositionsMemory_{MemoryCategory::MeshStaging};
 
 public:
   void setLampLight(const glm::vec3& pos, const glm::vec3& color, float intensity, bool enabled);
   int loadOBJModel(const std::string& path);
+  // The two halves of loadOBJModel: parsing touches no GL state and may run on any thread,
+  // addModel uploads the interleaved pos/normal/uv vertices and must run on the context thread.
+  static bool parseOBJModel(const std::string& path, std::vector<float>& interleaved);
+  int addModel(const std::vector<float>& interleaved);
+  const std::vector<glm::vec3>& modelPositions(int modelId) const;
   void drawModel(int modelId, const glm::mat4& model, const glm::vec3& color);
+
+  // Optional GPU picking: while the ID buffer is enabled the 3D pass renders into an offscreen
+  // target whose second (R32UI) attachment receives the object id of every pixel. Picks are
+  // read back through pixel pack buffers guarded by fences, so they resolve a frame or two
+  // later instead of stalling the pipeline.
+  void setIdBufferEnabled(bool enabled);
+  bool idBufferEnabled() const { return idBufferEnabled_; }
+  // Bracket the 3D pass. beginScene binds and clears the offscreen target (a no-op while the
+  // ID buffer is off); endScene issues any requested pick and copies the color result to the
+  // default framebuffer.
+  void beginScene(int width, int height);
+  void endScene();
+  // Id written by subsequent draws; 0 means background / not pickable.
+  void setObjectId(unsigned int id) { objectId_ = id; }
+  // Reads back the id under framebuffer pixel (x, y), origin top-left, at the next endScene.
+  void requestPick(int x, int y);
+  // Returns true with the id once the oldest pending pick is ready; never blocks.
+  bool pollPick(unsigned int& id);
+
+  // Work issued since the last resetStats(); the frame loop resets once per frame.
+  const RenderStats& stats() const { return stats_; }
+  void resetStats() { stats_ = RenderStats{}; }
+
+private:
+  static const int kPickSlots = 3;
+  struct PickSlot { GlBuffer pbo; GLsync fence = nullptr; };
+
+  void applyObjectId(unsigned int program);
+  bool createIdTargets(int width, int height);
+  void destroyIdTargets();
+  void issuePickReadback();
+
+  RenderStats stats_;
+  bool idBufferEnabled_ = false;
+  bool sceneActive_ = false;
+  unsigned int objectId_ = 0;
+  GlFramebuffer sceneFbo_;
+  PooledTexture sceneColorTex_;
+  PooledTexture sceneIdTex_;
+  GlRenderbuffer sceneDepthRb_;
+  int sceneWidth_ = 0;
+  int sceneHeight_ = 0;
+
+  bool pickRequested_ = false;
+  int pickX_ = 0;
+  int pickY_ = 0;
+  PickSlot pickSlots_[kPickSlots];
+  int pickHead_ = 0;
+  int pickCount_ = 0;
 };
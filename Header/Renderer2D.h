@@ -1,6 +1,13 @@
 #pragma once
 
+#include "../Header/GlHandle.h"
+#include "../Header/GlResourcePool.h"
+#include "../Header/RenderStats.h"
+
 #include <GL/glew.h>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
 
 struct Color
 {
@@ -19,30 +26,72 @@ struct CircleShape
     Color color;
 };
 
-class Renderer;
-
 class Renderer2D
 {
 public:
     Renderer2D(int windowWidth, int windowHeight, const char* vertexShaderPath, const char* fragmentShaderPath);
-    ~Renderer2D();
 
-    void drawRect(float x, float y, float w, float h, const Color& color) const;
-    void drawCircle(float cx, float cy, float radius, const Color& color, int segments = 48) const;
-    void drawFrame(const RectShape& rect, float thickness) const;
-    void drawTriangle(float x1, float y1, float x2, float y2, float x3, float y3, const Color& color) const;
+    void drawRect(float x, float y, float w, float h, const Color& color);
+    void drawCircle(float cx, float cy, float radius, const Color& color, int segments = 48);
+    void drawFrame(const RectShape& rect, float thickness);
+    void drawTriangle(float x1, float y1, float x2, float y2, float x3, float y3, const Color& color);
     void setWindowSize(float width, float height);
 
-    void set3DRenderer(Renderer* r);
+    // Analytic shapes: one instanced quad each, edges anti-aliased by a signed distance
+    // evaluated per fragment, so they stay smooth at any size or angle.
+    void drawRoundedRect(float x, float y, float w, float h, float radius, const Color& color);
+    void drawDisc(float cx, float cy, float radius, const Color& color);
+    // Segment from (x1, y1) to (x2, y2); capsules get round ends, segments square ends.
+    void drawCapsule(float x1, float y1, float x2, float y2, float thickness, const Color& color);
+    void drawSegment(float x1, float y1, float x2, float y2, float thickness, const Color& color);
+    void drawRoundedTriangle(float x1, float y1, float x2, float y2, float x3, float y3, float radius, const Color& color);
+
+    // Batching: between beginBatch() and flush() primitives are only queued, and flush() draws
+    // them with one call per run of flat or shape primitives (switching kinds flushes the pending
+    // run so painter's order holds). Flush before drawing anything else that must appear on top
+    // (text, textures). Outside a batch every primitive is drawn at once.
+    void beginBatch();
+    void flush();
+    bool isBatching() const { return m_batching; }
+
+    // Work issued since the last resetStats().
+    const RenderStats& stats() const { return m_stats; }
+    void resetStats() { m_stats = RenderStats{}; }
 
 private:
+    enum class ShapeKind
+    {
+        RoundedRect,
+        Disc,
+        Capsule,
+        Segment,
+        Triangle
+    };
+
+    // Vertex layout: NDC position (2) + rgba (4).
+    void appendVertex(float px, float py, const Color& color);
+    // Instance layout: pixel bounds (4), shape params (4), more params + kind (4), rgba (4).
+    void appendShape(ShapeKind kind, float minX, float minY, float maxX, float maxY, const float (&params)[7], const Color& color);
+    void endPrimitive();
+    void submitFlat();
+    void submitShapes();
+    // cos/sin pairs for segments + 1 points around the unit circle, built once per segment count
+    const std::vector<float>& unitCircle(int segments);
+
     float m_windowWidth;
     float m_windowHeight;
-    GLuint m_program = 0;
-    GLuint m_vao = 0;
-    GLuint m_vbo = 0;
-    GLint m_uColorLocation = -1;
+    GlProgram m_program;
+    GlVertexArray m_vao;
+    PooledBuffer m_vbo;
+
+    GlProgram m_shapeProgram;
+    GlVertexArray m_shapeVao;
+    PooledBuffer m_shapeVbo;
+    GLint m_uShapeWindowSize = -1;
 
-    // optional 3D renderer to draw placeholders instead of 2D
-    Renderer* renderer3D_ = nullptr;
+    bool m_batching = false;
+    RenderStats m_stats;
+    std::vector<float> m_vertices;
+    std::vector<float> m_shapes;
+    std::unordered_map<int, std::vector<float>> m_circleTables;
 };
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+// Statistical profiler, compiled in with the AC_SAMPLING_PROFILER build option (Linux only; the
+// option also keeps frame pointers). Each registered thread gets a SIGPROF timer on its own CPU
+// clock; the handler walks the frame pointers and appends the raw return addresses to a
+// preallocated buffer without locking. Nothing is symbolized while sampling: writeFolded emits
+// frames as module+offset, and Tools/symbolize_folded.py resolves them offline. Without the
+// option every call below is a no-op.
+#ifndef AC_SAMPLING_PROFILER
+#define AC_SAMPLING_PROFILER 0
+#endif
+
+namespace SamplingProfiler
+{
+    constexpr bool kEnabled = AC_SAMPLING_PROFILER != 0;
+
+    // Installs the handler; threads registered from now on are sampled `hz` times per second
+    // of CPU time they use. Call before the threads to profile are started.
+    bool start(unsigned hz = 499);
+    // Later signals are ignored; samples taken so far stay readable.
+    void stop();
+    bool running();
+
+    uint64_t sampleCount();
+    // samples lost because the buffer was full
+    uint64_t droppedCount();
+
+    // One line per distinct stack, "thread;outermost;...;leaf count", ready for flamegraph.pl.
+    bool writeFolded(const char* path);
+}
+
+// Samples the calling thread while in scope; place one at the top of each thread's entry point.
+class ProfiledThread
+{
+public:
+#if AC_SAMPLING_PROFILER
+    explicit ProfiledThread(const char* name);
+    ~ProfiledThread();
+#else
+    explicit ProfiledThread(const char*) {}
+#endif
+    ProfiledThread(const ProfiledThread&) = delete;
+    ProfiledThread& operator=(const ProfiledThread&) = delete;
+
+#if AC_SAMPLING_PROFILER
+private:
+    void* m_timer = nullptr;
+    bool m_armed = false;
+#endif
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "../Header/FixedStepClock.h"
+#include "../Header/MemoryLedger.h"
+#include "../Header/SpscQueue.h"
+#include "../Header/State.h"
+#include "../Header/TripleBuffer.h"
+
+#include <glm/glm.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <thread>
+
+class JobSystem;
+
+// Droplets live in a fixed pool so snapshots copy without allocating.
+constexpr int kMaxDroplets = 256;
+
+struct DropletState
+{
+    glm::vec3 pos{ 0.0f };
+    glm::vec3 prevPos{ 0.0f };
+    glm::vec3 vel{ 0.0f };
+    float radius = 4.0f;
+};
+
+// Everything the render thread needs from one simulation step. Animated values carry the
+// previous step as well, so the renderer can interpolate between the two.
+struct SimSnapshot
+{
+    AppState state;
+    std::array<DropletState, kMaxDroplets> droplets{};
+    int dropletCount = 0;
+    float lidAngle = 0.0f;
+    float prevLidAngle = 0.0f;
+    float prevVentOpenness = 0.0f;
+    uint64_t tick = 0;
+    float stepSeconds = 0.0f;
+    std::chrono::steady_clock::time_point stepTime{};
+
+    // Fraction of a step elapsed since this snapshot was produced, clamped to [0, 1].
+    float alpha(std::chrono::steady_clock::time_point now) const;
+};
+
+// Input travelling from the render thread to the simulation, in frame order.
+enum class SimEventType : uint8_t
+{
+    Keys,               // key levels sampled once per frame; edges are detected on the sim side
+    TogglePower,
+    ChangeDesiredTemp,
+    ToggleBowl,
+};
+
+struct SimEvent
+{
+    SimEventType type = SimEventType::Keys;
+    bool upPressed = false;
+    bool downPressed = false;
+    bool spacePressed = false;
+    glm::vec3 camPos{ 0.0f };
+    glm::vec3 camForward{ 0.0f, 0.0f, -1.0f };
+    int tempSteps = 0;        // ChangeDesiredTemp: multiples of AppState::tempChangeStep
+    bool respectLock = false; // TogglePower: ignored while a full bowl locks the AC
+};
+
+// Static geometry the droplet physics collides with, in world units.
+struct SimWorld
+{
+    glm::vec3 bowlCenter{ 0.0f };
+    float bowlTopY = 0.0f;
+    float bowlInnerRadius = 0.0f;
+};
+
+// Runs AppState, droplet, vent and lid updates on a fixed step on its own thread. The render
+// thread pushes SimEvents and reads the newest SimSnapshot; neither side takes a lock.
+class Simulation
+{
+public:
+    // Droplet physics is split into jobs when `jobs` is given.
+    Simulation(const AppState& initial, const SimWorld& world, double tickRate, int maxStepsPerFrame, JobSystem* jobs = nullptr);
+    ~Simulation();
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    void start();
+    void stop();
+
+    // Render thread. Returns false (and drops the event) when the queue is full.
+    bool push(const SimEvent& event);
+    // Render thread: picks up the newest published step, if any, and returns it.
+    const SimSnapshot& latest();
+
+    // Share of wall time the simulation thread spent working over the last second.
+    float utilization() const { return m_utilization.load(std::memory_order_relaxed); }
+
+private:
+    enum class DropletFate : uint8_t
+    {
+        Falling,
+        Collected,
+        Lost,
+    };
+
+    void run();
+    void applyEvent(const SimEvent& event);
+    void step(float dt);
+    void stepDroplets(float dt);
+    void publish();
+
+    AppState m_state;
+    SimWorld m_world;
+    FixedStepClock m_clock;
+    JobSystem* m_jobs = nullptr;
+
+    std::array<DropletState, kMaxDroplets> m_droplets{};
+    int m_dropletCount = 0;
+    std::array<DropletFate, kMaxDroplets> m_dropletFate{};
+    float m_spawnAccumulator = 0.0f;
+    std::mt19937 m_rng{ 12345 };
+    float m_lidAngle = 0.0f;
+    float m_prevLidAngle = 0.0f;
+    float m_prevVentOpenness = 0.0f;
+
+    SpscQueue<SimEvent, 256> m_events;
+    TripleBuffer<SimSnapshot> m_snapshots;
+    // droplet pool plus the copies held by the snapshot buffers
+    MemoryCharge m_dropletMemory{ MemoryCategory::Droplets, sizeof(m_droplets) + sizeof(m_dropletFate) + 3 * sizeof(SimSnapshot::droplets) };
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{ false };
+    std::atomic<float> m_utilization{ 0.0f };
+};
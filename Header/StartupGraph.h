@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <initializer_list>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// Startup as a graph of init tasks. Each task names the tasks it must run after and where it
+// runs: CPU-only work (file parsing, pixel generation, BVH builds) goes to the job system, GL
+// and GLFW work stays on the thread that owns the context. Every task is timed, together with
+// spans recorded around work done outside the graph, so startup can be written as a Chrome
+// trace and the time to the first presented frame reported.
+class StartupGraph
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Where
+    {
+        Worker,
+        Context
+    };
+
+    // `origin` is time zero of the trace, normally the top of main. The constructing thread is
+    // taken to be the context thread.
+    explicit StartupGraph(Clock::time_point origin);
+
+    // Returns the task's id; `after` lists ids returned earlier.
+    int add(const char* name, Where where, std::function<void()> fn, std::initializer_list<int> after = {});
+    // Runs every task added so far and returns when all are done. Must be called on the
+    // context thread; worker tasks run inline when the pool has no workers.
+    void run(JobSystem& jobs);
+
+    // Adds work timed outside the graph, on the calling thread.
+    void record(const char* name, Clock::time_point start, Clock::time_point end = Clock::now());
+    void markFirstFrame(Clock::time_point when = Clock::now());
+    // Milliseconds from the origin to markFirstFrame; negative before it.
+    float timeToFirstFrameMs() const;
+
+    // Wall time of the last run against the summed time of its tasks, then one line per task.
+    void writeReport(FILE* out) const;
+    // Complete ("X") events per task and span, plus an instant event at the first frame.
+    bool writeTrace(const char* path) const;
+
+private:
+    struct Span
+    {
+        const char* name = nullptr;
+        int thread = 0; // 0 is the context thread, workers are their job-system slot + 1
+        Clock::time_point start;
+        Clock::time_point end;
+    };
+
+    struct Task
+    {
+        Where where = Where::Context;
+        std::function<void()> fn;
+        std::vector<int> dependents;
+        int pending = 0;
+        Span span;
+    };
+
+    void execute(Task& task, JobSystem& jobs);
+    float sinceOrigin(Clock::time_point t) const;
+
+    Clock::time_point m_origin;
+    std::thread::id m_contextThread;
+    std::vector<Task> m_tasks;
+    std::vector<Span> m_spans; // recorded spans and the tasks of finished runs
+    Clock::time_point m_runStart;
+    Clock::time_point m_runEnd;
+    Clock::duration m_runTaskTime{};
+    size_t m_runTasks = 0;
+    Clock::time_point m_firstFrame;
+    bool m_hasFirstFrame = false;
+};
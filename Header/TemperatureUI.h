@@ -3,5 +3,14 @@
 #include "../Header/Renderer2D.h"
 #include "../Header/TextRenderer.h"
 
+// Which icon the status screen shows for a desired/current temperature pair.
+enum class StatusCategory
+{
+    Heating,
+    Cooling,
+    Holding
+};
+
+StatusCategory statusCategory(float desired, float current);
 void drawTemperatureValue(TextRenderer& textRenderer, float value, const RectShape& screen, const Color& color);
 void drawStatusIcon(Renderer2D& renderer, const RectShape& screen, float desired, float current);
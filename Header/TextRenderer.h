@@ -1,20 +1,29 @@
 #pragma once
 
+#include "../Header/GlHandle.h"
+#include "../Header/GlResourcePool.h"
+#include "../Header/MemoryLedger.h"
+#include "../Header/GlyphCache.h"
 #include "../Header/Renderer2D.h"
+#include "../Header/RenderStats.h"
 
 #include <GL/glew.h>
-#include <map>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
-struct Glyph
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+class JobSystem;
+
+// How glyphs are stored in the atlas: plain coverage bitmaps, or signed distance
+// fields that stay sharp when scaled far beyond the rasterized pixel height.
+enum class GlyphRasterMode
 {
-    GLuint texture = 0;
-    int width = 0;
-    int height = 0;
-    int bearingX = 0;
-    int bearingY = 0;
-    unsigned int advance = 0;
+    Bitmap,
+    SignedDistance
 };
 
 struct TextMetrics
@@ -24,36 +33,144 @@ struct TextMetrics
     float ascent = 0.0f;
 };
 
+class TextRenderer;
+
+// Text shaped once into a cached quad list and vertex buffer. The layout is rebuilt only
+// when the text, scale or colors change (or glyphs it uses were evicted from the atlas);
+// drawing a clean run is a single draw with no CPU layout work.
+class TextRun
+{
+public:
+    TextRun() = default;
+    TextRun(const TextRun&) = delete;
+    TextRun& operator=(const TextRun&) = delete;
+
+    // Each setter compares against the current value and only marks the run dirty on change.
+    void setText(const char* text);
+    void setText(const std::string& text);
+    void setScale(float scale);
+    void setColor(const Color& color);
+    // Solid box drawn behind the text, extending `padding` pixels past the text bounds.
+    void setBackground(const Color& color, float padding);
+
+    const std::string& text() const { return m_text; }
+    float scale() const { return m_scale; }
+
+private:
+    friend class TextRenderer;
+
+    std::string m_text;
+    float m_scale = 1.0f;
+    Color m_color{ 1.0f, 1.0f, 1.0f, 1.0f };
+    Color m_background{ 0.0f, 0.0f, 0.0f, 0.0f };
+    float m_backgroundPadding = 0.0f;
+    bool m_hasBackground = false;
+
+    bool m_dirty = true;
+    uint64_t m_atlasGeneration = 0;
+    TextMetrics m_metrics;
+    GlVertexArray m_vao;
+    PooledBuffer m_vbo;
+    GLsizei m_vertexCount = 0;
+};
+
 class TextRenderer
 {
 public:
-    TextRenderer(int windowWidth, int windowHeight);
+    // Glyph rasterization and distance fields are spread over `jobs` when given.
+    TextRenderer(int windowWidth, int windowHeight, JobSystem* jobs = nullptr);
     ~TextRenderer();
 
-    bool loadFont(const std::string& fontPath, unsigned int pixelHeight = 48);
+    bool loadFont(const std::string& fontPath, unsigned int pixelHeight = 48, GlyphRasterMode mode = GlyphRasterMode::SignedDistance);
     void setWindowSize(float width, float height);
+    float windowWidth() const { return m_windowWidth; }
+    float windowHeight() const { return m_windowHeight; }
+    // Transient buffers of on-demand glyphs and text textures come from `memory`, normally the
+    // frame arena of the thread issuing the draws; the global heap is used while it is null.
+    void setFrameMemory(std::pmr::memory_resource* memory);
 
-    // Draw text with origin at top-left corner of the first glyph box.
+    // Draw UTF-8 text with origin at top-left corner of the first glyph box.
+    // Glyphs outside the preloaded ASCII set are rasterized into the atlas on first use.
     void drawText(const std::string& text, float x, float y, float scale, const Color& color);
-    TextMetrics measure(const std::string& text, float scale = 1.0f) const;
-    bool createTextTexture(const std::string& text, const Color& textColor, const Color& bgColor, unsigned int padding, unsigned int pixelHeight, GLuint& outTexture, int& outWidth, int& outHeight);
+    TextMetrics measure(const std::string& text, float scale = 1.0f);
+
+    // Shapes the run if needed and returns its metrics; cheap when the run is clean.
+    const TextMetrics& layoutRun(TextRun& run);
+    // Draws a retained run with the top-left corner of its text box at (x, y).
+    void drawRun(TextRun& run, float x, float y);
+
+    // Work issued since the last resetStats(), including glyph uploads made while laying out.
+    const RenderStats& stats() const { return m_stats; }
+    void resetStats() { m_stats = RenderStats{}; }
 
 private:
+    // One atlas cell; pinned cells hold the preloaded charset and are never evicted.
+    struct AtlasSlot
+    {
+        uint32_t codepoint = 0;
+        uint64_t lastUsed = 0;
+        bool used = false;
+        bool pinned = false;
+    };
+
     void cleanup();
-    void destroyGlyphTextures();
+    void destroyAtlas();
+    const Glyph* glyphFor(uint32_t codepoint);
+    const Glyph* rasterizeOnDemand(uint32_t codepoint);
+    int acquireSlot();
+    // Atlas construction: either mapped from the on-disk cache or rasterized and written back to it.
+    bool loadBakedAtlas(const std::string& cachePath, uint64_t key);
+    bool bakeAtlas(const std::string& cachePath, uint64_t key);
+    bool allocateSlots(size_t pinnedGlyphs);
+    void pinGlyph(int slot, uint32_t codepoint, const Glyph& metrics);
+    void pinSolidCell();
+    void uploadAtlas(const unsigned char* pixels);
+    void chargeGlyphMemory();
+    // Appends quads for text with its top-left at the origin; returns the text metrics.
+    TextMetrics layoutText(const std::string& text, float scale, const Color& color, std::vector<float>& out);
+    void useTextProgram(const Color& tint, const glm::mat4& transform, float offsetX, float offsetY);
+    std::pmr::memory_resource* frameMemory() const;
 
     float m_windowWidth = 0.0f;
     float m_windowHeight = 0.0f;
     unsigned int m_fontPixelHeight = 0;
     std::string m_fontPath;
+    JobSystem* m_jobs = nullptr;
+    std::pmr::memory_resource* m_frameMemory = nullptr;
 
-    GLuint m_program = 0;
-    GLuint m_vao = 0;
-    GLuint m_vbo = 0;
-    GLuint m_blankTexture = 0;
+    GlProgram m_program;
+    GlVertexArray m_vao;
+    PooledBuffer m_vbo;
+    GlTexture m_blankTexture;
     GLint m_uTextColor = -1;
-    GLint m_uWindowSize = -1;
+    GLint m_uTransform = -1;
     GLint m_uTexture = -1;
+    GLint m_uDistanceField = -1;
+    GLint m_uOffset = -1;
+
+    // single atlas texture shared by every glyph, split into equally sized cells
+    GlTexture m_atlasTexture;
+    int m_atlasWidth = 0;
+    int m_atlasHeight = 0;
+    int m_cellSize = 0;
+    int m_glyphPadding = 0;
+    GlyphRasterMode m_rasterMode = GlyphRasterMode::SignedDistance;
+
+    int m_atlasColumns = 0;
+    std::vector<AtlasSlot> m_slots;
+    uint64_t m_useStamp = 0;
+    // bumped whenever existing atlas cells change meaning, which invalidates retained runs
+    uint64_t m_atlasGeneration = 1;
+    // texel inside a cell filled solid, used for run backgrounds
+    float m_solidU = 0.0f;
+    float m_solidV = 0.0f;
+
+    // face stays open so missing glyphs can be rasterized lazily
+    FT_LibraryRec_* m_ftLibrary = nullptr;
+    FT_FaceRec_* m_ftFace = nullptr;
 
-    std::map<char, Glyph> m_glyphs;
+    GlyphCache m_glyphs;
+    MemoryCharge m_glyphMemory{ MemoryCategory::Glyphs };
+    std::vector<float> m_vertexScratch;
+    RenderStats m_stats;
 };
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-writer / single-reader handoff of whole values. The writer fills back()
+// and publish()es it; the reader calls update() and then reads front(), which stays stable
+// until its next update(). Neither side ever waits; the reader simply sees the newest value.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Writer side.
+    T& back() { return m_slots[m_back].value; }
+    void publish()
+    {
+        uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_back | kFresh), std::memory_order_acq_rel);
+        m_back = static_cast<uint8_t>(previous & kIndexMask);
+    }
+
+    // Reader side; returns true when a newer value was picked up.
+    bool update()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & kFresh) == 0) return false;
+        uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = static_cast<uint8_t>(previous & kIndexMask);
+        return true;
+    }
+    const T& front() const { return m_slots[m_front].value; }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    // separate cache lines so the two sides never share one while writing
+    struct alignas(64) Slot
+    {
+        T value{};
+    };
+
+    std::array<Slot, 3> m_slots{};
+    alignas(64) std::atomic<uint8_t> m_middle{ 1 };
+    alignas(64) uint8_t m_back = 0;   // writer only
+    alignas(64) uint8_t m_front = 2;  // reader only
+};
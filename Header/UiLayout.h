@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../Header/Renderer2D.h"
+
+#include <glm/glm.hpp>
+#include <array>
+
+// Elements of the AC scene that are laid out in 2D and mirrored onto the 3D model.
+enum class UiNodeId
+{
+    AcBody,
+    Vent,
+    Lamp,
+    Panel,      // the three screens, drawn as one composited texture
+    ArrowUp,
+    ArrowDown,
+    Bowl,
+    Count
+};
+
+// How a node's world box is derived from its parent.
+enum class UiPlacement
+{
+    Root,       // world box given explicitly; defines the pixel -> world scale for its children
+    FrontFace,  // on the parent's front, centred at z = offset
+    Below       // under the parent, `offset` world units below its bottom face
+};
+
+struct UiNode
+{
+    UiNodeId parent = UiNodeId::Count;
+    UiPlacement placement = UiPlacement::Root;
+    RectShape local{};           // layout pixels, before the scene is centred in the window
+    float offset = 0.0f;         // see UiPlacement
+    float depth = 0.0f;          // world thickness along z
+    float heightScale = 1.0f;    // world height relative to the mapped 2D height
+    bool round = false;          // hit-tested as a circle instead of a rect
+
+    // cached, recomputed by UiLayout::update() when the node is dirty
+    RectShape screen{};          // window pixels
+    glm::vec3 worldCenter{ 0.0f };
+    glm::vec3 worldHalfExtents{ 0.0f };
+    glm::mat4 world{ 1.0f };     // unit cube -> world box
+    bool dirty = true;
+};
+
+// Retained layout for the AC scene. Screen rects and world boxes are cached per node and only
+// recomputed when a local rect or the window size changes, so 2D hit tests and the 3D pick
+// scene read the same data the renderer draws with.
+class UiLayout
+{
+public:
+    void setRoot(UiNodeId id, const RectShape& local, const glm::vec3& worldSize);
+    void addNode(UiNodeId id, UiNodeId parent, const RectShape& local, UiPlacement placement, float offset, float depth);
+    void setHeightScale(UiNodeId id, float scale);
+    void setRound(UiNodeId id, bool round);
+
+    // Marks the node (and its children) dirty only when the rect actually changes.
+    void setLocalRect(UiNodeId id, const RectShape& local);
+    // Colors do not affect layout, so they never dirty anything.
+    void setColor(UiNodeId id, const Color& color);
+    void setWindowSize(float width, float height);
+
+    // Recomputes dirty nodes; returns how many were rebuilt (0 on an idle frame).
+    int update();
+
+    const UiNode& node(UiNodeId id) const { return m_nodes[index(id)]; }
+    CircleShape screenCircle(UiNodeId id) const;
+    // World units per layout pixel, from the root that `id` hangs off.
+    glm::vec2 worldPerPixel(UiNodeId id) const;
+
+    bool hitTest(UiNodeId id, double px, double py) const;
+
+private:
+    static size_t index(UiNodeId id) { return static_cast<size_t>(id); }
+    UiNodeId rootOf(UiNodeId id) const;
+    void markDirty(UiNodeId id);
+    void updateNode(UiNodeId id);
+
+    std::array<UiNode, static_cast<size_t>(UiNodeId::Count)> m_nodes{};
+    std::array<glm::vec3, static_cast<size_t>(UiNodeId::Count)> m_rootWorldSize{};
+    float m_windowWidth = 0.0f;
+    float m_windowHeight = 0.0f;
+    float m_offsetX = 0.0f;
+    float m_offsetY = 0.0f;
+    bool m_offsetDirty = true;
+};
@@ -3,7 +3,9 @@ in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
 
-out vec4 FragColor;
+layout(location = 0) out vec4 FragColor;
+// object id for GPU picking; only stored when the renderer's ID buffer is bound
+layout(location = 1) out uint ObjectId;
 
 struct Light { vec3 position; vec3 color; float intensity; };
 
@@ -16,6 +18,7 @@ uniform vec3 materialDiffuse;
 uniform vec3 materialSpecular;
 uniform float shininess;
 uniform float uAlpha;
+uniform uint uObjectId;
 
 void main() {
   vec3 norm = normalize(Normal);
@@ -51,4 +54,5 @@ void main() {
 
   vec4 texColor = texture(tex, TexCoord);
   FragColor = vec4(color, uAlpha) * texColor;
+  ObjectId = uObjectId;
 }
@@ -0,0 +1,61 @@
+#version 330 core
+in vec2 vPixel;
+flat in vec4 vParams0;
+flat in vec4 vParams1;
+flat in vec4 vColor;
+out vec4 FragColor;
+
+// Signed distances in pixels, negative inside (after Inigo Quilez's 2D distance functions).
+float roundedBox(vec2 p, vec2 center, vec2 halfSize, float r)
+{
+    vec2 q = abs(p - center) - halfSize + r;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - r;
+}
+
+float capsule(vec2 p, vec2 a, vec2 b, float r)
+{
+    vec2 pa = p - a;
+    vec2 ba = b - a;
+    float t = clamp(dot(pa, ba) / max(dot(ba, ba), 1e-6), 0.0, 1.0);
+    return length(pa - ba * t) - r;
+}
+
+float orientedBox(vec2 p, vec2 a, vec2 b, float halfThickness)
+{
+    float len = length(b - a);
+    vec2 dir = len > 1e-6 ? (b - a) / len : vec2(1.0, 0.0);
+    vec2 q = p - (a + b) * 0.5;
+    q = vec2(dot(q, dir), dot(q, vec2(-dir.y, dir.x)));
+    q = abs(q) - vec2(len * 0.5, halfThickness);
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0);
+}
+
+float triangle(vec2 p, vec2 p0, vec2 p1, vec2 p2)
+{
+    vec2 e0 = p1 - p0, e1 = p2 - p1, e2 = p0 - p2;
+    vec2 v0 = p - p0, v1 = p - p1, v2 = p - p2;
+    vec2 pq0 = v0 - e0 * clamp(dot(v0, e0) / dot(e0, e0), 0.0, 1.0);
+    vec2 pq1 = v1 - e1 * clamp(dot(v1, e1) / dot(e1, e1), 0.0, 1.0);
+    vec2 pq2 = v2 - e2 * clamp(dot(v2, e2) / dot(e2, e2), 0.0, 1.0);
+    float s = sign(e0.x * e2.y - e0.y * e2.x);
+    vec2 d = min(min(vec2(dot(pq0, pq0), s * (v0.x * e0.y - v0.y * e0.x)),
+                     vec2(dot(pq1, pq1), s * (v1.x * e1.y - v1.y * e1.x))),
+                     vec2(dot(pq2, pq2), s * (v2.x * e2.y - v2.y * e2.x)));
+    return -sqrt(d.x) * sign(d.y);
+}
+
+void main()
+{
+    int kind = int(vParams1.w + 0.5);
+    float d;
+    if (kind == 0)      d = roundedBox(vPixel, vParams0.xy, vParams0.zw, vParams1.x);
+    else if (kind == 1) d = length(vPixel - vParams0.xy) - vParams0.z;
+    else if (kind == 2) d = capsule(vPixel, vParams0.xy, vParams0.zw, vParams1.x);
+    else if (kind == 3) d = orientedBox(vPixel, vParams0.xy, vParams0.zw, vParams1.x);
+    else                d = triangle(vPixel, vParams0.xy, vParams0.zw, vParams1.xy) - vParams1.z;
+
+    // one pixel wide edge ramp centred on the outline
+    float coverage = clamp(0.5 - d / max(fwidth(d), 1e-4), 0.0, 1.0);
+    if (coverage <= 0.0) discard;
+    FragColor = vec4(vColor.rgb, vColor.a * coverage);
+}
@@ -0,0 +1,25 @@
+#version 330 core
+// Per-instance data; the four quad corners are generated from gl_VertexID.
+layout (location = 0) in vec4 aBounds;   // min.xy, max.xy in pixels
+layout (location = 1) in vec4 aParams0;
+layout (location = 2) in vec4 aParams1;  // .w = shape kind
+layout (location = 3) in vec4 aColor;
+
+out vec2 vPixel;
+flat out vec4 vParams0;
+flat out vec4 vParams1;
+flat out vec4 vColor;
+
+uniform vec2 uWindowSize;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 pixel = mix(aBounds.xy, aBounds.zw, corner);
+    gl_Position = vec4(2.0 * pixel.x / uWindowSize.x - 1.0, 1.0 - 2.0 * pixel.y / uWindowSize.y, 0.0, 1.0);
+
+    vPixel = pixel;
+    vParams0 = aParams0;
+    vParams1 = aParams1;
+    vColor = aColor;
+}
@@ -1,13 +1,22 @@
 #version 330 core
 in vec2 TexCoord;
+in vec4 VertexColor;
 out vec4 FragColor;
 
 uniform sampler2D uTexture;
 uniform vec4 uTextColor;
+uniform bool uDistanceField;
 
 void main()
 {
-    // Flip Y because FreeType/CPU buffers are top-left origin.
-    float alpha = texture(uTexture, vec2(TexCoord.x, 1.0 - TexCoord.y)).r;
-    FragColor = vec4(uTextColor.rgb, uTextColor.a * alpha);
+    // Atlas rows are uploaded top-down, so glyph UVs already point at the right texels.
+    float value = texture(uTexture, TexCoord).r;
+    float alpha = value;
+    if (uDistanceField)
+    {
+        // 0.5 is the glyph outline; fwidth keeps the edge ~1 screen pixel wide at any scale or distance.
+        float edge = max(fwidth(value) * 0.75, 1e-4);
+        alpha = smoothstep(0.5 - edge, 0.5 + edge, value);
+    }
+    FragColor = vec4(uTextColor.rgb * VertexColor.rgb, uTextColor.a * VertexColor.a * alpha);
 }
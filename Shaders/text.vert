@@ -1,16 +1,19 @@
 #version 330 core
 layout (location = 0) in vec2 aPos;
 layout (location = 1) in vec2 aUV;
+layout (location = 2) in vec4 aColor;
 
 out vec2 TexCoord;
+out vec4 VertexColor;
 
-uniform vec2 uWindowSize;
+// text pixels -> clip space: an orthographic projection of the target's pixels
+uniform mat4 uTransform;
+// pixel offset applied at draw time so retained runs can move without re-layout
+uniform vec2 uOffset;
 
 void main()
 {
-    vec2 ndc;
-    ndc.x = 2.0 * aPos.x / uWindowSize.x - 1.0;
-    ndc.y = 1.0 - 2.0 * aPos.y / uWindowSize.y;
-    gl_Position = vec4(ndc, 0.0, 1.0);
+    gl_Position = uTransform * vec4(aPos + uOffset, 0.0, 1.0);
     TexCoord = aUV;
+    VertexColor = aColor;
 }
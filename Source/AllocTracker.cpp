@@ -0,0 +1,379 @@
+#include "../Header/AllocTracker.h"
+
+#if AC_TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define AC_HAVE_BACKTRACE 1
+#else
+#define AC_HAVE_BACKTRACE 0
+#endif
+
+#if defined(__GLIBC__)
+// glibc's real allocator, so the malloc family can be replaced below
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+extern "C" void __libc_free(void* p);
+#endif
+
+namespace
+{
+    constexpr int kMaxZones = 64;
+    constexpr int kMaxStackDepth = 16;
+    constexpr int kMaxSamples = 256;
+
+    struct Zone
+    {
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<uint64_t> allocations{ 0 };
+        std::atomic<uint64_t> bytes{ 0 };
+    };
+
+    struct Sample
+    {
+        const char* zone;
+        size_t size;
+        bool violation;
+        int depth;
+        void* frames[kMaxStackDepth];
+    };
+
+    std::atomic<uint64_t> g_allocations{ 0 };
+    std::atomic<uint64_t> g_bytes{ 0 };
+    std::atomic<uint64_t> g_frameStartAllocations{ 0 };
+    std::atomic<uint64_t> g_frameStartBytes{ 0 };
+    std::atomic<uint64_t> g_lastFrameAllocations{ 0 };
+    std::atomic<uint64_t> g_lastFrameBytes{ 0 };
+
+    Zone g_zones[kMaxZones];
+    std::atomic<int> g_zoneCount{ 0 };
+    std::atomic_flag g_zoneLock = ATOMIC_FLAG_INIT;
+
+    // The ring is overwritten without locking; a report taken while other threads allocate may
+    // show a torn sample, which is acceptable for a diagnostic.
+    Sample g_samples[kMaxSamples];
+    std::atomic<uint64_t> g_sampleCount{ 0 };
+    std::atomic<unsigned> g_sampleEvery{ 0 };
+    std::atomic<bool> g_forbidden{ false };
+    std::atomic<uint64_t> g_violations{ 0 };
+
+    thread_local int t_zone = -1;
+    // set while the tracker itself runs; backtrace() may allocate on first use
+    thread_local bool t_inTracker = false;
+
+    void capture(size_t size, bool violation)
+    {
+        Sample& s = g_samples[g_sampleCount.fetch_add(1, std::memory_order_relaxed) % kMaxSamples];
+        s.zone = t_zone >= 0 ? g_zones[t_zone].name.load(std::memory_order_relaxed) : nullptr;
+        s.size = size;
+        s.violation = violation;
+#if AC_HAVE_BACKTRACE
+        s.depth = backtrace(s.frames, kMaxStackDepth);
+#else
+        s.depth = 0;
+#endif
+    }
+
+    void record(size_t size)
+    {
+        if (t_inTracker) return;
+        t_inTracker = true;
+
+        uint64_t n = g_allocations.fetch_add(1, std::memory_order_relaxed) + 1;
+        g_bytes.fetch_add(size, std::memory_order_relaxed);
+        if (t_zone >= 0)
+        {
+            g_zones[t_zone].allocations.fetch_add(1, std::memory_order_relaxed);
+            g_zones[t_zone].bytes.fetch_add(size, std::memory_order_relaxed);
+        }
+
+        bool forbidden = g_forbidden.load(std::memory_order_relaxed);
+        if (forbidden) g_violations.fetch_add(1, std::memory_order_relaxed);
+        unsigned every = g_sampleEvery.load(std::memory_order_relaxed);
+        if (forbidden || (every != 0 && n % every == 0)) capture(size, forbidden);
+
+        t_inTracker = false;
+    }
+
+    void* rawAlloc(size_t size)
+    {
+#if defined(__GLIBC__)
+        return __libc_malloc(size);
+#else
+        return std::malloc(size);
+#endif
+    }
+
+    void* rawAlignedAlloc(size_t size, size_t alignment)
+    {
+#if defined(__GLIBC__)
+        return __libc_memalign(alignment, size);
+#else
+        // aligned_alloc wants a multiple of the alignment
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    void rawFree(void* p)
+    {
+#if defined(__GLIBC__)
+        __libc_free(p);
+#else
+        std::free(p);
+#endif
+    }
+
+    void* trackedNew(size_t size)
+    {
+        record(size);
+        return rawAlloc(size != 0 ? size : 1);
+    }
+
+    void* trackedAlignedNew(size_t size, std::align_val_t alignment)
+    {
+        record(size);
+        return rawAlignedAlloc(size != 0 ? size : 1, static_cast<size_t>(alignment));
+    }
+
+    int zoneIndex(const char* name)
+    {
+        int count = g_zoneCount.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i)
+        {
+            if (g_zones[i].name.load(std::memory_order_relaxed) == name) return i;
+        }
+
+        while (g_zoneLock.test_and_set(std::memory_order_acquire)) {}
+        int index = -1;
+        count = g_zoneCount.load(std::memory_order_relaxed);
+        for (int i = 0; i < count && index < 0; ++i)
+        {
+            if (g_zones[i].name.load(std::memory_order_relaxed) == name) index = i;
+        }
+        if (index < 0 && count < kMaxZones)
+        {
+            index = count;
+            g_zones[index].name.store(name, std::memory_order_relaxed);
+            g_zoneCount.store(count + 1, std::memory_order_release);
+        }
+        g_zoneLock.clear(std::memory_order_release);
+        return index;
+    }
+
+    void warmUpBacktrace()
+    {
+#if AC_HAVE_BACKTRACE
+        // the first call loads the unwinder, which allocates
+        t_inTracker = true;
+        void* frames[1];
+        backtrace(frames, 1);
+        t_inTracker = false;
+#endif
+    }
+}
+
+AllocCounts AllocTracker::totals()
+{
+    return AllocCounts{ g_allocations.load(std::memory_order_relaxed), g_bytes.load(std::memory_order_relaxed) };
+}
+
+AllocCounts AllocTracker::endFrame()
+{
+    AllocCounts now = totals();
+    AllocCounts frame;
+    frame.allocations = now.allocations - g_frameStartAllocations.exchange(now.allocations, std::memory_order_relaxed);
+    frame.bytes = now.bytes - g_frameStartBytes.exchange(now.bytes, std::memory_order_relaxed);
+    g_lastFrameAllocations.store(frame.allocations, std::memory_order_relaxed);
+    g_lastFrameBytes.store(frame.bytes, std::memory_order_relaxed);
+    return frame;
+}
+
+AllocCounts AllocTracker::lastFrame()
+{
+    return AllocCounts{ g_lastFrameAllocations.load(std::memory_order_relaxed), g_lastFrameBytes.load(std::memory_order_relaxed) };
+}
+
+void AllocTracker::setSampling(unsigned everyN)
+{
+    if (everyN != 0) warmUpBacktrace();
+    g_sampleEvery.store(everyN, std::memory_order_relaxed);
+}
+
+void AllocTracker::setForbidden(bool forbidden)
+{
+    if (forbidden) warmUpBacktrace();
+    g_forbidden.store(forbidden, std::memory_order_relaxed);
+}
+
+uint64_t AllocTracker::violations()
+{
+    return g_violations.load(std::memory_order_relaxed);
+}
+
+void AllocTracker::writeReport(FILE* out)
+{
+    AllocCounts total = totals();
+    std::fprintf(out, "allocations: %llu (%llu bytes), violations: %llu\n", static_cast<unsigned long long>(total.allocations),
+                 static_cast<unsigned long long>(total.bytes), static_cast<unsigned long long>(violations()));
+    int zones = g_zoneCount.load(std::memory_order_acquire);
+    for (int i = 0; i < zones; ++i)
+    {
+        std::fprintf(out, "  zone %-20s %10llu allocs %12llu bytes\n", g_zones[i].name.load(std::memory_order_relaxed),
+                     static_cast<unsigned long long>(g_zones[i].allocations.load(std::memory_order_relaxed)),
+                     static_cast<unsigned long long>(g_zones[i].bytes.load(std::memory_order_relaxed)));
+    }
+
+    uint64_t captured = g_sampleCount.load(std::memory_order_relaxed);
+    uint64_t first = captured > kMaxSamples ? captured - kMaxSamples : 0;
+    for (uint64_t n = first; n < captured; ++n)
+    {
+        const Sample& s = g_samples[n % kMaxSamples];
+        std::fprintf(out, "%s of %zu bytes in zone %s:\n", s.violation ? "violation" : "sample", s.size, s.zone ? s.zone : "-");
+#if AC_HAVE_BACKTRACE
+        std::fflush(out);
+        backtrace_symbols_fd(s.frames, s.depth, fileno(out));
+#endif
+    }
+    std::fflush(out);
+}
+
+AllocZone::AllocZone(const char* name)
+    : m_previous(t_zone)
+{
+    t_zone = zoneIndex(name);
+}
+
+AllocZone::~AllocZone()
+{
+    t_zone = m_previous;
+}
+
+// Global operator new/delete. With glibc the malloc family is replaced as well, which also
+// catches C libraries; operator new calls the real allocator directly so nothing counts twice.
+void* operator new(size_t size)
+{
+    void* p = trackedNew(size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    void* p = trackedNew(size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedNew(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedNew(size); }
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    void* p = trackedAlignedNew(size, alignment);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    void* p = trackedAlignedNew(size, alignment);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return trackedAlignedNew(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return trackedAlignedNew(size, alignment); }
+
+void operator delete(void* p) noexcept { rawFree(p); }
+void operator delete[](void* p) noexcept { rawFree(p); }
+void operator delete(void* p, size_t) noexcept { rawFree(p); }
+void operator delete[](void* p, size_t) noexcept { rawFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { rawFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { rawFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { rawFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { rawFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { rawFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { rawFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { rawFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { rawFree(p); }
+
+#if defined(__GLIBC__)
+namespace
+{
+    bool isPowerOfTwo(size_t n) { return n != 0 && (n & (n - 1)) == 0; }
+}
+
+extern "C"
+{
+    void* malloc(size_t size)
+    {
+        record(size);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        record(count * size);
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* p, size_t size)
+    {
+        record(size);
+        return __libc_realloc(p, size);
+    }
+
+    void* memalign(size_t alignment, size_t size)
+    {
+        record(size);
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        // __libc_memalign rounds a bad alignment up; the standard functions must reject it
+        if (!isPowerOfTwo(alignment))
+        {
+            errno = EINVAL;
+            return nullptr;
+        }
+        record(size);
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** out, size_t alignment, size_t size)
+    {
+        if (!isPowerOfTwo(alignment) || alignment % sizeof(void*) != 0) return EINVAL;
+        record(size);
+        void* p = __libc_memalign(alignment, size);
+        if (p == nullptr && size != 0) return ENOMEM;
+        *out = p;
+        return 0;
+    }
+
+    void free(void* p)
+    {
+        __libc_free(p);
+    }
+}
+#endif
+
+#else
+
+AllocCounts AllocTracker::totals() { return AllocCounts{}; }
+AllocCounts AllocTracker::endFrame() { return AllocCounts{}; }
+AllocCounts AllocTracker::lastFrame() { return AllocCounts{}; }
+void AllocTracker::setSampling(unsigned) {}
+void AllocTracker::setForbidden(bool) {}
+uint64_t AllocTracker::violations() { return 0; }
+void AllocTracker::writeReport(FILE*) {}
+
+#endif
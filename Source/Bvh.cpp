@@ -0,0 +1,585 @@
+#include "../Header/Bvh.h"
+
+#include "../Header/JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AC_BVH_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+    constexpr int kSahBins = 16;
+    constexpr uint32_t kMaxLeafTriangles = 4;
+    // subtrees smaller than this are not worth a job
+    constexpr uint32_t kParallelMinTriangles = 4096;
+    constexpr int kStackSize = 64;
+    // Traversal keeps at most one pending sibling per level, so trees no deeper than this never
+    // overflow the stack; deeper SAH nodes become larger leaves instead.
+    constexpr int kMaxDepth = kStackSize - 2;
+
+    // Slab test; returns the entry distance, or 1e30 when the box is missed or farther than tMax.
+    float rayBox(const Aabb& b, const glm::vec3& origin, const glm::vec3& invDir, float tMax)
+    {
+        glm::vec3 t0 = (b.min - origin) * invDir;
+        glm::vec3 t1 = (b.max - origin) * invDir;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+        return enter <= exit ? enter : 1e30f;
+    }
+
+    glm::vec3 inverseDir(const glm::vec3& dir)
+    {
+        return glm::vec3(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+    }
+
+    Aabb transformBox(const Aabb& b, const glm::mat4& m)
+    {
+        Aabb out;
+        for (int i = 0; i < 8; ++i)
+        {
+            glm::vec3 corner((i & 1) ? b.max.x : b.min.x, (i & 2) ? b.max.y : b.min.y, (i & 4) ? b.max.z : b.min.z);
+            out.grow(glm::vec3(m * glm::vec4(corner, 1.0f)));
+        }
+        return out;
+    }
+
+    bool sameBox(const Aabb& a, const Aabb& b)
+    {
+        return a.min == b.min && a.max == b.max;
+    }
+}
+
+void Aabb::grow(const glm::vec3& p)
+{
+    min = glm::min(min, p);
+    max = glm::max(max, p);
+}
+
+void Aabb::grow(const Aabb& b)
+{
+    min = glm::min(min, b.min);
+    max = glm::max(max, b.max);
+}
+
+float Aabb::halfArea() const
+{
+    if (!valid()) return 0.0f;
+    glm::vec3 e = max - min;
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+// ---------------------------------------------------------------------------------------------
+// TriangleBvh
+
+struct TriangleBvh::BuildContext
+{
+    std::atomic<uint32_t> nodesUsed{ 1 };
+    JobSystem* jobs = nullptr;
+};
+
+void TriangleBvh::build(const std::vector<glm::vec3>& positions, JobSystem* jobs)
+{
+    m_vertices = positions;
+    uint32_t triCount = static_cast<uint32_t>(m_vertices.size() / 3);
+    m_vertices.resize(static_cast<size_t>(triCount) * 3);
+    m_nodes.clear();
+    if (triCount == 0) return;
+
+    m_indices.resize(triCount);
+    std::iota(m_indices.begin(), m_indices.end(), 0u);
+    m_centroids.resize(triCount);
+    for (uint32_t i = 0; i < triCount; ++i)
+    {
+        m_centroids[i] = (m_vertices[i * 3] + m_vertices[i * 3 + 1] + m_vertices[i * 3 + 2]) * (1.0f / 3.0f);
+    }
+
+    // a binary tree over N leaves-worth of triangles never needs more than 2N - 1 nodes, so
+    // nodes are preallocated and threads only race on the counter
+    m_nodes.resize(static_cast<size_t>(triCount) * 2 - 1);
+    m_nodes[0].first = 0;
+    m_nodes[0].count = triCount;
+
+    BuildContext ctx;
+    ctx.jobs = jobs;
+    subdivide(ctx, 0, 0);
+    m_nodes.resize(ctx.nodesUsed.load());
+}
+
+void TriangleBvh::subdivide(BuildContext& ctx, uint32_t nodeIndex, int depth)
+{
+    Node& node = m_nodes[nodeIndex];
+    node.bounds = Aabb{};
+    Aabb centroidBounds;
+    for (uint32_t i = node.first; i < node.first + node.count; ++i)
+    {
+        uint32_t tri = m_indices[i];
+        node.bounds.grow(m_vertices[tri * 3]);
+        node.bounds.grow(m_vertices[tri * 3 + 1]);
+        node.bounds.grow(m_vertices[tri * 3 + 2]);
+        centroidBounds.grow(m_centroids[tri]);
+    }
+    if (node.count <= kMaxLeafTriangles || depth >= kMaxDepth) return;
+
+    // binned SAH: try kSahBins - 1 planes per axis, keep the cheapest
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = static_cast<float>(node.count) * node.bounds.halfArea();
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float lo = centroidBounds.min[axis];
+        float hi = centroidBounds.max[axis];
+        if (hi <= lo) continue;
+
+        Aabb binBounds[kSahBins];
+        uint32_t binCount[kSahBins] = {};
+        float scale = static_cast<float>(kSahBins) / (hi - lo);
+        for (uint32_t i = node.first; i < node.first + node.count; ++i)
+        {
+            uint32_t tri = m_indices[i];
+            int bin = std::min(kSahBins - 1, static_cast<int>((m_centroids[tri][axis] - lo) * scale));
+            binCount[bin]++;
+            binBounds[bin].grow(m_vertices[tri * 3]);
+            binBounds[bin].grow(m_vertices[tri * 3 + 1]);
+            binBounds[bin].grow(m_vertices[tri * 3 + 2]);
+        }
+
+        // sweep from both sides so each plane's cost is O(1)
+        float leftArea[kSahBins - 1];
+        uint32_t leftCount[kSahBins - 1];
+        Aabb acc;
+        uint32_t sum = 0;
+        for (int i = 0; i < kSahBins - 1; ++i)
+        {
+            acc.grow(binBounds[i]);
+            sum += binCount[i];
+            leftArea[i] = acc.halfArea();
+            leftCount[i] = sum;
+        }
+        acc = Aabb{};
+        sum = 0;
+        for (int i = kSahBins - 1; i > 0; --i)
+        {
+            acc.grow(binBounds[i]);
+            sum += binCount[i];
+            float cost = static_cast<float>(leftCount[i - 1]) * leftArea[i - 1] + static_cast<float>(sum) * acc.halfArea();
+            if (leftCount[i - 1] > 0 && sum > 0 && cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i;
+            }
+        }
+    }
+    if (bestAxis < 0) return; // splitting would not pay off
+
+    float lo = centroidBounds.min[bestAxis];
+    float scale = static_cast<float>(kSahBins) / (centroidBounds.max[bestAxis] - lo);
+    auto mid = std::partition(m_indices.begin() + node.first, m_indices.begin() + node.first + node.count, [&](uint32_t tri)
+    {
+        return std::min(kSahBins - 1, static_cast<int>((m_centroids[tri][bestAxis] - lo) * scale)) < bestSplit;
+    });
+    uint32_t leftCount = static_cast<uint32_t>(mid - m_indices.begin()) - node.first;
+    if (leftCount == 0 || leftCount == node.count) return;
+
+    uint32_t left = ctx.nodesUsed.fetch_add(2);
+    m_nodes[left].first = node.first;
+    m_nodes[left].count = leftCount;
+    m_nodes[left + 1].first = node.first + leftCount;
+    m_nodes[left + 1].count = node.count - leftCount;
+    uint32_t count = node.count;
+    node.first = left;
+    node.count = 0;
+
+    // the two halves touch disjoint index ranges and node slots, so they can build concurrently
+    if (ctx.jobs && count >= kParallelMinTriangles)
+    {
+        // the left half becomes a job; waiting runs other subtrees instead of blocking
+        JobCounter leftDone;
+        BuildContext* c = &ctx;
+        ctx.jobs->run([this, c, left, depth]() { subdivide(*c, left, depth + 1); }, &leftDone);
+        subdivide(ctx, left + 1, depth + 1);
+        ctx.jobs->wait(leftDone);
+    }
+    else
+    {
+        subdivide(ctx, left, depth + 1);
+        subdivide(ctx, left + 1, depth + 1);
+    }
+}
+
+bool TriangleBvh::intersectTriangle(uint32_t tri, const glm::vec3& origin, const glm::vec3& dir, float& t) const
+{
+    // Moller-Trumbore
+    const glm::vec3& v0 = m_vertices[tri * 3];
+    glm::vec3 e1 = m_vertices[tri * 3 + 1] - v0;
+    glm::vec3 e2 = m_vertices[tri * 3 + 2] - v0;
+    glm::vec3 p = glm::cross(dir, e2);
+    float det = glm::dot(e1, p);
+    if (std::fabs(det) < 1e-12f) return false;
+    float invDet = 1.0f / det;
+    glm::vec3 s = origin - v0;
+    float u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+    glm::vec3 q = glm::cross(s, e1);
+    float v = glm::dot(dir, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+    float hitT = glm::dot(e2, q) * invDet;
+    if (hitT <= 0.0f || hitT >= t) return false;
+    t = hitT;
+    return true;
+}
+
+bool TriangleBvh::intersect(const glm::vec3& origin, const glm::vec3& dir, float& t, int& triangle) const
+{
+    if (m_nodes.empty()) return false;
+    glm::vec3 invDir = inverseDir(dir);
+    bool found = false;
+
+    uint32_t stack[kStackSize];
+    int top = 0;
+    if (rayBox(m_nodes[0].bounds, origin, invDir, t) >= 1e30f) return false;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+        if (node.count > 0)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                if (intersectTriangle(m_indices[i], origin, dir, t))
+                {
+                    triangle = static_cast<int>(m_indices[i]);
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        // visit the nearer child first; a far child is re-checked against the shrunk t when popped
+        uint32_t a = node.first;
+        uint32_t b = node.first + 1;
+        float da = rayBox(m_nodes[a].bounds, origin, invDir, t);
+        float db = rayBox(m_nodes[b].bounds, origin, invDir, t);
+        if (da > db)
+        {
+            std::swap(a, b);
+            std::swap(da, db);
+        }
+        assert(top + 2 <= kStackSize);
+        if (db < 1e30f) stack[top++] = b;
+        if (da < 1e30f) stack[top++] = a;
+    }
+    return found;
+}
+
+// ---------------------------------------------------------------------------------------------
+// SceneBvh
+
+int SceneBvh::addBox(const glm::vec3& center, const glm::vec3& halfExtents)
+{
+    Object object;
+    object.box.min = center - halfExtents;
+    object.box.max = center + halfExtents;
+    updateWorldBounds(object);
+    m_objects.push_back(object);
+    m_needsRebuild = true;
+    return static_cast<int>(m_objects.size() - 1);
+}
+
+int SceneBvh::addMesh(const TriangleBvh* mesh, const glm::mat4& transform)
+{
+    Object object;
+    object.mesh = mesh;
+    object.transform = transform;
+    object.inverse = glm::inverse(transform);
+    updateWorldBounds(object);
+    m_objects.push_back(object);
+    m_needsRebuild = true;
+    return static_cast<int>(m_objects.size() - 1);
+}
+
+void SceneBvh::setBox(int id, const glm::vec3& center, const glm::vec3& halfExtents)
+{
+    Object& object = m_objects[static_cast<size_t>(id)];
+    Aabb box;
+    box.min = center - halfExtents;
+    box.max = center + halfExtents;
+    if (sameBox(object.box, box)) return;
+    object.box = box;
+    updateWorldBounds(object);
+    m_needsRefit = true;
+}
+
+void SceneBvh::setTransform(int id, const glm::mat4& transform)
+{
+    Object& object = m_objects[static_cast<size_t>(id)];
+    if (object.transform == transform) return;
+    object.transform = transform;
+    object.inverse = glm::inverse(transform);
+    updateWorldBounds(object);
+    m_needsRefit = true;
+}
+
+void SceneBvh::setEnabled(int id, bool enabled)
+{
+    Object& object = m_objects[static_cast<size_t>(id)];
+    if (object.enabled == enabled) return;
+    object.enabled = enabled;
+    updateWorldBounds(object);
+    m_needsRefit = true;
+}
+
+void SceneBvh::updateWorldBounds(Object& object)
+{
+    object.worldBounds = Aabb{};
+    if (!object.enabled) return;
+    if (object.mesh == nullptr) object.worldBounds = object.box;
+    else if (!object.mesh->empty()) object.worldBounds = transformBox(object.mesh->bounds(), object.transform);
+}
+
+void SceneBvh::update()
+{
+    if (m_needsRebuild) rebuild();
+    else if (m_needsRefit) refit();
+    m_needsRebuild = false;
+    m_needsRefit = false;
+}
+
+void SceneBvh::rebuild()
+{
+    m_nodes.clear();
+    m_order.resize(m_objects.size());
+    std::iota(m_order.begin(), m_order.end(), 0u);
+    if (m_objects.empty()) return;
+
+    m_nodes.reserve(m_objects.size() * 2);
+    m_nodes.push_back(Node{ Aabb{}, 0, static_cast<uint32_t>(m_objects.size()) });
+    buildNode(0, 0);
+}
+
+void SceneBvh::buildNode(uint32_t nodeIndex, int depth)
+{
+    // the scene holds a handful of objects: a median split is as good as SAH here and keeps
+    // one object per leaf, which is what refit() relies on
+    uint32_t first = m_nodes[nodeIndex].first;
+    uint32_t count = m_nodes[nodeIndex].count;
+    Aabb bounds;
+    Aabb centroids;
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        const Aabb& b = m_objects[m_order[i]].worldBounds;
+        bounds.grow(b);
+        if (b.valid()) centroids.grow(b.center());
+    }
+    m_nodes[nodeIndex].bounds = bounds;
+    if (count <= 1) return;
+    // median splits halve the count, so this only trips with more objects than memory holds
+    assert(depth < kMaxDepth);
+
+    int axis = 0;
+    if (centroids.valid())
+    {
+        glm::vec3 extent = centroids.max - centroids.min;
+        if (extent.y > extent.x) axis = 1;
+        if (extent.z > extent[axis]) axis = 2;
+    }
+    uint32_t half = count / 2;
+    std::nth_element(m_order.begin() + first, m_order.begin() + first + half, m_order.begin() + first + count, [&](uint32_t a, uint32_t b)
+    {
+        return m_objects[a].worldBounds.center()[axis] < m_objects[b].worldBounds.center()[axis];
+    });
+
+    uint32_t left = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back(Node{ Aabb{}, first, half });
+    m_nodes.push_back(Node{ Aabb{}, first + half, count - half });
+    m_nodes[nodeIndex].first = left;
+    m_nodes[nodeIndex].count = 0;
+    buildNode(left, depth + 1);
+    buildNode(left + 1, depth + 1);
+}
+
+void SceneBvh::refit()
+{
+    // children are always stored after their parent, so a reverse sweep sees them first
+    for (size_t i = m_nodes.size(); i-- > 0;)
+    {
+        Node& node = m_nodes[i];
+        node.bounds = Aabb{};
+        if (node.count > 0)
+        {
+            for (uint32_t j = node.first; j < node.first + node.count; ++j) node.bounds.grow(m_objects[m_order[j]].worldBounds);
+        }
+        else
+        {
+            node.bounds.grow(m_nodes[node.first].bounds);
+            node.bounds.grow(m_nodes[node.first + 1].bounds);
+        }
+    }
+}
+
+bool SceneBvh::intersectObject(int id, const glm::vec3& origin, const glm::vec3& dir, float& t, int& triangle) const
+{
+    const Object& object = m_objects[static_cast<size_t>(id)];
+    if (!object.enabled) return false;
+    if (object.mesh == nullptr)
+    {
+        float enter = rayBox(object.box, origin, inverseDir(dir), t);
+        if (enter >= 1e30f || enter >= t) return false;
+        t = enter;
+        triangle = -1;
+        return true;
+    }
+
+    // an affine inverse keeps the ray parameter, so t compares directly with world-space hits
+    glm::vec3 localOrigin = glm::vec3(object.inverse * glm::vec4(origin, 1.0f));
+    glm::vec3 localDir = glm::vec3(object.inverse * glm::vec4(dir, 0.0f));
+    return object.mesh->intersect(localOrigin, localDir, t, triangle);
+}
+
+RayHit SceneBvh::intersect(const glm::vec3& origin, const glm::vec3& dir) const
+{
+    RayHit hit;
+    if (m_nodes.empty()) return hit;
+    glm::vec3 invDir = inverseDir(dir);
+
+    uint32_t stack[kStackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+        if (rayBox(node.bounds, origin, invDir, hit.t) >= 1e30f) continue;
+        if (node.count > 0)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                int id = static_cast<int>(m_order[i]);
+                if (intersectObject(id, origin, dir, hit.t, hit.triangle)) hit.objectId = id;
+            }
+            continue;
+        }
+        assert(top + 2 <= kStackSize);
+        stack[top++] = node.first + 1;
+        stack[top++] = node.first;
+    }
+    return hit;
+}
+
+void SceneBvh::intersect4(const glm::vec3 (&origins)[4], const glm::vec3 (&dirs)[4], RayHit (&hits)[4]) const
+{
+    for (RayHit& h : hits) h = RayHit{};
+    if (m_nodes.empty()) return;
+
+#ifdef AC_BVH_SSE
+    // structure-of-arrays packet: each node box is tested against all four rays at once
+    alignas(16) float ox[4], oy[4], oz[4], ix[4], iy[4], iz[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        ox[i] = origins[i].x; oy[i] = origins[i].y; oz[i] = origins[i].z;
+        ix[i] = 1.0f / dirs[i].x; iy[i] = 1.0f / dirs[i].y; iz[i] = 1.0f / dirs[i].z;
+    }
+    const __m128 pox = _mm_load_ps(ox), poy = _mm_load_ps(oy), poz = _mm_load_ps(oz);
+    const __m128 pix = _mm_load_ps(ix), piy = _mm_load_ps(iy), piz = _mm_load_ps(iz);
+    const __m128 zero = _mm_setzero_ps();
+
+    uint32_t stack[kStackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+        __m128 tMax = _mm_setr_ps(hits[0].t, hits[1].t, hits[2].t, hits[3].t);
+
+        __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.bounds.min.x), pox), pix);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.bounds.max.x), pox), pix);
+        __m128 enter = _mm_max_ps(_mm_min_ps(t0, t1), zero);
+        __m128 exit = _mm_min_ps(_mm_max_ps(t0, t1), tMax);
+        t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.bounds.min.y), poy), piy);
+        t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.bounds.max.y), poy), piy);
+        enter = _mm_max_ps(enter, _mm_min_ps(t0, t1));
+        exit = _mm_min_ps(exit, _mm_max_ps(t0, t1));
+        t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.bounds.min.z), poz), piz);
+        t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.bounds.max.z), poz), piz);
+        enter = _mm_max_ps(enter, _mm_min_ps(t0, t1));
+        exit = _mm_min_ps(exit, _mm_max_ps(t0, t1));
+
+        int active = _mm_movemask_ps(_mm_cmple_ps(enter, exit));
+        if (active == 0) continue;
+
+        if (node.count > 0)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                int id = static_cast<int>(m_order[i]);
+                for (int r = 0; r < 4; ++r)
+                {
+                    if ((active & (1 << r)) && intersectObject(id, origins[r], dirs[r], hits[r].t, hits[r].triangle)) hits[r].objectId = id;
+                }
+            }
+            continue;
+        }
+        assert(top + 2 <= kStackSize);
+        stack[top++] = node.first + 1;
+        stack[top++] = node.first;
+    }
+#else
+    for (int i = 0; i < 4; ++i) hits[i] = intersect(origins[i], dirs[i]);
+#endif
+}
+
+void SceneBvh::intersect(const std::vector<glm::vec3>& origins, const std::vector<glm::vec3>& dirs, std::vector<RayHit>& hits) const
+{
+    size_t count = std::min(origins.size(), dirs.size());
+    hits.resize(count);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const glm::vec3 o[4] = { origins[i], origins[i + 1], origins[i + 2], origins[i + 3] };
+        const glm::vec3 d[4] = { dirs[i], dirs[i + 1], dirs[i + 2], dirs[i + 3] };
+        RayHit h[4];
+        intersect4(o, d, h);
+        std::copy(h, h + 4, hits.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+    for (; i < count; ++i) hits[i] = intersect(origins[i], dirs[i]);
+}
+
+void SceneBvh::overlap(const Aabb& box, std::vector<int>& out) const
+{
+    out.clear();
+    if (m_nodes.empty()) return;
+
+    auto overlaps = [&](const Aabb& b)
+    {
+        return b.valid() && b.min.x <= box.max.x && b.max.x >= box.min.x && b.min.y <= box.max.y && b.max.y >= box.min.y
+            && b.min.z <= box.max.z && b.max.z >= box.min.z;
+    };
+
+    uint32_t stack[kStackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+        if (!overlaps(node.bounds)) continue;
+        if (node.count > 0)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                if (overlaps(m_objects[m_order[i]].worldBounds)) out.push_back(static_cast<int>(m_order[i]));
+            }
+            continue;
+        }
+        assert(top + 2 <= kStackSize);
+        stack[top++] = node.first + 1;
+        stack[top++] = node.first;
+    }
+}
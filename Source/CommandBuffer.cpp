@@ -0,0 +1,58 @@
+#include "../Header/CommandBuffer.h"
+
+CommandBuffer::~CommandBuffer()
+{
+    clear();
+}
+
+unsigned char* CommandBuffer::allocate(size_t size)
+{
+    if (m_blocks.empty()) m_blocks.push_back(Block{ std::unique_ptr<unsigned char[]>(new unsigned char[kBlockSize]), 0 });
+    if (m_blocks[m_current].used + size > kBlockSize)
+    {
+        // commands never straddle blocks; later blocks stay allocated for the next frames
+        ++m_current;
+        if (m_current == m_blocks.size()) m_blocks.push_back(Block{ std::unique_ptr<unsigned char[]>(new unsigned char[kBlockSize]), 0 });
+    }
+    Block& block = m_blocks[m_current];
+    unsigned char* mem = block.data.get() + block.used;
+    block.used += size;
+    return mem;
+}
+
+void CommandBuffer::walk(bool run)
+{
+    for (size_t b = 0; b < m_blocks.size() && b <= m_current; ++b)
+    {
+        Block& block = m_blocks[b];
+        size_t offset = 0;
+        while (offset < block.used)
+        {
+            Header* header = reinterpret_cast<Header*>(block.data.get() + offset);
+            void* payload = block.data.get() + offset + kHeaderSize;
+            if (run) header->run(payload);
+            if (header->destroy) header->destroy(payload);
+            offset += header->size;
+        }
+        block.used = 0;
+    }
+    m_current = 0;
+    m_count = 0;
+}
+
+void CommandBuffer::execute()
+{
+    walk(true);
+}
+
+void CommandBuffer::clear()
+{
+    walk(false);
+}
+
+size_t CommandBuffer::bytesUsed() const
+{
+    size_t total = 0;
+    for (const Block& block : m_blocks) total += block.used;
+    return total;
+}
@@ -0,0 +1,164 @@
+#include "../Header/DisplayPanel.h"
+
+#include "../Header/GlBindings.h"
+#include "../Header/MemoryLedger.h"
+#include "../Header/State.h"
+#include "../Header/TextRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+DisplayPanel::DisplayPanel(const std::array<RectShape, 3>& screens, float pixelScale)
+    : m_pixelScale(pixelScale)
+{
+    float minX = screens[0].x;
+    float minY = screens[0].y;
+    float maxX = screens[0].x + screens[0].w;
+    float maxY = screens[0].y + screens[0].h;
+    for (const RectShape& s : screens)
+    {
+        minX = std::min(minX, s.x);
+        minY = std::min(minY, s.y);
+        maxX = std::max(maxX, s.x + s.w);
+        maxY = std::max(maxY, s.y + s.h);
+    }
+    m_bounds = RectShape{ minX, minY, maxX - minX, maxY - minY, screens[0].color };
+
+    for (size_t i = 0; i < screens.size(); ++i)
+    {
+        m_screens[i] = screens[i];
+        m_screens[i].x -= minX;
+        m_screens[i].y -= minY;
+    }
+
+    m_width = static_cast<int>(std::ceil(m_bounds.w * m_pixelScale));
+    m_height = static_cast<int>(std::ceil(m_bounds.h * m_pixelScale));
+}
+
+bool DisplayPanel::init()
+{
+    m_texture = GlTexture::create();
+    GlBindings::bindTexture2D(m_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    // the mip chain adds a third on top of the base level
+    MemoryLedger::trackGl(MemoryCategory::RenderTargets, GlObjectType::Texture, m_texture, size_t(4) * m_width * m_height * 4 / 3);
+    // mipmapped so the panel stays clean when the camera looks at the AC from far away
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GlBindings::bindTexture2D(0);
+
+    GLint prevFbo = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    m_fbo = GlFramebuffer::create();
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "Display panel framebuffer incomplete: 0x" << std::hex << status << std::dec << std::endl;
+        return false;
+    }
+
+    // own 2D renderer sized to the texture
+    m_renderer = std::make_unique<Renderer2D>(m_width, m_height, "Shaders/basic.vert", "Shaders/basic.frag");
+    m_valid = false;
+    return true;
+}
+
+void DisplayPanel::setColors(const Color& screenOn, const Color& screenOff, const Color& digits)
+{
+    m_screenOn = screenOn;
+    m_screenOff = screenOff;
+    m_digits = digits;
+    m_valid = false;
+}
+
+bool DisplayPanel::update(const AppState& state, TextRenderer& textRenderer)
+{
+    if (m_fbo == 0) return false;
+
+    DisplayPanelContent content;
+    content.desiredTemp = static_cast<int>(std::round(state.desiredTemp));
+    content.currentTemp = static_cast<int>(std::round(state.currentTemp));
+    content.isOn = state.isOn;
+    content.status = statusCategory(state.desiredTemp, state.currentTemp);
+    if (m_valid && content == m_content) return false;
+
+    m_content = content;
+    render(textRenderer);
+    m_valid = true;
+    return true;
+}
+
+void DisplayPanel::render(TextRenderer& textRenderer)
+{
+    // save the state the main pass relies on
+    GLint prevFbo = 0;
+    GLint prevViewport[4] = { 0, 0, 0, 0 };
+    GLint prevSrcRgb = GL_SRC_ALPHA, prevDstRgb = GL_ONE_MINUS_SRC_ALPHA;
+    GLint prevSrcAlpha = GL_SRC_ALPHA, prevDstAlpha = GL_ONE_MINUS_SRC_ALPHA;
+    GLfloat prevClear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    glGetIntegerv(GL_VIEWPORT, prevViewport);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &prevSrcRgb);
+    glGetIntegerv(GL_BLEND_DST_RGB, &prevDstRgb);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &prevSrcAlpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &prevDstAlpha);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, prevClear);
+    GLboolean prevDepth = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean prevCull = glIsEnabled(GL_CULL_FACE);
+    float prevTextW = textRenderer.windowWidth();
+    float prevTextH = textRenderer.windowHeight();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glViewport(0, 0, m_width, m_height);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    // accumulate coverage in alpha instead of squaring it, so anti-aliased edges stay opaque on the screens
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    auto scaled = [&](const RectShape& r)
+    {
+        return RectShape{ r.x * m_pixelScale, r.y * m_pixelScale, r.w * m_pixelScale, r.h * m_pixelScale, r.color };
+    };
+
+    const Color& screenColor = m_content.isOn ? m_screenOn : m_screenOff;
+    m_renderer->beginBatch();
+    for (const RectShape& s : m_screens)
+    {
+        RectShape r = scaled(s);
+        m_renderer->drawRoundedRect(r.x, r.y, r.w, r.h, 3.0f * m_pixelScale, screenColor);
+    }
+    m_renderer->flush();
+
+    if (m_content.isOn)
+    {
+        textRenderer.setWindowSize(static_cast<float>(m_width), static_cast<float>(m_height));
+        drawTemperatureValue(textRenderer, static_cast<float>(m_content.desiredTemp), scaled(m_screens[0]), m_digits);
+        drawTemperatureValue(textRenderer, static_cast<float>(m_content.currentTemp), scaled(m_screens[1]), m_digits);
+        textRenderer.setWindowSize(prevTextW, prevTextH);
+    }
+
+    // the icon only depends on the category, so a representative pair is enough
+    float desired = 0.0f;
+    if (m_content.status == StatusCategory::Heating) desired = 1.0f;
+    else if (m_content.status == StatusCategory::Cooling) desired = -1.0f;
+    drawStatusIcon(*m_renderer, scaled(m_screens[2]), desired, 0.0f);
+
+    GlBindings::bindTexture2D(m_texture);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    GlBindings::bindTexture2D(0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+    glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+    glBlendFuncSeparate(prevSrcRgb, prevDstRgb, prevSrcAlpha, prevDstAlpha);
+    glClearColor(prevClear[0], prevClear[1], prevClear[2], prevClear[3]);
+    if (prevDepth) glEnable(GL_DEPTH_TEST);
+    if (prevCull) glEnable(GL_CULL_FACE);
+}
@@ -0,0 +1,99 @@
+#include "../Header/DistanceField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    constexpr float kInfinity = 1e20f;
+
+    // 1D squared Euclidean distance transform (Felzenszwalb & Huttenlocher).
+    // f holds 0 for feature pixels and kInfinity elsewhere; d receives squared distances.
+    void distanceTransform1D(const float* f, int n, float* d, int* v, float* z)
+    {
+        int k = 0;
+        v[0] = 0;
+        z[0] = -kInfinity;
+        z[1] = kInfinity;
+        for (int q = 1; q < n; ++q)
+        {
+            float s = ((f[q] + static_cast<float>(q * q)) - (f[v[k]] + static_cast<float>(v[k] * v[k]))) / static_cast<float>(2 * q - 2 * v[k]);
+            while (s <= z[k])
+            {
+                --k;
+                s = ((f[q] + static_cast<float>(q * q)) - (f[v[k]] + static_cast<float>(v[k] * v[k]))) / static_cast<float>(2 * q - 2 * v[k]);
+            }
+            ++k;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = kInfinity;
+        }
+
+        k = 0;
+        for (int q = 0; q < n; ++q)
+        {
+            while (z[k + 1] < static_cast<float>(q)) ++k;
+            float dq = static_cast<float>(q - v[k]);
+            d[q] = dq * dq + f[v[k]];
+        }
+    }
+
+    // Separable 2D transform: columns first, then rows, in place on grid.
+    void distanceTransform2D(std::vector<float>& grid, int width, int height)
+    {
+        int n = std::max(width, height);
+        std::vector<float> f(n), d(n), z(n + 1);
+        std::vector<int> v(n);
+
+        for (int x = 0; x < width; ++x)
+        {
+            for (int y = 0; y < height; ++y) f[y] = grid[y * width + x];
+            distanceTransform1D(f.data(), height, d.data(), v.data(), z.data());
+            for (int y = 0; y < height; ++y) grid[y * width + x] = d[y];
+        }
+
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x) f[x] = grid[y * width + x];
+            distanceTransform1D(f.data(), width, d.data(), v.data(), z.data());
+            for (int x = 0; x < width; ++x) grid[y * width + x] = d[x];
+        }
+    }
+}
+
+void buildSignedDistanceField(const unsigned char* coverage, int width, int height, int spread, unsigned char* out)
+{
+    int outW = width + spread * 2;
+    int outH = height + spread * 2;
+    size_t count = static_cast<size_t>(outW) * static_cast<size_t>(outH);
+
+    // toInside: distance from each pixel to the nearest inked pixel; toOutside: the reverse.
+    std::vector<float> toInside(count, kInfinity);
+    std::vector<float> toOutside(count, 0.0f);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            if (coverage[y * width + x] < 128) continue;
+            size_t idx = static_cast<size_t>(y + spread) * static_cast<size_t>(outW) + static_cast<size_t>(x + spread);
+            toInside[idx] = 0.0f;
+            toOutside[idx] = kInfinity;
+        }
+    }
+
+    distanceTransform2D(toInside, outW, outH);
+    distanceTransform2D(toOutside, outW, outH);
+
+    float invRange = 1.0f / (2.0f * static_cast<float>(std::max(spread, 1)));
+    for (size_t i = 0; i < count; ++i)
+    {
+        // pixel centres sit half a pixel from the outline they border
+        float signedDist = toInside[i] > 0.0f
+            ? -(std::sqrt(toInside[i]) - 0.5f)
+            : (std::sqrt(toOutside[i]) - 0.5f);
+        float value = 0.5f + signedDist * invRange;
+        value = std::max(0.0f, std::min(1.0f, value));
+        out[i] = static_cast<unsigned char>(value * 255.0f + 0.5f);
+    }
+}
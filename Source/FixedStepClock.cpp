@@ -0,0 +1,42 @@
+#include "../Header/FixedStepClock.h"
+
+#include <algorithm>
+#include <cmath>
+
+FixedStepClock::FixedStepClock(double tickRate, int maxStepsPerFrame)
+{
+    setTickRate(tickRate);
+    setMaxStepsPerFrame(maxStepsPerFrame);
+}
+
+void FixedStepClock::setTickRate(double tickRate)
+{
+    m_step = 1.0 / std::max(tickRate, 1.0);
+    m_accumulator = std::min(m_accumulator, m_step);
+}
+
+void FixedStepClock::setMaxStepsPerFrame(int maxSteps)
+{
+    m_maxSteps = std::max(maxSteps, 1);
+}
+
+int FixedStepClock::advance(double frameSeconds)
+{
+    if (frameSeconds > 0.0) m_accumulator += frameSeconds;
+
+    int steps = static_cast<int>(std::floor(m_accumulator / m_step));
+    if (steps > m_maxSteps)
+    {
+        m_dropped += static_cast<uint64_t>(steps - m_maxSteps);
+        steps = m_maxSteps;
+        // keep the partial step so interpolation stays continuous after the stall
+        m_accumulator = std::fmod(m_accumulator, m_step);
+    }
+    else
+    {
+        m_accumulator -= steps * m_step;
+    }
+
+    m_ticks += static_cast<uint64_t>(steps);
+    return steps;
+}
@@ -0,0 +1,174 @@
+#include "../Header/FontAtlasCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr char kMagic[4] = { 'A', 'C', 'F', 'A' };
+    constexpr uint32_t kVersion = 1;
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        int32_t atlasWidth;
+        int32_t atlasHeight;
+        int32_t cellSize;
+        uint32_t glyphCount;
+    };
+}
+
+FontAtlasFile::~FontAtlasFile()
+{
+    close();
+}
+
+void FontAtlasFile::close()
+{
+#ifndef _WIN32
+    if (m_data != nullptr && m_buffer.empty())
+    {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+#endif
+    m_buffer.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_glyphs = nullptr;
+    m_pixels = nullptr;
+    m_glyphCount = 0;
+}
+
+bool FontAtlasFile::open(const std::string& path, uint64_t key)
+{
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            m_data = static_cast<const unsigned char*>(mapped);
+            m_size = static_cast<size_t>(st.st_size);
+        }
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (in.good())
+    {
+        m_buffer.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        if (in.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size())))
+        {
+            m_data = m_buffer.data();
+            m_size = m_buffer.size();
+        }
+    }
+#endif
+    if (m_data == nullptr) return false;
+
+    FileHeader header;
+    if (m_size < sizeof(header))
+    {
+        close();
+        return false;
+    }
+    std::memcpy(&header, m_data, sizeof(header));
+    size_t glyphBytes = static_cast<size_t>(header.glyphCount) * sizeof(BakedGlyph);
+    size_t pixelBytes = static_cast<size_t>(header.atlasWidth) * static_cast<size_t>(header.atlasHeight);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion || header.key != key
+        || header.atlasWidth <= 0 || header.atlasHeight <= 0 || header.cellSize <= 0
+        || m_size != sizeof(header) + glyphBytes + pixelBytes)
+    {
+        close();
+        return false;
+    }
+
+    m_atlasWidth = header.atlasWidth;
+    m_atlasHeight = header.atlasHeight;
+    m_cellSize = header.cellSize;
+    m_glyphCount = header.glyphCount;
+    // header is 32 bytes, so the glyph table stays 4-byte aligned inside the page-aligned mapping
+    m_glyphs = reinterpret_cast<const BakedGlyph*>(m_data + sizeof(header));
+    m_pixels = m_data + sizeof(header) + glyphBytes;
+    return true;
+}
+
+bool writeFontAtlasFile(const std::string& path, uint64_t key, int atlasWidth, int atlasHeight, int cellSize,
+                        const std::vector<BakedGlyph>& glyphs, const unsigned char* pixels)
+{
+    std::error_code ec;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), ec);
+
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.key = key;
+    header.atlasWidth = atlasWidth;
+    header.atlasHeight = atlasHeight;
+    header.cellSize = cellSize;
+    header.glyphCount = static_cast<uint32_t>(glyphs.size());
+
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.good()) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(glyphs.data()), static_cast<std::streamsize>(glyphs.size() * sizeof(BakedGlyph)));
+        out.write(reinterpret_cast<const char*>(pixels), static_cast<std::streamsize>(atlasWidth) * atlasHeight);
+        if (!out.good()) return false;
+    }
+
+    std::filesystem::rename(tmpPath, target, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+bool hashFile(const std::string& path, uint64_t& outHash)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in.good()) return false;
+
+    uint64_t h = hashBytes(nullptr, 0);
+    char chunk[64 * 1024];
+    while (in)
+    {
+        in.read(chunk, sizeof(chunk));
+        h = hashBytes(chunk, static_cast<size_t>(in.gcount()), h);
+    }
+    outHash = h;
+    return true;
+}
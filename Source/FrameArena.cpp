@@ -0,0 +1,80 @@
+#include "../Header/FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+    size_t alignUp(size_t n, size_t alignment)
+    {
+        return (n + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+FrameArena::FrameArena(size_t capacity)
+    : m_block(new unsigned char[capacity])
+    , m_capacity(capacity)
+    , m_memory(MemoryCategory::FrameArenas, capacity)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    reset();
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment)
+{
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_block.get());
+    size_t offset = alignUp(base + m_used, alignment) - base;
+    if (offset + bytes <= m_capacity)
+    {
+        m_used = offset + bytes;
+        return m_block.get() + offset;
+    }
+
+    // spill: the header sits in front of the payload, padded to keep the payload aligned
+    size_t align = std::max(alignment, alignof(std::max_align_t));
+    size_t header = alignUp(sizeof(Overflow) + 2 * sizeof(size_t), align);
+    size_t total = header + bytes;
+    unsigned char* mem = static_cast<unsigned char*>(std::pmr::new_delete_resource()->allocate(total, align));
+    Overflow* node = reinterpret_cast<Overflow*>(mem);
+    node->next = m_overflow;
+    size_t* sizes = reinterpret_cast<size_t*>(mem + sizeof(Overflow));
+    sizes[0] = total;
+    sizes[1] = align;
+    m_overflow = node;
+    m_overflowBytes += bytes;
+    return mem + header;
+}
+
+void FrameArena::do_deallocate(void*, size_t, size_t)
+{
+    // memory is reclaimed in bulk by reset()
+}
+
+void FrameArena::reset()
+{
+    size_t used = bytesUsed();
+    m_highWater = std::max(m_highWater, used);
+
+    bool spilled = m_overflow != nullptr;
+    while (m_overflow != nullptr)
+    {
+        Overflow* next = m_overflow->next;
+        const size_t* sizes = reinterpret_cast<const size_t*>(reinterpret_cast<unsigned char*>(m_overflow) + sizeof(Overflow));
+        std::pmr::new_delete_resource()->deallocate(m_overflow, sizes[0], sizes[1]);
+        m_overflow = next;
+    }
+    m_overflowBytes = 0;
+    m_used = 0;
+
+    if (spilled)
+    {
+        // grow with headroom for alignment padding, so the same load fits next frame
+        ++m_overflowFrames;
+        m_capacity = std::max(m_capacity * 2, used + used / 4);
+        m_block.reset(new unsigned char[m_capacity]);
+        m_memory.set(m_capacity);
+    }
+}
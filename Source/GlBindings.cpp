@@ -0,0 +1,31 @@
+#include "../Header/GlBindings.h"
+
+namespace
+{
+    GLuint g_program = 0;
+    GLuint g_texture2D = 0;
+}
+
+bool GlBindings::useProgram(GLuint program, RenderStats* stats)
+{
+    if (program == g_program) return false;
+    glUseProgram(program);
+    g_program = program;
+    if (stats) stats->programSwitches++;
+    return true;
+}
+
+bool GlBindings::bindTexture2D(GLuint texture, RenderStats* stats)
+{
+    if (texture == g_texture2D) return false;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    g_texture2D = texture;
+    if (stats) stats->textureBinds++;
+    return true;
+}
+
+void GlBindings::forget(GlObjectType type, GLuint id)
+{
+    if (type == GlObjectType::Program && id == g_program) g_program = 0;
+    if (type == GlObjectType::Texture && id == g_texture2D) g_texture2D = 0;
+}
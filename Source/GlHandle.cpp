@@ -0,0 +1,140 @@
+#include "../Header/GlHandle.h"
+
+#include "../Header/GlBindings.h"
+#include "../Header/MemoryLedger.h"
+
+#include <vector>
+
+namespace
+{
+    struct Deletion
+    {
+        GlObjectType type;
+        GLuint id;
+        GlDeletionQueue::RetireFn retire;
+        uint64_t key;
+    };
+
+    struct Batch
+    {
+        GLsync fence = nullptr;
+        std::vector<Deletion> deletions; // keeps its capacity when recycled
+    };
+
+    // Frames of deletions that may be waiting for the GPU; more than this many frames in
+    // flight means the GPU is far behind, and endFrame waits for the oldest batch.
+    constexpr size_t kMaxBatches = 8;
+
+    std::vector<Deletion> g_current;
+    Batch g_batches[kMaxBatches];
+    size_t g_oldest = 0;
+    size_t g_batchCount = 0;
+    bool g_shutDown = false;
+
+    void destroy(const Deletion& d)
+    {
+        switch (d.type)
+        {
+        case GlObjectType::Texture: glDeleteTextures(1, &d.id); break;
+        case GlObjectType::Buffer: glDeleteBuffers(1, &d.id); break;
+        case GlObjectType::VertexArray: glDeleteVertexArrays(1, &d.id); break;
+        case GlObjectType::Program: glDeleteProgram(d.id); break;
+        case GlObjectType::Framebuffer: glDeleteFramebuffers(1, &d.id); break;
+        case GlObjectType::Renderbuffer: glDeleteRenderbuffers(1, &d.id); break;
+        }
+        MemoryLedger::untrackGl(d.type, d.id);
+        GlBindings::forget(d.type, d.id);
+    }
+
+    // Frees the oldest batch, waiting for its fence when `wait` is set; returns false if it is
+    // still in use.
+    bool retireOldest(bool wait)
+    {
+        Batch& batch = g_batches[g_oldest];
+        if (wait)
+        {
+            while (glClientWaitSync(batch.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000) == GL_TIMEOUT_EXPIRED) {}
+        }
+        else if (glClientWaitSync(batch.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            return false;
+        }
+
+        for (const Deletion& d : batch.deletions)
+        {
+            if (d.retire != nullptr) d.retire(d.type, d.id, d.key);
+            else destroy(d);
+        }
+        batch.deletions.clear();
+        glDeleteSync(batch.fence);
+        batch.fence = nullptr;
+        g_oldest = (g_oldest + 1) % kMaxBatches;
+        --g_batchCount;
+        return true;
+    }
+}
+
+template <GlObjectType Type>
+GlHandle<Type> GlHandle<Type>::create()
+{
+    GLuint id = 0;
+    switch (Type)
+    {
+    case GlObjectType::Texture: glGenTextures(1, &id); break;
+    case GlObjectType::Buffer: glGenBuffers(1, &id); break;
+    case GlObjectType::VertexArray: glGenVertexArrays(1, &id); break;
+    case GlObjectType::Program: break;
+    case GlObjectType::Framebuffer: glGenFramebuffers(1, &id); break;
+    case GlObjectType::Renderbuffer: glGenRenderbuffers(1, &id); break;
+    }
+    return GlHandle(id);
+}
+
+template class GlHandle<GlObjectType::Texture>;
+template class GlHandle<GlObjectType::Buffer>;
+template class GlHandle<GlObjectType::VertexArray>;
+template class GlHandle<GlObjectType::Program>;
+template class GlHandle<GlObjectType::Framebuffer>;
+template class GlHandle<GlObjectType::Renderbuffer>;
+
+void GlDeletionQueue::defer(GlObjectType type, GLuint id)
+{
+    if (g_shutDown) return;
+    g_current.push_back(Deletion{ type, id, nullptr, 0 });
+}
+
+void GlDeletionQueue::recycle(GlObjectType type, GLuint id, RetireFn retire, uint64_t key)
+{
+    if (g_shutDown) return;
+    g_current.push_back(Deletion{ type, id, retire, key });
+}
+
+void GlDeletionQueue::endFrame()
+{
+    while (g_batchCount > 0 && retireOldest(false)) {}
+    if (g_current.empty()) return;
+
+    if (g_batchCount == kMaxBatches) retireOldest(true);
+    Batch& batch = g_batches[(g_oldest + g_batchCount) % kMaxBatches];
+    batch.deletions.swap(g_current);
+    batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++g_batchCount;
+}
+
+void GlDeletionQueue::shutdown()
+{
+    // retiring a recycled name may queue its deletion, so repeat until nothing is left
+    do
+    {
+        endFrame();
+        while (g_batchCount > 0) retireOldest(true);
+    } while (!g_current.empty());
+    g_shutDown = true;
+}
+
+size_t GlDeletionQueue::pendingCount()
+{
+    size_t count = g_current.size();
+    for (size_t i = 0; i < g_batchCount; ++i) count += g_batches[(g_oldest + i) % kMaxBatches].deletions.size();
+    return count;
+}
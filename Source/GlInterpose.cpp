@@ -0,0 +1,807 @@
+// The wrappers forward to the real entry points, so this file must not see the redirects.
+#define AC_GL_INTERPOSE_IMPL
+#include "../Header/GlInterpose.h"
+
+#include <iostream>
+
+#if AC_GL_INTERPOSE
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using GlInterpose::Backend;
+
+namespace
+{
+    enum class CallId : uint16_t
+    {
+#define AC_GL_CALL_ID(name) name,
+        AC_GL_CALLS(AC_GL_CALL_ID)
+#undef AC_GL_CALL_ID
+        Count
+    };
+
+    constexpr size_t kCallCount = static_cast<size_t>(CallId::Count);
+    constexpr uint16_t kFrameMarker = 0xFFFF;
+
+    const char* const kCallNames[kCallCount] = {
+#define AC_GL_CALL_NAME(name) "gl" #name,
+        AC_GL_CALLS(AC_GL_CALL_NAME)
+#undef AC_GL_CALL_NAME
+    };
+
+    // Trace layout: a TraceHeader, then one record per call. A record is a RecordHeader, the
+    // arguments in order (pointers as 64-bit values), length-prefixed blocks of client memory
+    // the call reads, the return value, and blocks of memory it wrote. Records and blocks start
+    // on 8-byte boundaries. endFrame writes a kFrameMarker record holding the frame number.
+    struct TraceHeader
+    {
+        char magic[8];
+        uint32_t callCount; // entries in AC_GL_CALLS when the trace was written
+        uint32_t reserved;
+        uint64_t frame;     // the captured frame
+    };
+
+    struct RecordHeader
+    {
+        uint16_t call;
+        uint16_t reserved;
+        uint32_t size; // header included
+        uint64_t startNs;
+        uint64_t durationNs;
+    };
+
+    const char kMagic[8] = { 'A', 'C', 'G', 'L', 'T', 'R', 'C', '1' };
+
+    Backend g_backend = Backend::Driver;
+    uint64_t g_calls = 0;
+    GLuint g_nullNames = 0;
+    uintptr_t g_nullSyncs = 0;
+    std::vector<unsigned char> g_nullMapping;
+
+    // Capture state. GL calls and endFrame all come from the thread that owns the context.
+    FILE* g_traceFile = nullptr;
+    bool g_tracing = false;
+    uint64_t g_frame = 0;
+    uint64_t g_traceFrame = 0;
+    std::chrono::steady_clock::time_point g_traceStart;
+    std::vector<unsigned char> g_record;
+    GLint g_unpackAlignment = 4;
+
+    uint64_t sinceTraceStart()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_traceStart).count());
+    }
+
+    void align8(std::vector<unsigned char>& bytes)
+    {
+        bytes.resize((bytes.size() + 7) & ~size_t(7));
+    }
+
+    template <typename T>
+    void put(T value)
+    {
+        if constexpr (std::is_pointer_v<T>)
+        {
+            put(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+        }
+        else
+        {
+            const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+            g_record.insert(g_record.end(), bytes, bytes + sizeof(T));
+        }
+    }
+
+    void putBlock(const void* data, size_t bytes)
+    {
+        align8(g_record);
+        put(static_cast<uint64_t>(bytes));
+        const auto* begin = static_cast<const unsigned char*>(data);
+        g_record.insert(g_record.end(), begin, begin + bytes);
+    }
+
+    void stopTrace()
+    {
+        if (g_traceFile) std::fclose(g_traceFile);
+        g_traceFile = nullptr;
+        g_tracing = false;
+        std::vector<unsigned char>().swap(g_record);
+    }
+
+    void writeRecord(uint16_t call, uint64_t startNs, uint64_t durationNs)
+    {
+        align8(g_record);
+        RecordHeader header{ call, 0, static_cast<uint32_t>(g_record.size()), startNs, durationNs };
+        std::memcpy(g_record.data(), &header, sizeof(header));
+        if (std::fwrite(g_record.data(), 1, g_record.size(), g_traceFile) != g_record.size())
+        {
+            std::cerr << "GL trace: write failed, capture stopped" << std::endl;
+            stopTrace();
+        }
+    }
+
+    size_t imageBytes(GLsizei width, GLsizei height, GLenum format, GLenum type)
+    {
+        if (width <= 0 || height <= 0) return 0;
+        size_t components = 4;
+        switch (format)
+        {
+        case GL_RED:
+        case GL_RED_INTEGER:
+        case GL_DEPTH_COMPONENT: components = 1; break;
+        case GL_RG: components = 2; break;
+        case GL_RGB:
+        case GL_BGR: components = 3; break;
+        default: break;
+        }
+        size_t componentBytes = 1;
+        if (type == GL_FLOAT || type == GL_UNSIGNED_INT || type == GL_INT) componentBytes = 4;
+        else if (type == GL_HALF_FLOAT || type == GL_UNSIGNED_SHORT || type == GL_SHORT) componentBytes = 2;
+        // rows are padded to the unpack alignment, except the last
+        const size_t row = static_cast<size_t>(width) * components * componentBytes;
+        const size_t alignment = static_cast<size_t>(std::max(g_unpackAlignment, 1));
+        const size_t stride = (row + alignment - 1) / alignment * alignment;
+        return stride * static_cast<size_t>(height - 1) + row;
+    }
+
+    // Client memory behind pointer arguments. `before` runs ahead of the call for memory the
+    // call reads, `after` once it returns for memory it wrote.
+    struct NoPayload
+    {
+        template <typename... A> static void before(A...) {}
+        template <typename... A> static void after(A...) {}
+    };
+
+    template <CallId Id> struct Payload : NoPayload {};
+
+    struct NamesRead : NoPayload
+    {
+        static void before(GLsizei n, const GLuint* names) { if (names) putBlock(names, static_cast<size_t>(std::max(n, 0)) * sizeof(GLuint)); }
+    };
+
+    struct NamesWritten : NoPayload
+    {
+        static void after(GLsizei n, GLuint* names) { putBlock(names, static_cast<size_t>(std::max(n, 0)) * sizeof(GLuint)); }
+    };
+
+    template <> struct Payload<CallId::GenBuffers> : NamesWritten {};
+    template <> struct Payload<CallId::GenFramebuffers> : NamesWritten {};
+    template <> struct Payload<CallId::GenRenderbuffers> : NamesWritten {};
+    template <> struct Payload<CallId::GenTextures> : NamesWritten {};
+    template <> struct Payload<CallId::GenVertexArrays> : NamesWritten {};
+    template <> struct Payload<CallId::DeleteBuffers> : NamesRead {};
+    template <> struct Payload<CallId::DeleteFramebuffers> : NamesRead {};
+    template <> struct Payload<CallId::DeleteRenderbuffers> : NamesRead {};
+    template <> struct Payload<CallId::DeleteTextures> : NamesRead {};
+    template <> struct Payload<CallId::DeleteVertexArrays> : NamesRead {};
+
+    template <> struct Payload<CallId::DrawBuffers> : NoPayload
+    {
+        static void before(GLsizei n, const GLenum* buffers) { if (buffers) putBlock(buffers, static_cast<size_t>(std::max(n, 0)) * sizeof(GLenum)); }
+    };
+
+    template <> struct Payload<CallId::BufferData> : NoPayload
+    {
+        static void before(GLenum, GLsizeiptr size, const void* data, GLenum) { if (data) putBlock(data, static_cast<size_t>(size)); }
+    };
+
+    template <> struct Payload<CallId::BufferSubData> : NoPayload
+    {
+        static void before(GLenum, GLintptr, GLsizeiptr size, const void* data) { if (data) putBlock(data, static_cast<size_t>(size)); }
+    };
+
+    template <> struct Payload<CallId::TexImage2D> : NoPayload
+    {
+        static void before(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type, const void* pixels)
+        {
+            if (pixels) putBlock(pixels, imageBytes(width, height, format, type));
+        }
+    };
+
+    template <> struct Payload<CallId::TexSubImage2D> : NoPayload
+    {
+        static void before(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+        {
+            if (pixels) putBlock(pixels, imageBytes(width, height, format, type));
+        }
+    };
+
+    template <> struct Payload<CallId::PixelStorei> : NoPayload
+    {
+        static void before(GLenum pname, GLint param) { if (pname == GL_UNPACK_ALIGNMENT) g_unpackAlignment = param; }
+    };
+
+    template <> struct Payload<CallId::UniformMatrix4fv> : NoPayload
+    {
+        static void before(GLint, GLsizei count, GLboolean, const GLfloat* value) { if (value) putBlock(value, static_cast<size_t>(std::max(count, 0)) * 16 * sizeof(GLfloat)); }
+    };
+
+    template <> struct Payload<CallId::ClearBufferfv> : NoPayload
+    {
+        static void before(GLenum buffer, GLint, const GLfloat* value) { if (value) putBlock(value, (buffer == GL_COLOR ? 4 : 1) * sizeof(GLfloat)); }
+    };
+
+    template <> struct Payload<CallId::ClearBufferuiv> : NoPayload
+    {
+        static void before(GLenum, GLint, const GLuint* value) { if (value) putBlock(value, 4 * sizeof(GLuint)); }
+    };
+
+    template <> struct Payload<CallId::GetUniformLocation> : NoPayload
+    {
+        static void before(GLuint, const GLchar* name) { if (name) putBlock(name, std::strlen(name) + 1); }
+    };
+
+    template <> struct Payload<CallId::ShaderSource> : NoPayload
+    {
+        static void before(GLuint, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+        {
+            for (GLsizei i = 0; strings && i < count; ++i)
+            {
+                size_t length = lengths && lengths[i] >= 0 ? static_cast<size_t>(lengths[i]) : std::strlen(strings[i]);
+                putBlock(strings[i], length);
+            }
+        }
+    };
+
+    // Null backend: calls without outputs are dropped; the rest get answers that keep the
+    // renderers on their normal path (objects exist, shaders compile, framebuffers are complete).
+    template <CallId Id> struct NullBackend
+    {
+        template <typename... A> static void call(A...) {}
+    };
+
+    struct NullNames
+    {
+        static void call(GLsizei n, GLuint* names) { for (GLsizei i = 0; i < n; ++i) names[i] = ++g_nullNames; }
+    };
+
+    struct NullStatus
+    {
+        static void call(GLuint, GLenum pname, GLint* params) { *params = pname == GL_INFO_LOG_LENGTH ? 0 : GL_TRUE; }
+    };
+
+    struct NullInfoLog
+    {
+        static void call(GLuint, GLsizei bufSize, GLsizei* length, GLchar* log)
+        {
+            if (length) *length = 0;
+            if (log && bufSize > 0) log[0] = '\0';
+        }
+    };
+
+    template <> struct NullBackend<CallId::GenBuffers> : NullNames {};
+    template <> struct NullBackend<CallId::GenFramebuffers> : NullNames {};
+    template <> struct NullBackend<CallId::GenRenderbuffers> : NullNames {};
+    template <> struct NullBackend<CallId::GenTextures> : NullNames {};
+    template <> struct NullBackend<CallId::GenVertexArrays> : NullNames {};
+    template <> struct NullBackend<CallId::GetShaderiv> : NullStatus {};
+    template <> struct NullBackend<CallId::GetProgramiv> : NullStatus {};
+    template <> struct NullBackend<CallId::GetShaderInfoLog> : NullInfoLog {};
+    template <> struct NullBackend<CallId::GetProgramInfoLog> : NullInfoLog {};
+
+    template <> struct NullBackend<CallId::CreateShader>
+    {
+        static GLuint call(GLenum) { return ++g_nullNames; }
+    };
+
+    template <> struct NullBackend<CallId::CreateProgram>
+    {
+        static GLuint call() { return ++g_nullNames; }
+    };
+
+    // How many values a state query writes; callers pass arrays sized for it.
+    int nullValueCount(GLenum pname)
+    {
+        switch (pname)
+        {
+        case GL_VIEWPORT:
+        case GL_SCISSOR_BOX:
+        case GL_COLOR_CLEAR_VALUE:
+        case GL_BLEND_COLOR:
+        case GL_COLOR_WRITEMASK: return 4;
+        case GL_DEPTH_RANGE:
+        case GL_MAX_VIEWPORT_DIMS:
+        case GL_ALIASED_LINE_WIDTH_RANGE:
+        case GL_SMOOTH_LINE_WIDTH_RANGE:
+        case GL_POINT_SIZE_RANGE: return 2;
+        default: return 1;
+        }
+    }
+
+    template <> struct NullBackend<CallId::GetIntegerv>
+    {
+        static void call(GLenum pname, GLint* data) { std::fill_n(data, nullValueCount(pname), 0); }
+    };
+
+    template <> struct NullBackend<CallId::GetFloatv>
+    {
+        static void call(GLenum pname, GLfloat* data) { std::fill_n(data, nullValueCount(pname), 0.0f); }
+    };
+
+    template <> struct NullBackend<CallId::GetUniformLocation>
+    {
+        static GLint call(GLuint, const GLchar*) { return 0; }
+    };
+
+    template <> struct NullBackend<CallId::IsEnabled>
+    {
+        static GLboolean call(GLenum) { return GL_FALSE; }
+    };
+
+    template <> struct NullBackend<CallId::CheckFramebufferStatus>
+    {
+        static GLenum call(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+    };
+
+    template <> struct NullBackend<CallId::FenceSync>
+    {
+        static GLsync call(GLenum, GLbitfield) { return reinterpret_cast<GLsync>(++g_nullSyncs); }
+    };
+
+    template <> struct NullBackend<CallId::ClientWaitSync>
+    {
+        static GLenum call(GLsync, GLbitfield, GLuint64) { return GL_ALREADY_SIGNALED; }
+    };
+
+    template <> struct NullBackend<CallId::MapBufferRange>
+    {
+        static void* call(GLenum, GLintptr, GLsizeiptr length, GLbitfield)
+        {
+            g_nullMapping.assign(static_cast<size_t>(std::max<GLsizeiptr>(length, 1)), 0);
+            return g_nullMapping.data();
+        }
+    };
+
+    template <> struct NullBackend<CallId::UnmapBuffer>
+    {
+        static GLboolean call(GLenum) { return GL_TRUE; }
+    };
+
+    // Replay side of one trace record.
+    constexpr size_t kMaxArgs = 10;
+    constexpr size_t kScratchBytes = 64 * 1024;
+
+    struct Reader
+    {
+        const unsigned char* cursor = nullptr;
+        bool checkNames = true;
+        uint64_t mismatches = 0;
+        std::unordered_map<uint64_t, GLsync> syncs;
+        std::vector<const GLchar*> strings;
+        std::vector<GLint> lengths;
+        // outputs of the replayed calls land here, one slot per argument position
+        std::vector<unsigned char> scratch = std::vector<unsigned char>(kMaxArgs * kScratchBytes);
+
+        template <typename T>
+        T scalar()
+        {
+            T value;
+            std::memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return value;
+        }
+
+        const void* block(size_t* bytes = nullptr)
+        {
+            const uintptr_t at = reinterpret_cast<uintptr_t>(cursor);
+            cursor += ((at + 7) & ~uintptr_t(7)) - at;
+            const uint64_t size = scalar<uint64_t>();
+            const void* data = cursor;
+            cursor += size;
+            if (bytes) *bytes = static_cast<size_t>(size);
+            return data;
+        }
+
+        GLsync sync(uint64_t recorded)
+        {
+            auto it = syncs.find(recorded);
+            return it == syncs.end() ? nullptr : it->second;
+        }
+    };
+
+    // Restores arguments that pointed at client memory and checks memory the call wrote.
+    struct NoReplayData
+    {
+        template <typename Tuple> static void fix(Tuple&, Reader&) {}
+        template <typename Tuple> static void check(Tuple&, Reader&) {}
+    };
+
+    template <CallId Id> struct ReplayData : NoReplayData {};
+
+    template <size_t I>
+    struct DataArg : NoReplayData
+    {
+        template <typename Tuple>
+        static void fix(Tuple& args, Reader& in)
+        {
+            if (std::get<I>(args)) std::get<I>(args) = static_cast<std::tuple_element_t<I, Tuple>>(in.block());
+        }
+    };
+
+    struct NamesCheck : NoReplayData
+    {
+        template <typename Tuple>
+        static void check(Tuple& args, Reader& in)
+        {
+            size_t bytes = 0;
+            const void* recorded = in.block(&bytes);
+            if (in.checkNames && std::memcmp(recorded, std::get<1>(args), bytes) != 0) ++in.mismatches;
+        }
+    };
+
+    template <> struct ReplayData<CallId::GenBuffers> : NamesCheck {};
+    template <> struct ReplayData<CallId::GenFramebuffers> : NamesCheck {};
+    template <> struct ReplayData<CallId::GenRenderbuffers> : NamesCheck {};
+    template <> struct ReplayData<CallId::GenTextures> : NamesCheck {};
+    template <> struct ReplayData<CallId::GenVertexArrays> : NamesCheck {};
+    template <> struct ReplayData<CallId::DeleteBuffers> : DataArg<1> {};
+    template <> struct ReplayData<CallId::DeleteFramebuffers> : DataArg<1> {};
+    template <> struct ReplayData<CallId::DeleteRenderbuffers> : DataArg<1> {};
+    template <> struct ReplayData<CallId::DeleteTextures> : DataArg<1> {};
+    template <> struct ReplayData<CallId::DeleteVertexArrays> : DataArg<1> {};
+    template <> struct ReplayData<CallId::DrawBuffers> : DataArg<1> {};
+    template <> struct ReplayData<CallId::BufferData> : DataArg<2> {};
+    template <> struct ReplayData<CallId::BufferSubData> : DataArg<3> {};
+    template <> struct ReplayData<CallId::TexImage2D> : DataArg<8> {};
+    template <> struct ReplayData<CallId::TexSubImage2D> : DataArg<8> {};
+    template <> struct ReplayData<CallId::UniformMatrix4fv> : DataArg<3> {};
+    template <> struct ReplayData<CallId::ClearBufferfv> : DataArg<2> {};
+    template <> struct ReplayData<CallId::ClearBufferuiv> : DataArg<2> {};
+    template <> struct ReplayData<CallId::GetUniformLocation> : DataArg<1> {};
+
+    template <> struct ReplayData<CallId::ShaderSource> : NoReplayData
+    {
+        template <typename Tuple>
+        static void fix(Tuple& args, Reader& in)
+        {
+            in.strings.clear();
+            in.lengths.clear();
+            if (!std::get<2>(args)) return;
+            for (GLsizei i = 0; i < std::get<1>(args); ++i)
+            {
+                size_t bytes = 0;
+                in.strings.push_back(static_cast<const GLchar*>(in.block(&bytes)));
+                in.lengths.push_back(static_cast<GLint>(bytes));
+            }
+            std::get<2>(args) = in.strings.data();
+            std::get<3>(args) = in.lengths.data();
+        }
+    };
+
+    template <CallId Id, typename Real, typename Fn> struct Wrap;
+
+    template <CallId Id, typename Real, typename R, typename... Args>
+    struct Wrap<Id, Real, R (GLAPIENTRY*)(Args...)>
+    {
+        static_assert(sizeof...(Args) <= kMaxArgs, "raise kMaxArgs");
+
+        static R dispatch(Args... args)
+        {
+            if (g_backend == Backend::Null) return NullBackend<Id>::call(args...);
+            return Real::get()(args...);
+        }
+
+        static R GLAPIENTRY call(Args... args)
+        {
+            ++g_calls;
+            if (!g_tracing) return dispatch(args...);
+            g_record.assign(sizeof(RecordHeader), 0);
+            (put(args), ...);
+            Payload<Id>::before(args...);
+            const uint64_t start = sinceTraceStart();
+            if constexpr (std::is_void_v<R>)
+            {
+                dispatch(args...);
+                const uint64_t duration = sinceTraceStart() - start;
+                Payload<Id>::after(args...);
+                writeRecord(static_cast<uint16_t>(Id), start, duration);
+            }
+            else
+            {
+                R result = dispatch(args...);
+                const uint64_t duration = sinceTraceStart() - start;
+                put(result);
+                Payload<Id>::after(args...);
+                writeRecord(static_cast<uint16_t>(Id), start, duration);
+                return result;
+            }
+        }
+
+        template <typename T, size_t I>
+        static T arg(Reader& in)
+        {
+            if constexpr (std::is_same_v<T, GLsync>)
+            {
+                return in.sync(in.scalar<uint64_t>());
+            }
+            else if constexpr (std::is_pointer_v<T>)
+            {
+                // outputs go to scratch memory; const pointers are buffer offsets unless
+                // ReplayData swaps in recorded client memory
+                const uint64_t value = in.scalar<uint64_t>();
+                if constexpr (std::is_const_v<std::remove_pointer_t<T>>) return reinterpret_cast<T>(static_cast<uintptr_t>(value));
+                else return value ? reinterpret_cast<T>(in.scratch.data() + I * kScratchBytes) : nullptr;
+            }
+            else
+            {
+                return in.scalar<T>();
+            }
+        }
+
+        template <size_t... I>
+        static std::tuple<Args...> readArgs(Reader& in, std::index_sequence<I...>)
+        {
+            // braced initialization reads the arguments in order
+            return std::tuple<Args...>{ arg<Args, I>(in)... };
+        }
+
+        static void replay(Reader& in)
+        {
+            std::tuple<Args...> args = readArgs(in, std::index_sequence_for<Args...>{});
+            ReplayData<Id>::fix(args, in);
+            if constexpr (std::is_void_v<R>)
+            {
+                std::apply(Real::get(), args);
+            }
+            else
+            {
+                R result = std::apply(Real::get(), args);
+                if constexpr (std::is_same_v<R, GLsync>)
+                {
+                    in.syncs[in.scalar<uint64_t>()] = result;
+                }
+                else if constexpr (std::is_pointer_v<R>)
+                {
+                    in.scalar<uint64_t>();
+                }
+                else
+                {
+                    const R recorded = in.scalar<R>();
+                    constexpr bool names = Id == CallId::CreateProgram || Id == CallId::CreateShader || Id == CallId::GetUniformLocation;
+                    if (names && in.checkNames && recorded != result) ++in.mismatches;
+                }
+            }
+            ReplayData<Id>::check(args, in);
+        }
+    };
+
+    using ReplayFn = void (*)(Reader&);
+
+#define AC_GL_REAL(name) \
+    struct Real##name \
+    { \
+        static decltype(+gl##name) get() { return gl##name; } \
+    };
+    AC_GL_CALLS(AC_GL_REAL)
+#undef AC_GL_REAL
+
+    const ReplayFn kReplay[kCallCount] = {
+#define AC_GL_REPLAY(name) &Wrap<CallId::name, Real##name, decltype(+gl##name)>::replay,
+        AC_GL_CALLS(AC_GL_REPLAY)
+#undef AC_GL_REPLAY
+    };
+
+    bool readTrace(const char* path, std::vector<unsigned char>& bytes)
+    {
+        FILE* file = std::fopen(path, "rb");
+        if (!file) return false;
+        unsigned char chunk[64 * 1024];
+        size_t read = 0;
+        while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) bytes.insert(bytes.end(), chunk, chunk + read);
+        std::fclose(file);
+        return true;
+    }
+}
+
+#define AC_GL_DEFINE_WRAPPER(name) extern decltype(+gl##name) const acgl##name = &Wrap<CallId::name, Real##name, decltype(+gl##name)>::call;
+AC_GL_CALLS(AC_GL_DEFINE_WRAPPER)
+#undef AC_GL_DEFINE_WRAPPER
+
+void GlInterpose::setBackend(Backend backend)
+{
+    g_backend = backend;
+}
+
+Backend GlInterpose::backend()
+{
+    return g_backend;
+}
+
+bool GlInterpose::captureFrame(const char* path, uint64_t frame)
+{
+    if (g_tracing)
+    {
+        std::cerr << "GL trace: a capture is already running" << std::endl;
+        return false;
+    }
+    if (frame < g_frame)
+    {
+        std::cerr << "GL trace: frame " << frame << " has already been presented" << std::endl;
+        return false;
+    }
+    g_traceFile = std::fopen(path, "wb");
+    if (!g_traceFile)
+    {
+        std::cerr << "GL trace: cannot open " << path << std::endl;
+        return false;
+    }
+    TraceHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.callCount = static_cast<uint32_t>(kCallCount);
+    header.frame = frame;
+    std::fwrite(&header, sizeof(header), 1, g_traceFile);
+    g_traceFrame = frame;
+    g_traceStart = std::chrono::steady_clock::now();
+    g_record.reserve(64 * 1024);
+    g_tracing = true;
+    std::cout << "GL trace: recording to " << path << " through frame " << frame << std::endl;
+    return true;
+}
+
+void GlInterpose::endFrame()
+{
+    if (g_tracing)
+    {
+        g_record.assign(sizeof(RecordHeader), 0);
+        put(g_frame);
+        writeRecord(kFrameMarker, sinceTraceStart(), 0);
+        if (g_tracing && g_frame == g_traceFrame)
+        {
+            stopTrace();
+            std::cout << "GL trace: frame " << g_frame << " captured" << std::endl;
+        }
+    }
+    ++g_frame;
+}
+
+uint64_t GlInterpose::callCount()
+{
+    return g_calls;
+}
+
+bool GlInterpose::replay(const char* path, int repeats, ReplayResult& result, FILE* report)
+{
+    std::vector<unsigned char> trace;
+    if (!readTrace(path, trace))
+    {
+        std::cerr << "GL replay: cannot read " << path << std::endl;
+        return false;
+    }
+    TraceHeader header{};
+    if (trace.size() < sizeof(header)) return false;
+    std::memcpy(&header, trace.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.callCount != kCallCount)
+    {
+        std::cerr << "GL replay: " << path << " is not a trace of this build" << std::endl;
+        return false;
+    }
+
+    // offsets of every record, and which of them belong to the captured frame
+    std::vector<size_t> records;
+    size_t frameBegin = 0;
+    size_t frameEnd = 0;
+    bool frameFound = false;
+    for (size_t at = sizeof(header); at + sizeof(RecordHeader) <= trace.size();)
+    {
+        RecordHeader record;
+        std::memcpy(&record, trace.data() + at, sizeof(record));
+        if (record.size < sizeof(record) || at + record.size > trace.size()) break;
+        if (record.call == kFrameMarker)
+        {
+            uint64_t frame = 0;
+            std::memcpy(&frame, trace.data() + at + sizeof(record), sizeof(frame));
+            if (frame + 1 == header.frame) frameBegin = records.size();
+            if (frame == header.frame)
+            {
+                frameEnd = records.size();
+                frameFound = true;
+                break;
+            }
+        }
+        else if (record.call < kCallCount)
+        {
+            records.push_back(at);
+        }
+        at += record.size;
+    }
+    if (!frameFound)
+    {
+        std::cerr << "GL replay: trace ends before frame " << header.frame << std::endl;
+        return false;
+    }
+
+    Reader in;
+    auto execute = [&](size_t offset)
+    {
+        RecordHeader record;
+        std::memcpy(&record, trace.data() + offset, sizeof(record));
+        in.cursor = trace.data() + offset + sizeof(record);
+        kReplay[record.call](in);
+        return record;
+    };
+
+    for (size_t i = 0; i < frameBegin; ++i) execute(records[i]);
+    glFinish();
+
+    struct CallTotals
+    {
+        uint64_t calls = 0;
+        uint64_t capturedNs = 0;
+        uint64_t replayNs = 0;
+    };
+    std::vector<CallTotals> totals(kCallCount);
+    using Clock = std::chrono::steady_clock;
+    Clock::duration frameTime{};
+    repeats = std::max(repeats, 1);
+    for (int r = 0; r < repeats; ++r)
+    {
+        // names generated on repeats legitimately differ from the single captured run
+        in.checkNames = r == 0;
+        Clock::time_point frameStart = Clock::now();
+        for (size_t i = frameBegin; i < frameEnd; ++i)
+        {
+            Clock::time_point callStart = Clock::now();
+            RecordHeader record = execute(records[i]);
+            CallTotals& call = totals[record.call];
+            call.replayNs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - callStart).count());
+            if (r == 0)
+            {
+                ++call.calls;
+                call.capturedNs += record.durationNs;
+            }
+        }
+        frameTime += Clock::now() - frameStart;
+        // drain outside the timed region so repeats do not queue behind each other
+        glFinish();
+    }
+
+    result = ReplayResult{};
+    result.setupCalls = frameBegin;
+    result.frameCalls = frameEnd - frameBegin;
+    result.nameMismatches = in.mismatches;
+    for (const CallTotals& call : totals) result.capturedFrameMs += static_cast<double>(call.capturedNs) * 1e-6;
+    result.replayFrameMs = std::chrono::duration<double, std::milli>(frameTime).count() / repeats;
+
+    if (report)
+    {
+        std::vector<size_t> order;
+        for (size_t i = 0; i < kCallCount; ++i) if (totals[i].calls > 0) order.push_back(i);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return totals[a].replayNs > totals[b].replayNs; });
+        std::fprintf(report, "%-28s %8s %14s %14s\n", "call", "count", "captured us", "replay us");
+        for (size_t i : order)
+        {
+            const CallTotals& call = totals[i];
+            std::fprintf(report, "%-28s %8llu %14.1f %14.1f\n", kCallNames[i], static_cast<unsigned long long>(call.calls),
+                         static_cast<double>(call.capturedNs) * 1e-3, static_cast<double>(call.replayNs) * 1e-3 / repeats);
+        }
+    }
+    return true;
+}
+
+#else
+
+void GlInterpose::setBackend(Backend) {}
+GlInterpose::Backend GlInterpose::backend() { return Backend::Driver; }
+
+bool GlInterpose::captureFrame(const char*, uint64_t)
+{
+    std::cerr << "GL trace: rebuild with -DAC_GL_INTERPOSE=ON to record GL calls" << std::endl;
+    return false;
+}
+
+void GlInterpose::endFrame() {}
+uint64_t GlInterpose::callCount() { return 0; }
+
+bool GlInterpose::replay(const char*, int, ReplayResult&, FILE*)
+{
+    std::cerr << "GL replay: rebuild with -DAC_GL_INTERPOSE=ON" << std::endl;
+    return false;
+}
+
+#endif
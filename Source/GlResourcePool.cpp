@@ -0,0 +1,257 @@
+#include "../Header/GlResourcePool.h"
+
+#include "../Header/GlBindings.h"
+#include "../Header/MemoryLedger.h"
+
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr size_t kMinBufferClass = 12; // 4 KiB
+    constexpr size_t kBufferClasses = 20;  // up to 2 GiB
+    // idle memory beyond this is deleted instead of pooled
+    constexpr size_t kMaxIdleBytes = 64u * 1024u * 1024u;
+
+    struct TextureBucket
+    {
+        uint64_t key;
+        std::vector<GLuint> ids;
+    };
+
+    std::vector<TextureBucket> g_textures;
+    std::vector<GLuint> g_buffers[kBufferClasses];
+    GlPoolStats g_stats;
+    bool g_shutDown = false;
+
+    uint64_t textureKey(GLenum internalFormat, int width, int height)
+    {
+        return (static_cast<uint64_t>(internalFormat) << 48) | (static_cast<uint64_t>(width) << 24) | static_cast<uint64_t>(height);
+    }
+
+    size_t textureBytes(uint64_t key)
+    {
+        GLenum format = static_cast<GLenum>(key >> 48);
+        size_t width = static_cast<size_t>((key >> 24) & 0xFFFFFF);
+        size_t height = static_cast<size_t>(key & 0xFFFFFF);
+        return MemoryLedger::texelBytes(format) * width * height;
+    }
+
+    // Client format and type for specifying storage without data.
+    void uploadFormat(GLenum internalFormat, GLenum& format, GLenum& type)
+    {
+        type = GL_UNSIGNED_BYTE;
+        switch (internalFormat)
+        {
+        case GL_R8: format = GL_RED; break;
+        case GL_RG8: format = GL_RG; break;
+        case GL_RGB8: format = GL_RGB; break;
+        case GL_R32UI: format = GL_RED_INTEGER; type = GL_UNSIGNED_INT; break;
+        case GL_R32F: format = GL_RED; type = GL_FLOAT; break;
+        case GL_RGBA16F:
+        case GL_RGBA32F: format = GL_RGBA; type = GL_FLOAT; break;
+        default: format = GL_RGBA; break;
+        }
+    }
+
+    size_t bufferClass(size_t bytes)
+    {
+        size_t c = kMinBufferClass;
+        while ((size_t(1) << c) < bytes && c + 1 < kMinBufferClass + kBufferClasses) ++c;
+        return c - kMinBufferClass;
+    }
+
+    size_t classBytes(size_t sizeClass)
+    {
+        return size_t(1) << (sizeClass + kMinBufferClass);
+    }
+
+    // Called by the deletion queue once the GPU is done with a released object.
+    void retire(GlObjectType type, GLuint id, uint64_t key)
+    {
+        size_t bytes = type == GlObjectType::Texture ? textureBytes(key) : classBytes(static_cast<size_t>(key));
+        g_stats.coolingBytes -= bytes;
+        if (g_shutDown || g_stats.idleBytes + bytes > kMaxIdleBytes)
+        {
+            GlDeletionQueue::defer(type, id);
+            return;
+        }
+
+        g_stats.idleBytes += bytes;
+        MemoryLedger::trackGl(MemoryCategory::PoolIdle, type, id, bytes);
+        if (type == GlObjectType::Buffer)
+        {
+            g_buffers[key].push_back(id);
+            return;
+        }
+        for (TextureBucket& bucket : g_textures)
+        {
+            if (bucket.key == key)
+            {
+                bucket.ids.push_back(id);
+                return;
+            }
+        }
+        g_textures.push_back(TextureBucket{ key, { id } });
+    }
+}
+
+PooledTexture::PooledTexture(PooledTexture&& other) noexcept
+    : m_id(std::exchange(other.m_id, 0))
+    , m_internalFormat(other.m_internalFormat)
+    , m_width(other.m_width)
+    , m_height(other.m_height)
+{
+}
+
+PooledTexture& PooledTexture::operator=(PooledTexture&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        m_id = std::exchange(other.m_id, 0);
+        m_internalFormat = other.m_internalFormat;
+        m_width = other.m_width;
+        m_height = other.m_height;
+    }
+    return *this;
+}
+
+void PooledTexture::reset()
+{
+    if (m_id != 0) GlResourcePool::release(*this);
+    m_id = 0;
+}
+
+PooledBuffer::PooledBuffer(PooledBuffer&& other) noexcept
+    : m_id(std::exchange(other.m_id, 0))
+    , m_capacity(std::exchange(other.m_capacity, 0))
+{
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        m_id = std::exchange(other.m_id, 0);
+        m_capacity = std::exchange(other.m_capacity, 0);
+    }
+    return *this;
+}
+
+void PooledBuffer::reset()
+{
+    if (m_id != 0) GlResourcePool::release(*this);
+    m_id = 0;
+    m_capacity = 0;
+}
+
+PooledTexture GlResourcePool::acquireTexture(MemoryCategory category, GLenum internalFormat, int width, int height)
+{
+    uint64_t key = textureKey(internalFormat, width, height);
+    PooledTexture texture;
+    texture.m_internalFormat = internalFormat;
+    texture.m_width = width;
+    texture.m_height = height;
+    g_stats.liveBytes += textureBytes(key);
+
+    for (TextureBucket& bucket : g_textures)
+    {
+        if (bucket.key == key && !bucket.ids.empty())
+        {
+            texture.m_id = bucket.ids.back();
+            bucket.ids.pop_back();
+            g_stats.idleBytes -= textureBytes(key);
+            ++g_stats.hits;
+            MemoryLedger::trackGl(category, GlObjectType::Texture, texture.m_id, textureBytes(key));
+            return texture;
+        }
+    }
+
+    ++g_stats.misses;
+    GLenum format = GL_RGBA;
+    GLenum type = GL_UNSIGNED_BYTE;
+    uploadFormat(internalFormat, format, type);
+    glGenTextures(1, &texture.m_id);
+    GlBindings::bindTexture2D(texture.m_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internalFormat), width, height, 0, format, type, nullptr);
+    GlBindings::bindTexture2D(0);
+    MemoryLedger::trackGl(category, GlObjectType::Texture, texture.m_id, textureBytes(key));
+    return texture;
+}
+
+PooledBuffer GlResourcePool::acquireBuffer(MemoryCategory category, size_t bytes)
+{
+    size_t sizeClass = bufferClass(bytes);
+    PooledBuffer buffer;
+    buffer.m_capacity = classBytes(sizeClass);
+    g_stats.liveBytes += buffer.m_capacity;
+
+    std::vector<GLuint>& free = g_buffers[sizeClass];
+    if (!free.empty())
+    {
+        buffer.m_id = free.back();
+        free.pop_back();
+        g_stats.idleBytes -= buffer.m_capacity;
+        ++g_stats.hits;
+        MemoryLedger::trackGl(category, GlObjectType::Buffer, buffer.m_id, buffer.m_capacity);
+        return buffer;
+    }
+
+    ++g_stats.misses;
+    glGenBuffers(1, &buffer.m_id);
+    // the copy target leaves the caller's GL_ARRAY_BUFFER / element bindings alone
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.m_id);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(buffer.m_capacity), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    MemoryLedger::trackGl(category, GlObjectType::Buffer, buffer.m_id, buffer.m_capacity);
+    return buffer;
+}
+
+void GlResourcePool::release(PooledTexture& texture)
+{
+    uint64_t key = textureKey(texture.m_internalFormat, texture.m_width, texture.m_height);
+    size_t bytes = textureBytes(key);
+    g_stats.liveBytes -= bytes;
+    if (g_shutDown)
+    {
+        GlDeletionQueue::defer(GlObjectType::Texture, texture.m_id);
+        return;
+    }
+    g_stats.coolingBytes += bytes;
+    GlDeletionQueue::recycle(GlObjectType::Texture, texture.m_id, &retire, key);
+}
+
+void GlResourcePool::release(PooledBuffer& buffer)
+{
+    g_stats.liveBytes -= buffer.m_capacity;
+    if (g_shutDown)
+    {
+        GlDeletionQueue::defer(GlObjectType::Buffer, buffer.m_id);
+        return;
+    }
+    g_stats.coolingBytes += buffer.m_capacity;
+    GlDeletionQueue::recycle(GlObjectType::Buffer, buffer.m_id, &retire, bufferClass(buffer.m_capacity));
+}
+
+GlPoolStats GlResourcePool::stats()
+{
+    return g_stats;
+}
+
+void GlResourcePool::shutdown()
+{
+    g_shutDown = true;
+    for (TextureBucket& bucket : g_textures)
+    {
+        for (GLuint id : bucket.ids) GlDeletionQueue::defer(GlObjectType::Texture, id);
+    }
+    g_textures.clear();
+    for (std::vector<GLuint>& free : g_buffers)
+    {
+        for (GLuint id : free) GlDeletionQueue::defer(GlObjectType::Buffer, id);
+        free.clear();
+    }
+    g_stats.idleBytes = 0;
+}
@@ -0,0 +1,137 @@
+#include "../Header/GlyphCache.h"
+
+namespace
+{
+    constexpr size_t kInitialCapacity = 64; // must stay a power of two
+}
+
+GlyphCache::GlyphCache()
+{
+    m_table.resize(kInitialCapacity);
+}
+
+size_t GlyphCache::probeStart(uint32_t codepoint) const
+{
+    // Fibonacci hashing spreads neighbouring codepoints (same script block) across the table.
+    uint32_t h = codepoint * 2654435769u;
+    h ^= h >> 15;
+    return static_cast<size_t>(h) & (m_table.size() - 1);
+}
+
+Glyph* GlyphCache::find(uint32_t codepoint)
+{
+    return const_cast<Glyph*>(static_cast<const GlyphCache*>(this)->find(codepoint));
+}
+
+const Glyph* GlyphCache::find(uint32_t codepoint) const
+{
+    if (codepoint < kDirectCount)
+    {
+        return m_directUsed[codepoint] ? &m_direct[codepoint] : nullptr;
+    }
+
+    size_t mask = m_table.size() - 1;
+    for (size_t i = probeStart(codepoint);; i = (i + 1) & mask)
+    {
+        const Entry& e = m_table[i];
+        if (e.state == SlotState::Empty) return nullptr;
+        if (e.state == SlotState::Used && e.codepoint == codepoint) return &e.glyph;
+    }
+}
+
+Glyph* GlyphCache::insert(uint32_t codepoint, const Glyph& glyph)
+{
+    if (codepoint < kDirectCount)
+    {
+        if (!m_directUsed[codepoint]) ++m_count;
+        m_directUsed[codepoint] = true;
+        m_direct[codepoint] = glyph;
+        return &m_direct[codepoint];
+    }
+
+    if (Glyph* existing = find(codepoint))
+    {
+        *existing = glyph;
+        return existing;
+    }
+
+    // keep live entries plus tombstones under half the table so probe chains stay short
+    if ((m_tableUsed + m_tableDeleted + 1) * 2 > m_table.size())
+    {
+        size_t capacity = m_table.size();
+        while ((m_tableUsed + 1) * 4 > capacity) capacity *= 2;
+        rehash(capacity);
+    }
+
+    size_t mask = m_table.size() - 1;
+    for (size_t i = probeStart(codepoint);; i = (i + 1) & mask)
+    {
+        Entry& e = m_table[i];
+        if (e.state == SlotState::Used) continue;
+        if (e.state == SlotState::Deleted) --m_tableDeleted;
+        e.codepoint = codepoint;
+        e.state = SlotState::Used;
+        e.glyph = glyph;
+        ++m_tableUsed;
+        ++m_count;
+        return &e.glyph;
+    }
+}
+
+void GlyphCache::erase(uint32_t codepoint)
+{
+    if (codepoint < kDirectCount)
+    {
+        if (m_directUsed[codepoint]) --m_count;
+        m_directUsed[codepoint] = false;
+        m_direct[codepoint] = Glyph{};
+        return;
+    }
+
+    size_t mask = m_table.size() - 1;
+    for (size_t i = probeStart(codepoint);; i = (i + 1) & mask)
+    {
+        Entry& e = m_table[i];
+        if (e.state == SlotState::Empty) return;
+        if (e.state == SlotState::Used && e.codepoint == codepoint)
+        {
+            e.state = SlotState::Deleted;
+            --m_tableUsed;
+            ++m_tableDeleted;
+            --m_count;
+            return;
+        }
+    }
+}
+
+void GlyphCache::clear()
+{
+    m_directUsed.fill(false);
+    m_direct.fill(Glyph{});
+    m_table.assign(kInitialCapacity, Entry{});
+    m_count = 0;
+    m_tableUsed = 0;
+    m_tableDeleted = 0;
+}
+
+void GlyphCache::rehash(size_t capacity)
+{
+    std::vector<Entry> old;
+    old.swap(m_table);
+    m_table.assign(capacity, Entry{});
+    m_tableUsed = 0;
+    m_tableDeleted = 0;
+
+    size_t mask = capacity - 1;
+    for (const Entry& e : old)
+    {
+        if (e.state != SlotState::Used) continue;
+        for (size_t i = probeStart(e.codepoint);; i = (i + 1) & mask)
+        {
+            if (m_table[i].state != SlotState::Empty) continue;
+            m_table[i] = e;
+            ++m_tableUsed;
+            break;
+        }
+    }
+}
@@ -0,0 +1,224 @@
+#include "../Header/JobSystem.h"
+
+#include "../Header/SamplingProfiler.h"
+
+#include <chrono>
+
+namespace
+{
+    // Slot of the current thread; one JobSystem per process is expected, a thread that
+    // meets a different system is given a fresh slot there.
+    struct ThreadSlot
+    {
+        const JobSystem* owner = nullptr;
+        unsigned index = 0;
+    };
+    thread_local ThreadSlot t_slot;
+    thread_local uint32_t t_rng = 0;
+
+    uint32_t nextRandom(uint32_t& state)
+    {
+        // xorshift32; only spreads victims, quality does not matter
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+}
+
+bool JobSystem::Deque::push(Job* job)
+{
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    int64_t top = m_top.load(std::memory_order_acquire);
+    if (bottom - top >= kCapacity) return false;
+    m_jobs[bottom & (kCapacity - 1)].store(job, std::memory_order_relaxed);
+    // publishes the job to thieves
+    m_bottom.store(bottom + 1, std::memory_order_release);
+    return true;
+}
+
+JobSystem::Job* JobSystem::Deque::pop()
+{
+    // the reservation of the bottom slot must be ordered before reading top; sequentially
+    // consistent operations stand in for the paper's fence
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_seq_cst);
+
+    if (top > bottom)
+    {
+        // empty
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = m_jobs[bottom & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+        // last job: race the thieves for it
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) job = nullptr;
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+JobSystem::Job* JobSystem::Deque::steal()
+{
+    int64_t top = m_top.load(std::memory_order_seq_cst);
+    int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+    if (top >= bottom) return nullptr;
+
+    Job* job = m_jobs[top & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+    return job;
+}
+
+JobSystem::JobSystem(unsigned workerThreads)
+{
+    if (workerThreads == 0)
+    {
+        unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        workerThreads = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    unsigned slots = workerThreads + kMaxExternalThreads;
+    for (unsigned i = 0; i < slots; ++i)
+    {
+        m_slots.push_back(std::make_unique<Slot>());
+    }
+    for (unsigned i = 0; i < workerThreads; ++i)
+    {
+        m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    m_running.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) worker.join();
+
+    // run what is still queued so no counter is left waiting; jobs may queue more
+    bool ran = true;
+    while (ran)
+    {
+        ran = false;
+        for (auto& slot : m_slots)
+        {
+            while (Job* job = slot->deque.steal())
+            {
+                execute(job);
+                ran = true;
+            }
+        }
+    }
+}
+
+unsigned JobSystem::threadIndex()
+{
+    if (t_slot.owner != this)
+    {
+        unsigned external = m_nextExternal.fetch_add(1, std::memory_order_relaxed);
+        t_slot.owner = this;
+        t_slot.index = external < kMaxExternalThreads ? workerCount() + external : threadCount();
+    }
+    return t_slot.index;
+}
+
+JobSystem::Job* JobSystem::allocateJob()
+{
+    unsigned index = threadIndex();
+    if (index >= threadCount()) return nullptr;
+    Slot& slot = *m_slots[index];
+    Job* job = &slot.jobs[slot.nextJob];
+    // the ring wrapped onto a job that is still queued or running elsewhere
+    if (job->busy.load(std::memory_order_acquire)) return nullptr;
+    job->busy.store(true, std::memory_order_relaxed);
+    slot.nextJob = (slot.nextJob + 1) % Slot::kJobsPerSlot;
+    return job;
+}
+
+void JobSystem::submit(Job* job)
+{
+    if (job->counter) job->counter->m_value.fetch_add(1, std::memory_order_relaxed);
+    if (!m_slots[threadIndex()]->deque.push(job))
+    {
+        // deque full: doing the work now is the back-pressure
+        execute(job);
+        return;
+    }
+    if (m_sleeping.load(std::memory_order_relaxed) > 0) m_wake.notify_one();
+}
+
+void JobSystem::execute(Job* job)
+{
+    JobCounter* counter = job->counter;
+    job->invoke(*job);
+    // the entry may be reused from here on
+    job->busy.store(false, std::memory_order_release);
+    if (counter) counter->m_value.fetch_sub(1, std::memory_order_release);
+}
+
+JobSystem::Job* JobSystem::findJob(unsigned slot)
+{
+    if (slot < threadCount())
+    {
+        if (Job* job = m_slots[slot]->deque.pop()) return job;
+    }
+
+    // steal, starting from a random victim so thieves spread out
+    unsigned count = threadCount();
+    if (t_rng == 0) t_rng = 0x9E3779B9u * (slot + 1);
+    unsigned start = nextRandom(t_rng) % count;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        unsigned victim = (start + i) % count;
+        if (victim == slot) continue;
+        if (Job* job = m_slots[victim]->deque.steal()) return job;
+    }
+    return nullptr;
+}
+
+void JobSystem::wait(const JobCounter& counter)
+{
+    unsigned slot = threadIndex();
+    while (!counter.done())
+    {
+        if (Job* job = findJob(slot)) execute(job);
+        else std::this_thread::yield();
+    }
+}
+
+void JobSystem::workerLoop(unsigned slot)
+{
+    ProfiledThread profiled("worker");
+    t_slot.owner = this;
+    t_slot.index = slot;
+
+    int idleSpins = 0;
+    while (m_running.load(std::memory_order_acquire))
+    {
+        if (Job* job = findJob(slot))
+        {
+            execute(job);
+            idleSpins = 0;
+            continue;
+        }
+        if (++idleSpins < 64)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // nothing to steal for a while: sleep until a push wakes us; the timeout covers a
+        // wake-up that raced with going to sleep
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleeping.fetch_add(1, std::memory_order_relaxed);
+        m_wake.wait_for(lock, std::chrono::milliseconds(1));
+        m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        idleSpins = 0;
+    }
+}
@@ -7,6 +7,21 @@
 #include "../Header/TemperatureUI.h"
 #include "../Header/Controls.h"
 #include "../Header/TextRenderer.h"
+#include "../Header/UiLayout.h"
+#include "../Header/DisplayPanel.h"
+#include "../Header/GlBindings.h"
+#include "../Header/GlHandle.h"
+#include "../Header/GlInterpose.h"
+#include "../Header/GlResourcePool.h"
+#include "../Header/MemoryLedger.h"
+#include "../Header/AllocTracker.h"
+#include "../Header/PerfCounters.h"
+#include "../Header/SamplingProfiler.h"
+#include "../Header/StartupGraph.h"
+#include "../Header/Bvh.h"
+#include "../Header/JobSystem.h"
+#include "../Header/Simulation.h"
+#include "../Header/RenderThread.h"
 #include "Camera3D.h"
 #include "Renderer.h"
 
@@ -19,18 +34,24 @@
 #include <chrono>
 #include <string>
 #include <cstdio>
+#include <cstdlib>
+#include <memory>
 #include <thread>
-#include <random>
+#include <vector>
 
 // Entry point: fullscreen AC simulator with timed logic and on-screen UI.
 const double TARGET_FPS = 75.0;
 const double TARGET_FRAME_TIME = 1.0 / TARGET_FPS;
-
-// Pointers handed to the framebuffer-size callback so we can update renderers on resize.
+// Simulation steps per second, and how many may run in one frame before time is dropped.
+const double SIM_TICK_RATE = 120.0;
+const int SIM_MAX_STEPS_PER_FRAME = 8;
+// GL calls run on a dedicated thread one frame behind the frame being built; false runs them inline.
+const bool RENDER_THREADED = true;
+const int RENDER_FRAMES_IN_FLIGHT = 1;
+
+// Pointers handed to the framebuffer-size callback; renderers pick the new size up in the frame loop.
 struct ResizeContext
 {
-    Renderer2D* renderer = nullptr;
-    TextRenderer* textRenderer = nullptr;
     int* windowWidth = nullptr;
     int* windowHeight = nullptr;
     Camera3D* camera = nullptr;
@@ -38,6 +59,17 @@ struct ResizeContext
 
 int main()
 {
+    auto startupTime = std::chrono::steady_clock::now();
+    // AC_PROFILE=file samples every thread (AC_PROFILE_HZ times per CPU second) and writes folded stacks at exit
+    const char* profilePath = SamplingProfiler::kEnabled ? std::getenv("AC_PROFILE") : nullptr;
+    if (profilePath)
+    {
+        const char* hz = std::getenv("AC_PROFILE_HZ");
+        if (!SamplingProfiler::start(hz ? static_cast<unsigned>(std::atoi(hz)) : 499u)) profilePath = nullptr;
+    }
+    ProfiledThread profiledMain("main");
+    // every init step is timed from here; AC_STARTUP_TRACE=file writes them out at the first frame
+    StartupGraph startup(startupTime);
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -56,6 +88,29 @@ int main()
     glfwSwapInterval(0);
 
     if (glewInit() != GLEW_OK) return endProgram("GLEW nije uspeo da se inicijalizuje.");
+    startup.record("window + context", startupTime);
+    // AC_GL_TRACE=file records every GL call through frame AC_GL_TRACE_FRAME (default 120) for ac-gl-replay
+    if (const char* trace = std::getenv("AC_GL_TRACE"))
+    {
+        const char* frame = std::getenv("AC_GL_TRACE_FRAME");
+        GlInterpose::captureFrame(trace, frame ? std::strtoull(frame, nullptr, 10) : 120);
+    }
+
+    // Declared before every GL-owning object so it runs last: the objects' destructors queue
+    // their names, which are freed here while the context still exists.
+    struct ContextTeardown
+    {
+        GLFWwindow* window;
+        ~ContextTeardown()
+        {
+            GlResourcePool::shutdown();
+            GlDeletionQueue::shutdown();
+            // everything that owns GL objects or ledger charges is gone by now
+            MemoryLedger::reportLeaks(stderr);
+            glfwDestroyWindow(window);
+            glfwTerminate();
+        }
+    } contextTeardown{ window };
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -76,27 +131,120 @@ int main()
     if (depthTestEnabled) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
     if (cullEnabled) { glEnable(GL_CULL_FACE); glCullFace(GL_BACK); } else glDisable(GL_CULL_FACE);
 
-    // Shader program and basic geometry
-    Renderer2D renderer(fbWidth, fbHeight, "Shaders/basic.vert", "Shaders/basic.frag");
-    TextRenderer textRenderer(fbWidth, fbHeight);
-    GLuint overlayProgram = createShader("Shaders/overlay.vert", "Shaders/overlay.frag");
-    GLint overlayWindowSizeLoc = glGetUniformLocation(overlayProgram, "uWindowSize");
-    GLint overlayTintLoc = glGetUniformLocation(overlayProgram, "uTint");
-    GLint overlayTextureLoc = glGetUniformLocation(overlayProgram, "uTexture");
+    // Worker pool shared by asset loading, the simulation and per-frame tasks
+    JobSystem jobs;
 
-    // 3D renderer (shaders compiled and ready)
+    // Init tasks: file parsing and pixel generation run on the workers while this thread,
+    // which owns the context, compiles shaders, bakes the font and uploads what is ready.
+    std::unique_ptr<TextRenderer> textRendererPtr;
     Renderer renderer3D;
-    if (!renderer3D.init()) {
+    bool renderer3DReady = false;
+    std::vector<float> toiletVertices;
+    int toiletModelId = -1;
+    // triangle BVH of the toilet so it can be picked and occludes picks behind it
+    TriangleBvh toiletBvh;
+    std::vector<unsigned char> lampPixels;
+    // a simple circular white texture (alpha mask) for the lamp icon so it appears round in 3D
+    GlTexture lampCircleTex;
+    const int lampTexSize = 64;
+
+    const int parseToilet = startup.add("toilet.parse", StartupGraph::Where::Worker, [&]()
+    {
+        // try relative paths (when running from build dir the executable cwd is cmake-build-debug)
+        // prefer the higher-quality model if present
+        const char* paths[] = {
+            "Assets/models/10778_Toilet_V2.obj",
+            "Assets/models/toilet.obj",
+            "../Assets/models/10778_Toilet_V2.obj",
+            "../Assets/models/toilet.obj"
+        };
+        for (const char* path : paths)
+        {
+            if (Renderer::parseOBJModel(path, toiletVertices)) break;
+        }
+    });
+    const int lampPixelsTask = startup.add("lamp.pixels", StartupGraph::Where::Worker, [&]()
+    {
+        lampPixels.assign(lampTexSize * lampTexSize * 4, 0);
+        float cx = (lampTexSize - 1) * 0.5f;
+        float cy = (lampTexSize - 1) * 0.5f;
+        float r = (lampTexSize * 0.45f);
+        for (int y = 0; y < lampTexSize; ++y) {
+            for (int x = 0; x < lampTexSize; ++x) {
+                float dx = static_cast<float>(x) - cx;
+                float dy = static_cast<float>(y) - cy;
+                float d2 = dx*dx + dy*dy;
+                int idx = (y * lampTexSize + x) * 4;
+                if (d2 <= r*r) {
+                    lampPixels[idx + 0] = 255;
+                    lampPixels[idx + 1] = 255;
+                    lampPixels[idx + 2] = 255;
+                    lampPixels[idx + 3] = 255;
+                }
+            }
+        }
+    });
+    startup.add("toilet.bvh", StartupGraph::Where::Worker, [&]()
+    {
+        if (toiletVertices.empty()) return;
+        auto bvhStart = std::chrono::steady_clock::now();
+        std::vector<glm::vec3> positions;
+        positions.reserve(toiletVertices.size() / 8);
+        for (size_t i = 0; i + 2 < toiletVertices.size(); i += 8)
+        {
+            positions.emplace_back(toiletVertices[i], toiletVertices[i + 1], toiletVertices[i + 2]);
+        }
+        toiletBvh.build(positions, &jobs);
+        float bvhMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - bvhStart).count();
+        fprintf(stderr, "Built toilet BVH (%zu triangles) in %.1f ms\n", toiletBvh.triangleCount(), bvhMs);
+    }, { parseToilet });
+
+    // 3D renderer (shaders compiled and ready)
+    const int init3D = startup.add("Renderer::init", StartupGraph::Where::Context, [&]() { renderer3DReady = renderer3D.init(); });
+    startup.add("TextRenderer", StartupGraph::Where::Context, [&]() { textRendererPtr = std::make_unique<TextRenderer>(fbWidth, fbHeight, &jobs); });
+    startup.add("toilet.upload", StartupGraph::Where::Context, [&]()
+    {
+        if (renderer3DReady) toiletModelId = renderer3D.addModel(toiletVertices);
+        if (toiletModelId < 0) {
+            // print to stderr so IDE/build output shows whether the model was found/loaded
+            fprintf(stderr, "Warning: toilet.obj failed to load (path: Assets/models/toilet.obj)\n");
+        } else {
+            fprintf(stderr, "Loaded toilet.obj as model id %d\n", toiletModelId);
+        }
+    }, { init3D, parseToilet });
+    startup.add("lamp.upload", StartupGraph::Where::Context, [&]()
+    {
+        lampCircleTex = GlTexture::create();
+        GlBindings::bindTexture2D(lampCircleTex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, lampTexSize, lampTexSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, lampPixels.data());
+        MemoryLedger::trackGl(MemoryCategory::Textures, GlObjectType::Texture, lampCircleTex, lampPixels.size());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        GlBindings::bindTexture2D(0);
+    }, { lampPixelsTask });
+    // Create and set a simple remote-shaped cursor (hotspot at laser dot top-left); GLFW only
+    // allows this on the main thread.
+    startup.add("cursor", StartupGraph::Where::Context, [&]()
+    {
+        GLFWcursor* cursor = createProceduralRemoteCursor();
+
+        if (cursor != nullptr)
+        {
+            glfwSetCursor(window, cursor);
+        }
+    });
+    startup.run(jobs);
+    startup.writeReport(stderr);
+
+    if (!renderer3DReady) {
         return endProgram("Neuspeh pri inicijalizaciji 3D renderera.");
     }
-
-    // connect 2D renderer to 3D renderer so 2D calls produce 3D placeholders
-    renderer.set3DRenderer(&renderer3D);
+    TextRenderer& textRenderer = *textRendererPtr;
 
     ResizeContext resizeCtx;
     Camera3D camera(window, fbWidth, fbHeight);
-    resizeCtx.renderer = &renderer;
-    resizeCtx.textRenderer = &textRenderer;
     resizeCtx.windowWidth = &windowWidth;
     resizeCtx.windowHeight = &windowHeight;
     resizeCtx.camera = &camera;
@@ -105,32 +253,12 @@ int main()
     {
         auto* ctx = static_cast<ResizeContext*>(glfwGetWindowUserPointer(win));
         if (!ctx) return;
-        glViewport(0, 0, w, h);
+        // runs on the main thread, which does not own the GL context while the render thread is up
         if (ctx->windowWidth) *ctx->windowWidth = w;
         if (ctx->windowHeight) *ctx->windowHeight = h;
-        if (ctx->renderer) ctx->renderer->setWindowSize(static_cast<float>(w), static_cast<float>(h));
-        if (ctx->textRenderer) ctx->textRenderer->setWindowSize(static_cast<float>(w), static_cast<float>(h));
         if (ctx->camera) ctx->camera->setWindowSize(w, h);
     });
 
-    // load toilet model (optional)
-    int toiletModelId = -1;
-    {
-        // try relative paths (when running from build dir the executable cwd is cmake-build-debug)
-        // prefer the higher-quality model if present
-        toiletModelId = renderer3D.loadOBJModel("Assets/models/10778_Toilet_V2.obj");
-        if (toiletModelId < 0) toiletModelId = renderer3D.loadOBJModel("Assets/models/toilet.obj");
-        if (toiletModelId < 0) toiletModelId = renderer3D.loadOBJModel("../Assets/models/10778_Toilet_V2.obj");
-        if (toiletModelId < 0) toiletModelId = renderer3D.loadOBJModel("../Assets/models/toilet.obj");
-
-        if (toiletModelId < 0) {
-            // print to stderr so IDE/build output shows whether the model was found/loaded
-            fprintf(stderr, "Warning: toilet.obj failed to load (path: Assets/models/toilet.obj)\n");
-        } else {
-            fprintf(stderr, "Loaded toilet.obj as model id %d\n", toiletModelId);
-        }
-    }
-
     glfwSetCursorPosCallback(window, [](GLFWwindow* win, double x, double y)
     {
         auto* ctx = static_cast<ResizeContext*>(glfwGetWindowUserPointer(win));
@@ -204,100 +332,249 @@ int main()
     const float bowlX = (acWidth - bowlWidth) * 0.5f;
     const float bowlY = acY + acHeight + 120.0f;
     RectShape bowlOutline{ bowlX, bowlY, bowlWidth, bowlHeight, bowlColor };
-
-    GLuint nameplateTexture = 0;
-    int nameplateW = 0;
-    int nameplateH = 0;
-    textRenderer.createTextTexture("Vuk Vicentic, SV45/2022", nameplateText, nameplateBg, 10, 42, nameplateTexture, nameplateW, nameplateH);
-
-    GLuint overlayVao = 0;
-    GLuint overlayVbo = 0;
-    glGenVertexArrays(1, &overlayVao);
-    glGenBuffers(1, &overlayVbo);
-    glBindVertexArray(overlayVao);
-    glBindBuffer(GL_ARRAY_BUFFER, overlayVbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 24, nullptr, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glBindVertexArray(0);
-
-    // create a simple circular white texture (alpha mask) for the lamp icon so it appears round in 3D
-    GLuint lampCircleTex = 0;
+    const float bowlInnerW = bowlOutline.w - 2.0f * bowlThickness;
+
+    // the three screens are composited offscreen and drawn as one textured panel
+    DisplayPanel displayPanel(screens);
+    auto panelStart = std::chrono::steady_clock::now();
+    const bool panelReady = displayPanel.init();
+    startup.record("DisplayPanel::init", panelStart);
+    if (!panelReady)
     {
-        const int texSize = 64;
-        std::vector<unsigned char> pixels(texSize * texSize * 4, 0);
-        float cx = (texSize - 1) * 0.5f;
-        float cy = (texSize - 1) * 0.5f;
-        float r = (texSize * 0.45f);
-        for (int y = 0; y < texSize; ++y) {
-            for (int x = 0; x < texSize; ++x) {
-                float dx = static_cast<float>(x) - cx;
-                float dy = static_cast<float>(y) - cy;
-                float d2 = dx*dx + dy*dy;
-                int idx = (y * texSize + x) * 4;
-                if (d2 <= r*r) {
-                    pixels[idx + 0] = 255;
-                    pixels[idx + 1] = 255;
-                    pixels[idx + 2] = 255;
-                    pixels[idx + 3] = 255;
-                } else {
-                    pixels[idx + 0] = 0;
-                    pixels[idx + 1] = 0;
-                    pixels[idx + 2] = 0;
-                    pixels[idx + 3] = 0;
-                }
-            }
-        }
-        glGenTextures(1, &lampCircleTex);
-        glBindTexture(GL_TEXTURE_2D, lampCircleTex);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texSize, texSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        fprintf(stderr, "Display panel unavailable; screens will render blank.\n");
     }
-
-    // Create and set a simple remote-shaped cursor (hotspot at laser dot top-left).
-    auto setProceduralCursor = [&]()
+    displayPanel.setColors(screenOnColor, screenOffColor, digitColor);
+
+    // Retained layout: screen rects and world boxes are cached per element and only rebuilt
+    // on resize or when a rect changes (the vent while it animates).
+    UiLayout layout;
+    layout.setWindowSize(static_cast<float>(windowWidth), static_cast<float>(windowHeight));
+    layout.setRoot(UiNodeId::AcBody, acBody, glm::vec3(240.0f, 100.0f, 80.0f));
+    layout.addNode(UiNodeId::Vent, UiNodeId::AcBody, ventBar, UiPlacement::FrontFace, 40.0f + 4.0f, 6.0f);
+    layout.addNode(UiNodeId::Lamp, UiNodeId::AcBody, RectShape{ lamp.x - lamp.radius, lamp.y - lamp.radius, lamp.radius * 2.0f, lamp.radius * 2.0f, lamp.color },
+                   UiPlacement::FrontFace, 40.0f + 6.0f, 2.0f);
+    layout.setRound(UiNodeId::Lamp, true);
+    layout.addNode(UiNodeId::Panel, UiNodeId::AcBody, displayPanel.bounds(), UiPlacement::FrontFace, 40.0f + 4.0f, 4.0f);
+    // the arrow button is picked and drawn as two halves
+    float arrowHalfH = tempArrowButton.h * 0.5f;
+    layout.addNode(UiNodeId::ArrowUp, UiNodeId::AcBody, RectShape{ tempArrowButton.x, tempArrowButton.y, tempArrowButton.w, arrowHalfH, arrowBg },
+                   UiPlacement::FrontFace, 40.0f + 6.0f, 4.0f);
+    layout.addNode(UiNodeId::ArrowDown, UiNodeId::AcBody, RectShape{ tempArrowButton.x, tempArrowButton.y + arrowHalfH, tempArrowButton.w, arrowHalfH, arrowBg },
+                   UiPlacement::FrontFace, 40.0f + 6.0f, 4.0f);
+    // bowl sits 300 units under the AC and is modelled at half its 2D outline height
+    layout.addNode(UiNodeId::Bowl, UiNodeId::AcBody, bowlOutline, UiPlacement::Below, 300.0f, 80.0f);
+    layout.setHeightScale(UiNodeId::Bowl, 0.5f);
+    layout.update();
+
+    // Pick scene: every clickable or occluding object, nearest hit wins. Boxes mirror the layout
+    // nodes and are refit when those move; the toilet is placed once it is first drawn.
+    SceneBvh pickScene;
+    auto nodeBox = [&](UiNodeId id) { return pickScene.addBox(layout.node(id).worldCenter, layout.node(id).worldHalfExtents); };
+    const int pickAcBody = nodeBox(UiNodeId::AcBody);
+    const int pickLamp = nodeBox(UiNodeId::Lamp);
+    const int pickArrowUp = nodeBox(UiNodeId::ArrowUp);
+    const int pickArrowDown = nodeBox(UiNodeId::ArrowDown);
+    const int pickBowl = nodeBox(UiNodeId::Bowl);
+    const int pickToilet = pickScene.addMesh(&toiletBvh, glm::mat4(1.0f));
+    pickScene.setEnabled(pickToilet, false);
+    const std::array<std::pair<int, UiNodeId>, 5> pickNodes{ {
+        { pickAcBody, UiNodeId::AcBody },
+        { pickLamp, UiNodeId::Lamp },
+        { pickArrowUp, UiNodeId::ArrowUp },
+        { pickArrowDown, UiNodeId::ArrowDown },
+        { pickBowl, UiNodeId::Bowl }
+    } };
+
+    // HUD text is retained: each run is shaped once and only rebuilt when its string changes
+    TextRun nameplateRun;
+    nameplateRun.setText("Vuk Vicentic, SV45/2022");
+    nameplateRun.setScale(42.0f / 48.0f);
+    nameplateRun.setColor(nameplateText);
+    nameplateRun.setBackground(nameplateBg, 10.0f);
+
+    TextRun fpsRun;
+    fpsRun.setText("FPS --");
+    fpsRun.setScale(0.6f);
+    fpsRun.setColor(digitColor);
+
+    TextRun depthRun;
+    depthRun.setScale(0.6f);
+    depthRun.setColor(digitColor);
+    TextRun cullRun;
+    cullRun.setScale(0.6f);
+    cullRun.setColor(digitColor);
+
+    // render statistics (R): last frame's counters from all three renderers, below the indicators
+    std::array<TextRun, 2> statsRuns;
+    for (TextRun& run : statsRuns)
     {
-        GLFWcursor* cursor = createProceduralRemoteCursor();
+        run.setScale(0.45f);
+        run.setColor(digitColor);
+    }
+    bool showStats = false;
+    RenderStats lastFrameStats; // only touched on the render thread
 
-        if (cursor != nullptr)
-        {
-            glfwSetCursor(window, cursor);
-        }
-    };
+    // memory overlay (M): a totals line, then one line per ledger category
+    std::array<TextRun, kMemoryCategoryCount + 1> memoryRuns;
+    for (TextRun& run : memoryRuns)
+    {
+        run.setScale(0.45f);
+        run.setColor(digitColor);
+    }
+    bool showMemory = false;
 
-    setProceduralCursor();
+    // hardware counters (P): the frame loop's IPC and misses per frame, then one line per zone
+    std::array<TextRun, 5> perfRuns;
+    for (TextRun& run : perfRuns)
+    {
+        run.setScale(0.45f);
+        run.setColor(digitColor);
+    }
+    bool showPerf = false;
 
     bool prevCPressed = false;
     bool prevLPressed = false;
+    bool prevGPressed = false;
+    bool prevMPressed = false;
+    bool prevRPressed = false;
+    bool prevPPressed = false;
     bool prevToggleDepth = false;
     bool prevToggleCull = false;
 
-    AppState appState{};
+    AppState initialState{};
     // Start with AC off by default.
-    appState.isOn = false;
+    initialState.isOn = false;
+
+    // droplets collide with the floor bowl, whose world box never changes
+    layout.update();
+    SimWorld simWorld;
+    {
+        const UiNode& bowlNode = layout.node(UiNodeId::Bowl);
+        simWorld.bowlCenter = bowlNode.worldCenter;
+        simWorld.bowlInnerRadius = bowlInnerW * (240.0f / acBody.w) * 0.5f;
+        simWorld.bowlTopY = bowlNode.worldCenter.y + bowlNode.worldHalfExtents.y - bowlThickness * (100.0f / acBody.h);
+    }
 
-    // particle drops
-    struct Particle { glm::vec3 pos; glm::vec3 vel; float radius; bool alive; };
-    std::vector<Particle> droplets;
-    float spawnAccumulator = 0.0f;
-    std::mt19937 rng(12345);
-    std::uniform_real_distribution<float> randX(-20.0f, 20.0f);
-    std::uniform_real_distribution<float> randZ(-10.0f, 10.0f);
+    // AC state, droplets and animations run on the simulation thread; this thread only
+    // sends input and renders the newest snapshot
+    Simulation simulation(initialState, simWorld, SIM_TICK_RATE, SIM_MAX_STEPS_PER_FRAME, &jobs);
+    simulation.start();
+    bool prevMouseDown = false;
+    double mainBusySeconds = 0.0;
 
-    std::string frameStats = "FPS --";
     double logAccumulator = 0.0;
     int logFrames = 0;
+    uint64_t logAllocations = 0;
+    // AC_ALLOC_SAMPLE=N captures the stack of every Nth allocation, reported at exit
+    if (const char* sample = std::getenv("AC_ALLOC_SAMPLE")) AllocTracker::setSampling(static_cast<unsigned>(std::atoi(sample)));
+    // AC_PERF_TRACE=file counts from startup and writes the per-frame counters there at exit
+    const char* perfTracePath = std::getenv("AC_PERF_TRACE");
+    if (perfTracePath && !PerfCounters::enable()) fprintf(stderr, "Perf counters unavailable: %s\n", PerfCounters::unavailableReason());
+    PerfSample logPerf;
+    int logPerfFrames = 0;
+
+    // GPU pick results travel back from the GL thread
+    SpscQueue<unsigned int, 16> gpuPicks;
+    bool gpuPicking = renderer3D.idBufferEnabled();
+    int renderWidth = windowWidth;
+    int renderHeight = windowHeight;
+
+    // From here on the frame loop only records GL work; the render thread owns the context.
+    RenderThread renderThread(window, RENDER_THREADED, RENDER_FRAMES_IN_FLIGHT);
+    // text scratch buffers are only needed by commands, which run on the render thread
+    textRenderer.setFrameMemory(&renderThread.frameArena());
+    auto setObjectId = [&](unsigned int id)
+    {
+        renderThread.record([&renderer3D, id] { renderer3D.setObjectId(id); });
+    };
+    auto drawCube = [&](const glm::mat4& model, const glm::vec3& color)
+    {
+        renderThread.record([&renderer3D, model, color] { renderer3D.drawCube(model, color); });
+    };
+    auto drawTexturedCube = [&](const glm::mat4& model, GLuint texture, const glm::vec3& color, bool flipV)
+    {
+        renderThread.record([&renderer3D, model, texture, color, flipV] { renderer3D.drawTexturedCube(model, texture, color, flipV); });
+    };
+    auto drawParticle = [&](const glm::mat4& model, const glm::vec3& color, float alpha)
+    {
+        renderThread.record([&renderer3D, model, color, alpha] { renderer3D.drawParticle(model, color, alpha); });
+    };
+    auto drawModel = [&](int modelId, const glm::mat4& model, const glm::vec3& color)
+    {
+        renderThread.record([&renderer3D, modelId, model, color] { renderer3D.drawModel(modelId, model, color); });
+    };
+    auto drawHollowBoxAt = [&](const glm::vec3& center, float width, float height, float depth, float thickness, const glm::vec3& color)
+    {
+        renderThread.record([&renderer3D, center, width, height, depth, thickness, color] { renderer3D.drawHollowBoxAt(center, width, height, depth, thickness, color); });
+    };
+    auto drawHollowCylinderAt = [&](const glm::vec3& center, float radius, float height, float thickness, int segments, const glm::vec3& color)
+    {
+        renderThread.record([&renderer3D, center, radius, height, thickness, segments, color] { renderer3D.drawHollowCylinderAt(center, radius, height, thickness, segments, color); });
+    };
+    // formats the ledger on this thread; the runs are only touched by the render thread
+    auto refreshMemoryOverlay = [&]()
+    {
+        constexpr double kMiB = 1024.0 * 1024.0;
+        std::array<std::array<char, 64>, kMemoryCategoryCount + 1> lines;
+        std::snprintf(lines[0].data(), lines[0].size(), "GPU %.1f MiB  CPU %.1f MiB", MemoryLedger::gpuBytes() / kMiB,
+                      MemoryLedger::cpuBytes() / kMiB);
+        for (size_t i = 0; i < kMemoryCategoryCount; ++i)
+        {
+            MemoryCategory category = static_cast<MemoryCategory>(i);
+            MemoryCategoryTotals t = MemoryLedger::totals(category);
+            std::snprintf(lines[i + 1].data(), lines[i + 1].size(), "%s %s %.2f MiB (peak %.2f)", MemoryLedger::isGpu(category) ? "gpu" : "cpu",
+                          MemoryLedger::name(category), t.bytes / kMiB, t.peakBytes / kMiB);
+        }
+        renderThread.record([&memoryRuns, lines]
+        {
+            for (size_t i = 0; i < lines.size(); ++i) memoryRuns[i].setText(lines[i].data());
+        });
+    };
+    // zone lines show the change since the previous refresh, normalized by the frames in between
+    std::array<PerfZoneTotals, 4> perfZonesBefore{};
+    auto refreshPerfOverlay = [&](const PerfSample& frames, int frameCount)
+    {
+        std::array<std::array<char, 80>, 5> lines{};
+        const double n = frameCount > 0 ? static_cast<double>(frameCount) : 1.0;
+        auto format = [n](std::array<char, 80>& line, const char* label, const PerfSample& sample)
+        {
+            std::snprintf(line.data(), line.size(), "%s  IPC %.2f  LLC miss %.1fk  branch miss %.1fk /frame", label, sample.ipc(),
+                          sample[PerfCounter::CacheMisses] / n / 1000.0, sample[PerfCounter::BranchMisses] / n / 1000.0);
+        };
+        std::array<PerfZoneTotals, 4> zones{};
+        size_t zoneCount = std::min(PerfCounters::zones(zones.data(), zones.size()), zones.size());
+        if (!PerfCounters::enabled())
+        {
+            std::snprintf(lines[0].data(), lines[0].size(), "perf counters unavailable: %s", PerfCounters::unavailableReason());
+        }
+        else if (frameCount == 0)
+        {
+            std::snprintf(lines[0].data(), lines[0].size(), "perf counters: collecting...");
+        }
+        else
+        {
+            format(lines[0], "main.frame", frames);
+            for (size_t i = 0; i < zoneCount; ++i)
+            {
+                PerfSample delta = zones[i].sample;
+                if (perfZonesBefore[i].name) delta -= perfZonesBefore[i].sample;
+                format(lines[i + 1], zones[i].name, delta);
+            }
+        }
+        perfZonesBefore = zones;
+        renderThread.record([&perfRuns, lines]
+        {
+            for (size_t i = 0; i < lines.size(); ++i) perfRuns[i].setText(lines[i].data());
+        });
+    };
+    renderThread.start();
 
     auto lastTime = std::chrono::steady_clock::now(); // main clock source
+    bool firstTextFrameReported = false;
 
     while (!glfwWindowShouldClose(window))
     {
+        AllocZone frameZone("main.frame");
         auto frameStartTime = std::chrono::steady_clock::now();
         float deltaTime = std::chrono::duration_cast<std::chrono::duration<float>>(frameStartTime - lastTime).count(); // seconds since last frame
         lastTime = frameStartTime;
@@ -307,11 +584,26 @@ int main()
         {
             double avgDelta = logAccumulator / static_cast<double>(logFrames);
             double avgFps = avgDelta > 0.0 ? 1.0 / avgDelta : 0.0;
-            char buf[64];
-            std::snprintf(buf, sizeof(buf), "FPS %.1f", avgFps); // once per second
-            frameStats = buf;
+            // share of wall time each thread spent working, excluding the frame limiter's sleep
+            float mainUtilization = static_cast<float>(mainBusySeconds / logAccumulator);
+            char buf[80];
+            int len = std::snprintf(buf, sizeof(buf), "FPS %.1f  sim %.0f%%  main %.0f%%  gl %.0f%%", avgFps, simulation.utilization() * 100.0f,
+                                    mainUtilization * 100.0f, renderThread.utilization() * 100.0f); // once per second
+            if (AllocTracker::kEnabled && len > 0 && len < static_cast<int>(sizeof(buf)))
+            {
+                std::snprintf(buf + len, sizeof(buf) - len, "  alloc %.1f/f", static_cast<double>(logAllocations) / logFrames);
+            }
+            std::array<char, 80> text;
+            std::copy(std::begin(buf), std::end(buf), text.begin());
+            renderThread.record([&fpsRun, text] { fpsRun.setText(text.data()); });
+            if (showMemory) refreshMemoryOverlay();
+            if (showPerf) refreshPerfOverlay(logPerf, logPerfFrames);
+            logPerf = PerfSample{};
+            logPerfFrames = 0;
             logAccumulator = 0.0;
+            mainBusySeconds = 0.0;
             logFrames = 0;
+            logAllocations = 0;
         }
 
         double mouseX, mouseY;
@@ -331,88 +623,43 @@ int main()
         bool cTogglePressed = glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS;
         if (tPressed && !prevToggleDepth) {
             depthTestEnabled = !depthTestEnabled;
-            if (depthTestEnabled) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
             fprintf(stderr, "Depth test %s\n", depthTestEnabled ? "ENABLED" : "DISABLED");
         }
         if (cTogglePressed && !prevToggleCull) {
             cullEnabled = !cullEnabled;
-            if (cullEnabled) { glEnable(GL_CULL_FACE); glCullFace(GL_BACK); } else glDisable(GL_CULL_FACE);
             fprintf(stderr, "Backface culling %s\n", cullEnabled ? "ENABLED" : "DISABLED");
         }
         prevToggleDepth = tPressed;
         prevToggleCull = cTogglePressed;
 
-        bool clickStarted = mouseDown && !appState.prevMouseDown;
-
-        float sceneMinX = std::min({ acBody.x, tempArrowButton.x, bowlOutline.x });
-        float sceneMaxX = std::max({ acBody.x + acBody.w, tempArrowButton.x + tempArrowButton.w, bowlOutline.x + bowlOutline.w });
-        float sceneMinY = std::min({ acBody.y, tempArrowButton.y, bowlOutline.y });
-        float sceneMaxY = std::max({ acBody.y + acBody.h, tempArrowButton.y + tempArrowButton.h, bowlOutline.y + bowlOutline.h });
-        float sceneW = sceneMaxX - sceneMinX;
-        float sceneH = sceneMaxY - sceneMinY;
-        float offsetX = (static_cast<float>(windowWidth) - sceneW) * 0.5f - sceneMinX;
-        float offsetY = (static_cast<float>(windowHeight) - sceneH) * 0.5f - sceneMinY;
-
-        auto shiftRect = [&](const RectShape& r)
-        {
-            RectShape out = r;
-            out.x += offsetX;
-            out.y += offsetY;
-            return out;
-        };
-        auto shiftCircle = [&](const CircleShape& c)
-        {
-            CircleShape out = c;
-            out.x += offsetX;
-            out.y += offsetY;
-            return out;
-        };
-
-        RectShape acBodyDraw = shiftRect(acBody);
-        RectShape ventBarDraw = shiftRect(ventBar);
-        CircleShape lampDraw = shiftCircle(lamp);
+        bool clickStarted = mouseDown && !prevMouseDown;
+        prevMouseDown = mouseDown;
 
-        std::array<RectShape, 3> screensDraw = screens;
-        for (auto& s : screensDraw)
-        {
-            s = shiftRect(s);
-        }
-
-        RectShape tempArrowDraw = shiftRect(tempArrowButton);
-        RectShape bowlDraw = shiftRect(bowlOutline);
-        float bowlInnerX = bowlDraw.x + bowlThickness;
-        float bowlInnerY = bowlDraw.y + bowlThickness;
-        float bowlInnerW = bowlDraw.w - 2.0f * bowlThickness;
-        float bowlInnerH = bowlDraw.h - 2.0f * bowlThickness;
+        layout.setWindowSize(static_cast<float>(windowWidth), static_cast<float>(windowHeight));
+        layout.update();
 
         bool tempArrowClicked = false;
-        if (clickStarted && !appState.lockedByFullBowl)
+        if (clickStarted)
         {
-            if (pointInRect(mouseX, mouseY, tempArrowDraw))
+            SimEvent arrow;
+            arrow.type = SimEventType::ChangeDesiredTemp;
+            if (pointInRect(mouseX, mouseY, layout.node(UiNodeId::ArrowUp).screen)) arrow.tempSteps = 1;
+            else if (pointInRect(mouseX, mouseY, layout.node(UiNodeId::ArrowDown).screen)) arrow.tempSteps = -1;
+            if (arrow.tempSteps != 0)
             {
-                float midY = tempArrowDraw.y + tempArrowDraw.h * 0.5f;
-                if (mouseY < midY)
-                {
-                    appState.desiredTemp += appState.tempChangeStep;
-                }
-                else
-                {
-                    appState.desiredTemp -= appState.tempChangeStep;
-                }
+                simulation.push(arrow);
                 tempArrowClicked = true;
             }
 
-            if (tempArrowClicked)
+            if (layout.hitTest(UiNodeId::Lamp, mouseX, mouseY))
             {
-                if (appState.desiredTemp < -10.0f) appState.desiredTemp = -10.0f;
-                if (appState.desiredTemp > 40.0f) appState.desiredTemp = 40.0f;
+                SimEvent power;
+                power.type = SimEventType::TogglePower;
+                power.respectLock = true;
+                simulation.push(power);
             }
         }
 
-        handlePowerToggle(appState, mouseX, mouseY, mouseDown, lampDraw);
-        handleTemperatureInput(appState, upPressed, downPressed);
-        updateVent(appState, deltaTime);
-        updateTemperature(appState, deltaTime);
         // compute camera position and forward for gating SPACE interactions
         glm::vec3 camPos(0.0f), camForward(0.0f,0.0f,-1.0f);
         {
@@ -424,7 +671,36 @@ int main()
                 camForward = glm::normalize(glm::vec3(invView * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f)));
             }
         }
-        updateWater(appState, deltaTime, spacePressed, camPos, camForward);
+        {
+            SimEvent keys;
+            keys.type = SimEventType::Keys;
+            keys.upPressed = upPressed;
+            keys.downPressed = downPressed;
+            keys.spacePressed = spacePressed;
+            keys.camPos = camPos;
+            keys.camForward = camForward;
+            simulation.push(keys);
+        }
+
+        // newest simulation step; stays valid until the next latest() call
+        const SimSnapshot& snap = simulation.latest();
+        const AppState& appState = snap.state;
+        // how far the frame is between the last two simulation steps
+        const float simAlpha = snap.alpha(std::chrono::steady_clock::now());
+
+        glm::vec3 lampWorldPos = layout.node(UiNodeId::Lamp).worldCenter;
+        const UiNode& bowlNode = layout.node(UiNodeId::Bowl);
+        glm::vec3 bowlWorldPos = bowlNode.worldCenter;
+        float bowlHWorld = bowlNode.worldHalfExtents.y * 2.0f;
+
+        // the vent is the only element whose rect animates; it rebuilds just that node
+        {
+            RectShape vent = ventBar;
+            float openness = snap.prevVentOpenness + (appState.ventOpenness - snap.prevVentOpenness) * simAlpha;
+            vent.h = ventClosedHeight + (ventOpenHeight - ventClosedHeight) * openness;
+            layout.setLocalRect(UiNodeId::Vent, vent);
+            layout.update();
+        }
 
         // hide the OS cursor when the bowl is held so only the remote model is visible
         if (appState.holdingBowl) {
@@ -436,278 +712,176 @@ int main()
         // Update camera each frame
         glm::mat4 currentView = glm::mat4(1.0f);
         glm::mat4 currentProj = glm::mat4(1.0f);
-        glm::vec3 lampWorldPos(0.0f);
-        glm::vec3 bowlWorldPos(0.0f);
-        float bowlWWorld = 0.0f, bowlHWorld = 0.0f, bowlDepth = 80.0f;
         {
             auto* ctx = static_cast<ResizeContext*>(glfwGetWindowUserPointer(window));
             if (ctx && ctx->camera) {
                 ctx->camera->update(deltaTime);
-                // compute lamp world position (mapToAC equivalent) so renderer can set lamp light uniform
-                float acCenterX = acBodyDraw.x + acBodyDraw.w * 0.5f;
-                float acCenterY = acBodyDraw.y + acBodyDraw.h * 0.5f;
-                float lampLocalX = (lampDraw.x - acCenterX) * (240.0f / acBody.w);
-                float lampLocalY = (acCenterY - lampDraw.y) * (100.0f / acBody.h);
-                float lampLocalZ = 40.0f + 6.0f;
-                lampWorldPos = glm::vec3(lampLocalX, lampLocalY, lampLocalZ);
                 currentView = ctx->camera->getViewMatrix();
                 currentProj = ctx->camera->getProjectionMatrix();
 
                 // tell renderer about lamp light (red when on)
                 glm::vec3 lampColorVec = appState.isOn ? glm::vec3(0.93f, 0.22f, 0.20f) : glm::vec3(0.12f, 0.12f, 0.12f);
                 float lampIntensity = appState.isOn ? 3.0f : 0.0f;
-                renderer3D.setLampLight(lampWorldPos, lampColorVec, lampIntensity, appState.isOn);
-
-                // ensure scene light stays on regardless of AC state
-                renderer3D.setSceneLight(glm::vec3(-350.0f, 260.0f, 40.0f), glm::vec3(1.0f, 0.95f, 0.2f), 2.5f);
-
-                // upload camera matrices to 3D renderer
-                renderer3D.setViewProjection(currentView, currentProj);
+                bool lampEnabled = appState.isOn;
+                renderThread.record([&renderer3D, lampWorldPos, lampColorVec, lampIntensity, lampEnabled, currentView, currentProj]
+                {
+                    renderer3D.setLampLight(lampWorldPos, lampColorVec, lampIntensity, lampEnabled);
+                    // ensure scene light stays on regardless of AC state
+                    renderer3D.setSceneLight(glm::vec3(-350.0f, 260.0f, 40.0f), glm::vec3(1.0f, 0.95f, 0.2f), 2.5f);
+                    // upload camera matrices to 3D renderer
+                    renderer3D.setViewProjection(currentView, currentProj);
+                });
             }
         }
 
-        lampDraw.color = appState.isOn ? lampOnColor : lampOffColor;
+        layout.setColor(UiNodeId::Lamp, appState.isOn ? lampOnColor : lampOffColor);
 
         // allow keyboard toggle for lamp (L key)
         bool lPressed = glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS;
         if (lPressed && !prevLPressed) {
-            appState.isOn = !appState.isOn;
-            glm::vec3 lampColorVec = appState.isOn ? glm::vec3(0.93f, 0.22f, 0.20f) : glm::vec3(0.12f, 0.12f, 0.12f);
-            float lampIntensity = appState.isOn ? 3.0f : 0.0f;
-            renderer3D.setLampLight(lampWorldPos, lampColorVec, lampIntensity, appState.isOn);
+            SimEvent power;
+            power.type = SimEventType::TogglePower;
+            simulation.push(power);
         }
         prevLPressed = lPressed;
 
-        // prepare bowl world position and extents (used for picking and drawing)
-        {
-            float wworld = bowlDraw.w * (240.0f / acBody.w);
-            float hworld = bowlDraw.h * (100.0f / acBody.h);
-            float bowlFullHeight = hworld * 0.5f;
-            float acHalfHeight = 100.0f * 0.5f;
-            float gap = 300.0f;
-            bowlWorldPos = glm::vec3(0.0f, -acHalfHeight - (bowlFullHeight * 0.5f) - gap, 0.0f);
-            bowlWWorld = wworld;
-            bowlHWorld = bowlFullHeight;
+        // G switches clicks between the CPU BVH and the GPU ID buffer
+        bool gPressed = glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS;
+        if (gPressed && !prevGPressed) {
+            gpuPicking = !gpuPicking;
+            renderThread.record([&renderer3D, gpuPicking] { renderer3D.setIdBufferEnabled(gpuPicking); });
+            fprintf(stderr, "Picking: %s\n", gpuPicking ? "GPU ID buffer" : "CPU BVH");
         }
+        prevGPressed = gPressed;
 
-        // perform raycast picking on click start
+        // M shows per-category GPU and host memory from the ledger
+        bool mPressed = glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS;
+        if (mPressed && !prevMPressed) {
+            showMemory = !showMemory;
+            if (showMemory) refreshMemoryOverlay();
+        }
+        prevMPressed = mPressed;
+
+        bool rPressed = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+        if (rPressed && !prevRPressed) showStats = !showStats;
+        prevRPressed = rPressed;
+
+        // P shows hardware counters, which are opened on first use
+        bool pPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (pPressed && !prevPPressed) {
+            showPerf = !showPerf;
+            if (showPerf) {
+                PerfCounters::enable();
+                logPerf = PerfSample{};
+                logPerfFrames = 0;
+                refreshPerfOverlay(logPerf, 0);
+            }
+        }
+        prevPPressed = pPressed;
+
+        // resolve clicks to a pick id; the GPU path answers a click from an earlier frame
+        int pickedObject = -1;
+        unsigned int gpuPickId = 0;
+        if (gpuPicks.pop(gpuPickId)) pickedObject = static_cast<int>(gpuPickId) - 1;
+        renderThread.record([&renderer3D, &gpuPicks]
+        {
+            unsigned int id = 0;
+            if (renderer3D.pollPick(id)) gpuPicks.push(id);
+        });
         if (clickStarted)
         {
-            // build inverse PV matrix
-            glm::mat4 invPV = glm::inverse(currentProj * currentView);
-            // normalized device coords
-            float ndcX = (static_cast<float>(mouseX) / static_cast<float>(windowWidth)) * 2.0f - 1.0f;
-            float ndcY = 1.0f - (static_cast<float>(mouseY) / static_cast<float>(windowHeight)) * 2.0f;
-            glm::vec4 nearPointNDC(ndcX, ndcY, -1.0f, 1.0f);
-            glm::vec4 farPointNDC(ndcX, ndcY, 1.0f, 1.0f);
-            glm::vec4 worldNear4 = invPV * nearPointNDC; worldNear4 /= worldNear4.w;
-            glm::vec4 worldFar4 = invPV * farPointNDC; worldFar4 /= worldFar4.w;
-            glm::vec3 rayOrigin = glm::vec3(worldNear4);
-            glm::vec3 rayDir = glm::normalize(glm::vec3(worldFar4) - rayOrigin);
-
-            // test lamp (sphere) intersection
-            float lampRadius = (lampDraw.radius * 2.0f * (240.0f / acBody.w)) * 0.5f;
-            glm::vec3 L = rayOrigin - lampWorldPos;
-            float a = glm::dot(rayDir, rayDir);
-            float b = 2.0f * glm::dot(rayDir, L);
-            float c = glm::dot(L, L) - lampRadius * lampRadius;
-            float disc = b*b - 4*a*c;
-            if (disc >= 0.0f) {
-                float t = (-b - sqrt(disc)) / (2.0f * a);
-                if (t > 0.0f) {
-                    // hit lamp: toggle power
-                    appState.isOn = !appState.isOn;
-                    // update lamp uniforms immediately
-                    glm::vec3 lampColorVec = appState.isOn ? glm::vec3(0.93f, 0.22f, 0.20f) : glm::vec3(0.12f);
-                    float lampIntensity = appState.isOn ? 3.0f : 0.0f;
-                    renderer3D.setLampLight(lampWorldPos, lampColorVec, lampIntensity, appState.isOn);
+            if (gpuPicking) {
+                int pickX = static_cast<int>(mouseX);
+                int pickY = static_cast<int>(mouseY);
+                renderThread.record([&renderer3D, pickX, pickY] { renderer3D.requestPick(pickX, pickY); });
+            } else {
+                // build inverse PV matrix
+                glm::mat4 invPV = glm::inverse(currentProj * currentView);
+                // normalized device coords
+                float ndcX = (static_cast<float>(mouseX) / static_cast<float>(windowWidth)) * 2.0f - 1.0f;
+                float ndcY = 1.0f - (static_cast<float>(mouseY) / static_cast<float>(windowHeight)) * 2.0f;
+                glm::vec4 nearPointNDC(ndcX, ndcY, -1.0f, 1.0f);
+                glm::vec4 farPointNDC(ndcX, ndcY, 1.0f, 1.0f);
+                glm::vec4 worldNear4 = invPV * nearPointNDC; worldNear4 /= worldNear4.w;
+                glm::vec4 worldFar4 = invPV * farPointNDC; worldFar4 /= worldFar4.w;
+                glm::vec3 rayOrigin = glm::vec3(worldNear4);
+                glm::vec3 rayDir = glm::normalize(glm::vec3(worldFar4) - rayOrigin);
+
+                PerfZone pickZone("main.pick");
+                for (const auto& pick : pickNodes) {
+                    pickScene.setBox(pick.first, layout.node(pick.second).worldCenter, layout.node(pick.second).worldHalfExtents);
                 }
+                pickScene.update();
+                pickedObject = pickScene.intersect(rayOrigin, rayDir).objectId;
             }
+        }
 
-            auto hitAABB = [&](const glm::vec3& center, const glm::vec3& halfExtents) -> bool
-            {
-                glm::vec3 minB = center - halfExtents;
-                glm::vec3 maxB = center + halfExtents;
-                float tmin = 0.0f; float tmax = 1e9f;
-                for (int i = 0; i < 3; ++i) {
-                    float invD = 1.0f / ((&rayDir.x)[i]);
-                    float t0 = ((&minB.x)[i] - (&rayOrigin.x)[i]) * invD;
-                    float t1 = ((&maxB.x)[i] - (&rayOrigin.x)[i]) * invD;
-                    if (invD < 0.0f) std::swap(t0, t1);
-                    tmin = std::max(tmin, t0);
-                    tmax = std::min(tmax, t1);
-                    if (tmax <= tmin) break;
-                }
-                return (tmax > tmin && tmax > 0.0f);
-            };
-
-            // test arrow buttons (AABB) in 3D so clicks work with camera movement
-            if (!tempArrowClicked && !appState.lockedByFullBowl) {
-                float acCenterX = acBodyDraw.x + acBodyDraw.w * 0.5f;
-                float acCenterY = acBodyDraw.y + acBodyDraw.h * 0.5f;
-                auto mapToACPick = [&](float px, float py, float z)->glm::vec3 {
-                    float localX = (px - acCenterX) * (240.0f / acBody.w);
-                    float localY = (acCenterY - py) * (100.0f / acBody.h);
-                    return glm::vec3(localX, localY, z);
-                };
-
-                float scaleX = 240.0f / acBody.w;
-                float scaleY = 100.0f / acBody.h;
-                float halfH = tempArrowDraw.h * 0.5f;
-                float wworld = tempArrowDraw.w * scaleX;
-                float hworld = halfH * scaleY;
-                float zFront = 40.0f + 6.0f;
-
-                float cx = tempArrowDraw.x + tempArrowDraw.w * 0.5f;
-                float cyTop = tempArrowDraw.y + halfH * 0.5f;
-                float cyBot = tempArrowDraw.y + halfH + halfH * 0.5f;
-                glm::vec3 halfExtents(wworld * 0.5f, hworld * 0.5f, 2.0f);
-
-                glm::vec3 topPos = mapToACPick(cx, cyTop, zFront);
-                glm::vec3 botPos = mapToACPick(cx, cyBot, zFront);
-                if (hitAABB(topPos, halfExtents)) {
-                    appState.desiredTemp += appState.tempChangeStep;
-                    tempArrowClicked = true;
-                } else if (hitAABB(botPos, halfExtents)) {
-                    appState.desiredTemp -= appState.tempChangeStep;
-                    tempArrowClicked = true;
-                }
-
-                if (tempArrowClicked) {
-                    if (appState.desiredTemp < -10.0f) appState.desiredTemp = -10.0f;
-                    if (appState.desiredTemp > 40.0f) appState.desiredTemp = 40.0f;
-                }
+        // picked objects become simulation events; the lock and bowl rules are applied there
+        if (pickedObject >= 0)
+        {
+            SimEvent picked;
+            if (pickedObject == pickLamp) {
+                picked.type = SimEventType::TogglePower;
+                simulation.push(picked);
             }
 
-            // test bowl (AABB) intersection
-            glm::vec3 boxMin = bowlWorldPos - glm::vec3(bowlWWorld*0.5f, bowlHWorld*0.5f, bowlDepth*0.5f);
-            glm::vec3 boxMax = bowlWorldPos + glm::vec3(bowlWWorld*0.5f, bowlHWorld*0.5f, bowlDepth*0.5f);
-            float tmin = 0.0f; float tmax = 1e9f;
-            for (int i = 0; i < 3; ++i) {
-                float invD = 1.0f / ((&rayDir.x)[i]);
-                float t0 = ((&boxMin.x)[i] - (&rayOrigin.x)[i]) * invD;
-                float t1 = ((&boxMax.x)[i] - (&rayOrigin.x)[i]) * invD;
-                if (invD < 0.0f) std::swap(t0, t1);
-                tmin = std::max(tmin, t0);
-                tmax = std::min(tmax, t1);
-                if (tmax <= tmin) break;
+            // arrow buttons in 3D so clicks work with camera movement
+            if (!tempArrowClicked && (pickedObject == pickArrowUp || pickedObject == pickArrowDown)) {
+                picked.type = SimEventType::ChangeDesiredTemp;
+                picked.tempSteps = pickedObject == pickArrowUp ? 1 : -1;
+                simulation.push(picked);
+                tempArrowClicked = true;
             }
-            if (tmax > tmin && tmax > 0.0f) {
-                // hit the bowl: if full and AC is off, pick it up
-                if (appState.waterLevel >= 0.99f && !appState.isOn) {
-                    appState.holdingBowl = !appState.holdingBowl;
-                }
+
+            // bowl: if full and AC is off, pick it up
+            if (pickedObject == pickBowl) {
+                picked.type = SimEventType::ToggleBowl;
+                simulation.push(picked);
             }
         }
-        float ventHeight = ventClosedHeight + (ventOpenHeight - ventClosedHeight) * appState.ventOpenness;
-        ventBarDraw.h = ventHeight;
-
-        Color screenColor = appState.isOn ? screenOnColor : screenOffColor;
+        // redraws the panel texture only when a readout, the power state or the status icon changed
+        renderThread.record([&displayPanel, &textRenderer, panelState = appState] { displayPanel.update(panelState, textRenderer); });
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // 3D pass: draw AC unit cube and lid
-        if (depthTestEnabled) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-        if (cullEnabled) { glEnable(GL_CULL_FACE); glCullFace(GL_BACK); } else glDisable(GL_CULL_FACE);
+        if (windowWidth != renderWidth || windowHeight != renderHeight) {
+            renderWidth = windowWidth;
+            renderHeight = windowHeight;
+            renderThread.record([&textRenderer, renderWidth, renderHeight]
+            {
+                glViewport(0, 0, renderWidth, renderHeight);
+                textRenderer.setWindowSize(static_cast<float>(renderWidth), static_cast<float>(renderHeight));
+            });
+        }
 
-        // update particles (physics + spawning)
+        renderThread.record([&renderer3D, renderWidth, renderHeight, depthTestEnabled, cullEnabled]
         {
-            // spawn rate per second (drops) proportional to vent openness (reduced)
-            float spawnRate = 6.0f * appState.ventOpenness; // drops/sec (was 12)
-            if (appState.isOn && spawnRate > 0.0f) {
-                spawnAccumulator += spawnRate * deltaTime;
-                while (spawnAccumulator >= 1.0f) {
-                    spawnAccumulator -= 1.0f;
-                    Particle p;
-                    // spawn under AC bottom center (local coords)
-                    float spawnY = -50.0f - 5.0f;
-                    p.pos = glm::vec3(randX(rng), spawnY, randZ(rng));
-                    // slower initial downward velocity to avoid tunneling
-                    p.vel = glm::vec3(0.0f, -60.0f - std::abs(randZ(rng))*1.0f, 0.0f);
-                    p.radius = 4.0f;
-                    p.alive = true;
-                    droplets.push_back(p);
-                }
-            }
-
-            // physics integration (reduced gravity)
-            glm::vec3 gravity(0.0f, -400.0f, 0.0f); // was -980
-            for (auto &d : droplets) {
-                if (!d.alive) continue;
-                d.vel += gravity * deltaTime;
-                d.pos += d.vel * deltaTime;
-
-                // collision check with bowl inner top
-                // bowlWorldPos and bowl extents computed earlier
-                float innerWWorld = (bowlInnerW * (240.0f / acBody.w));
-                float innerRadius = innerWWorld * 0.5f;
-                float bowlTopY = bowlWorldPos.y + (bowlHWorld * 0.5f) - (bowlThickness * (100.0f / acBody.h));
-
-                // allow small tolerance to avoid tunneling and accept near-misses
-                float verticalTolerance = 4.0f;
-                float rimTolerance = 2.0f;
-
-                if (d.pos.y - d.radius <= bowlTopY + verticalTolerance) {
-                    // compute horizontal distance to bowl center
-                    float dx = d.pos.x - bowlWorldPos.x;
-                    float dz = d.pos.z - bowlWorldPos.z;
-                    float distXZ = std::sqrt(dx*dx + dz*dz);
-
-                    if (distXZ <= innerRadius - 1.0f) {
-                        // clearly inside
-                        d.alive = false;
-                        appState.waterLevel += 0.0015f; // each drop adds less
-                        if (appState.waterLevel >= 1.0f) {
-                            appState.waterLevel = 1.0f;
-                            appState.isOn = false;
-                            appState.lockedByFullBowl = true;
-                        }
-                    } else if (d.pos.y <= bowlTopY - verticalTolerance && distXZ <= innerRadius + rimTolerance) {
-                        // tunneled through but horizontally near center -> collect
-                        d.alive = false;
-                        appState.waterLevel += 0.0015f;
-                        if (appState.waterLevel >= 1.0f) {
-                            appState.waterLevel = 1.0f;
-                            appState.isOn = false;
-                            appState.lockedByFullBowl = true;
-                        }
-                    } else if (distXZ <= innerRadius + rimTolerance) {
-                        // considered hitting rim: bounce outward slightly
-                        if (distXZ < 0.001f) distXZ = 0.001f;
-                        d.vel.x += (dx / distXZ) * 50.0f;
-                        d.vel.z += (dz / distXZ) * 50.0f;
-                        // and move above rim
-                        d.pos.y = bowlTopY + d.radius + 1.0f;
-                    }
-                }
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            // 3D draws go to the scene target (color + object ids) until endScene() when the ID buffer is on
+            renderer3D.beginScene(renderWidth, renderHeight);
 
-                // kill if too low
-                if (d.pos.y < bowlWorldPos.y - 1000.0f) d.alive = false;
-            }
+            // 3D pass: draw AC unit cube and lid
+            if (depthTestEnabled) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+            if (cullEnabled) { glEnable(GL_CULL_FACE); glCullFace(GL_BACK); } else glDisable(GL_CULL_FACE);
+        });
 
-            // remove dead
-            droplets.erase(std::remove_if(droplets.begin(), droplets.end(), [](const Particle&p){return !p.alive;}), droplets.end());
-        }
         // compute base and lid model matrices
-        static float lidAngle = 0.0f;
-        const float targetAngle = appState.isOn ? 60.0f : 0.0f;
-        const float angSpeed = 90.0f; // degrees per second
-        if (lidAngle < targetAngle) lidAngle += angSpeed * deltaTime; if (lidAngle > targetAngle) lidAngle = targetAngle;
-        if (lidAngle > targetAngle) lidAngle -= angSpeed * deltaTime; if (lidAngle < targetAngle) lidAngle = targetAngle;
 
         // place cube at world origin, scale to acWidth x acHeight x depth
         glm::mat4 modelBase = glm::mat4(1.0f);
         modelBase = glm::translate(modelBase, glm::vec3(0.0f, 0.0f, 0.0f));
         modelBase = glm::scale(modelBase, glm::vec3(240.0f, 100.0f, 80.0f));
-        renderer3D.drawCube(modelBase, glm::vec3(0.9f, 0.93f, 0.95f));
+        // ID buffer values are pick ids + 1 so that 0 means background
+        setObjectId(static_cast<unsigned int>(pickAcBody + 1));
+        drawCube(modelBase, glm::vec3(0.9f, 0.93f, 0.95f));
+        setObjectId(0);
 
         // draw droplets
-        for (const auto &d : droplets) {
+        for (int i = 0; i < snap.dropletCount; ++i) {
+            const DropletState& d = snap.droplets[i];
             glm::mat4 m = glm::mat4(1.0f);
-            m = glm::translate(m, d.pos);
+            m = glm::translate(m, glm::mix(d.prevPos, d.pos, simAlpha));
             float s = d.radius;
             m = glm::scale(m, glm::vec3(s, s, s));
-            renderer3D.drawParticle(m, glm::vec3(0.5f, 0.8f, 1.0f), 0.6f);
+            drawParticle(m, glm::vec3(0.5f, 0.8f, 1.0f), 0.6f);
         }
 
         // lid: pivot at top-back edge of cube; build transform: translate to hinge, rotate, translate back
@@ -715,130 +889,68 @@ int main()
         // hinge location in model-space: top (y +0.5) and back (z -0.5) -> with scaling accounted later
         // We'll construct in unscaled cube space then scale
         modelLid = glm::translate(modelLid, glm::vec3(0.0f, 0.5f, -0.5f));
-        modelLid = glm::rotate(modelLid, glm::radians(-lidAngle), glm::vec3(1.0f, 0.0f, 0.0f));
+        float renderLidAngle = snap.prevLidAngle + (snap.lidAngle - snap.prevLidAngle) * simAlpha;
+        modelLid = glm::rotate(modelLid, glm::radians(-renderLidAngle), glm::vec3(1.0f, 0.0f, 0.0f));
         modelLid = glm::translate(modelLid, glm::vec3(0.0f, -0.5f, 0.5f));
         modelLid = glm::scale(modelLid, glm::vec3(240.0f, 20.0f, 80.0f));
-        renderer3D.drawCube(modelLid, glm::vec3(0.78f, 0.82f, 0.88f));
+        setObjectId(static_cast<unsigned int>(pickAcBody + 1));
+        drawCube(modelLid, glm::vec3(0.78f, 0.82f, 0.88f));
+        setObjectId(0);
 
         // Draw UI elements as 3D primitives aligned to the AC model coordinate frame
         // keep depth test enabled while drawing 3D UI
 
-        // helper: map pixel center to AC-local world coords (AC centered at origin, scaled to 240x100x80)
-        auto mapToAC = [&](float px, float py, float zOffsetFront)->glm::vec3 {
-            float acCenterX = acBodyDraw.x + acBodyDraw.w * 0.5f;
-            float acCenterY = acBodyDraw.y + acBodyDraw.h * 0.5f;
-            float localX = (px - acCenterX) * (240.0f / acBody.w);
-            float localY = (acCenterY - py) * (100.0f / acBody.h);
-            float z = zOffsetFront; // caller decides front/back
-            return glm::vec3(localX, localY, z);
-        };
-
         // vent (front face)
         {
-            float cx = ventBarDraw.x + ventBarDraw.w * 0.5f;
-            float cy = ventBarDraw.y + ventBarDraw.h * 0.5f;
-            glm::vec3 pos = mapToAC(cx, cy, 40.0f + 4.0f);
-            float wworld = ventBarDraw.w * (240.0f / acBody.w);
-            float hworld = ventBarDraw.h * (100.0f / acBody.h);
-            float depth = 6.0f;
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, pos);
-            model = glm::scale(model, glm::vec3(wworld, hworld, depth));
-            renderer3D.drawCube(model, glm::vec3(ventBarDraw.color.r, ventBarDraw.color.g, ventBarDraw.color.b));
+            const UiNode& vent = layout.node(UiNodeId::Vent);
+            drawCube(vent.world, glm::vec3(vent.local.color.r, vent.local.color.g, vent.local.color.b));
         }
 
-        // lamp (small sphere-like cube on front)
+        // lamp (flat quad on the front; the textured face shows a circular icon)
         {
-            float cx = lampDraw.x;
-            float cy = lampDraw.y;
-            glm::vec3 pos = mapToAC(cx, cy, 40.0f + 6.0f);
-            float diam = lampDraw.radius * 2.0f * (240.0f / acBody.w);
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, pos);
-            // scale to a flat quad (thin depth) so textured front face shows circular icon
-            model = glm::scale(model, glm::vec3(diam, diam, 2.0f));
-            glm::vec3 lampCol(lampDraw.color.r, lampDraw.color.g, lampDraw.color.b);
-            renderer3D.drawTexturedCube(model, lampCircleTex, lampCol);
+            const UiNode& lampNode = layout.node(UiNodeId::Lamp);
+            glm::vec3 lampCol(lampNode.local.color.r, lampNode.local.color.g, lampNode.local.color.b);
+            setObjectId(static_cast<unsigned int>(pickLamp + 1));
+            drawTexturedCube(lampNode.world, lampCircleTex, lampCol, true);
+            setObjectId(0);
         }
 
-        // screens: render desired/current temperatures onto the first two screens using text textures
-        GLuint tempTex0 = 0; int tempW0 = 0; int tempH0 = 0;
-        GLuint tempTex1 = 0; int tempW1 = 0; int tempH1 = 0;
-        if (appState.isOn) {
-            std::string s0 = std::to_string(static_cast<int>(appState.desiredTemp));
-            std::string s1 = std::to_string(static_cast<int>(appState.currentTemp));
-            // create textures for the two temperature displays
-            textRenderer.createTextTexture(s0, digitColor, screenColor, 8, 64, tempTex0, tempW0, tempH0);
-            textRenderer.createTextTexture(s1, digitColor, screenColor, 8, 64, tempTex1, tempW1, tempH1);
-        }
-
-        for (size_t i = 0; i < screensDraw.size(); ++i)
-        {
-            const auto& screen = screensDraw[i];
-            float cx = screen.x + screen.w * 0.5f;
-            float cy = screen.y + screen.h * 0.5f;
-            glm::vec3 pos = mapToAC(cx, cy, 40.0f + 4.0f);
-            float wworld = screen.w * (240.0f / acBody.w);
-            float hworld = screen.h * (100.0f / acBody.h);
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, pos);
-            model = glm::scale(model, glm::vec3(wworld, hworld, 4.0f));
-            if (i == 0 && tempTex0 != 0) {
-                renderer3D.drawTexturedCube(model, tempTex0);
-            } else if (i == 1 && tempTex1 != 0) {
-                renderer3D.drawTexturedCube(model, tempTex1);
-            } else {
-                renderer3D.drawCube(model, glm::vec3(screenColor.r, screenColor.g, screenColor.b));
-            }
-        }
-        // cleanup temporary temp textures
-        if (tempTex0 != 0) glDeleteTextures(1, &tempTex0);
-        if (tempTex1 != 0) glDeleteTextures(1, &tempTex1);
+        // screens: one textured draw of the composited panel
+        drawTexturedCube(layout.node(UiNodeId::Panel).world, displayPanel.texture(), glm::vec3(1.0f), false);
 
         // arrows (draw button halves with visible arrow glyphs)
         {
-            float scaleX = 240.0f / acBody.w;
-            float scaleY = 100.0f / acBody.h;
-            float halfH = tempArrowDraw.h * 0.5f;
-            float wworld = tempArrowDraw.w * scaleX;
-            float hworld = halfH * scaleY;
-            float cx = tempArrowDraw.x + tempArrowDraw.w * 0.5f;
-            float cyTop = tempArrowDraw.y + halfH * 0.5f;
-            float cyBot = tempArrowDraw.y + halfH + halfH * 0.5f;
-            float zFront = 40.0f + 6.0f;
-
-            auto drawArrowHalf = [&](float cy, bool isUp)
+            auto drawArrowHalf = [&](UiNodeId id, bool isUp)
             {
-                glm::vec3 pos = mapToAC(cx, cy, zFront);
-                glm::mat4 model = glm::mat4(1.0f);
-                model = glm::translate(model, pos);
-                model = glm::scale(model, glm::vec3(wworld, hworld, 4.0f));
-                renderer3D.drawCube(model, glm::vec3(arrowBg.r, arrowBg.g, arrowBg.b));
+                const UiNode& half = layout.node(id);
+                setObjectId(static_cast<unsigned int>((isUp ? pickArrowUp : pickArrowDown) + 1));
+                drawCube(half.world, glm::vec3(arrowBg.r, arrowBg.g, arrowBg.b));
 
+                // glyph built from stacked bars that widen towards the base
                 int steps = 6;
-                float glyphH = halfH * 0.7f;
-                float glyphW = tempArrowDraw.w * 0.6f;
+                glm::vec3 c = half.worldCenter;
+                float glyphH = half.worldHalfExtents.y * 2.0f * 0.7f;
+                float glyphW = half.worldHalfExtents.x * 2.0f * 0.6f;
                 float stepH = glyphH / static_cast<float>(steps);
                 for (int i = 0; i < steps; ++i)
                 {
                     float t = (static_cast<float>(i) + 1.0f) / static_cast<float>(steps);
-                    float w = glyphW * t;
-                    float h = stepH * 0.85f;
-                    float y = isUp ? (cy - glyphH * 0.5f + static_cast<float>(i) * stepH)
-                                   : (cy + glyphH * 0.5f - (static_cast<float>(i) + 1.0f) * stepH);
-                    glm::vec3 gpos = mapToAC(cx, y, zFront + 1.0f);
+                    float y = isUp ? (c.y + glyphH * 0.5f - static_cast<float>(i) * stepH)
+                                   : (c.y - glyphH * 0.5f + (static_cast<float>(i) + 1.0f) * stepH);
                     glm::mat4 gmodel = glm::mat4(1.0f);
-                    gmodel = glm::translate(gmodel, gpos);
-                    gmodel = glm::scale(gmodel, glm::vec3(w * scaleX, h * scaleY, 2.0f));
-                    renderer3D.drawCube(gmodel, glm::vec3(arrowColor.r, arrowColor.g, arrowColor.b));
+                    gmodel = glm::translate(gmodel, glm::vec3(c.x, y, c.z + 1.0f));
+                    gmodel = glm::scale(gmodel, glm::vec3(glyphW * t, stepH * 0.85f, 2.0f));
+                    drawCube(gmodel, glm::vec3(arrowColor.r, arrowColor.g, arrowColor.b));
                 }
+                setObjectId(0);
             };
 
-            drawArrowHalf(cyTop, true);
-            drawArrowHalf(cyBot, false);
+            drawArrowHalf(UiNodeId::ArrowUp, true);
+            drawArrowHalf(UiNodeId::ArrowDown, false);
         }
 
         // bowl: place under the AC and render as a hollow container so it can be filled
+        bool toiletDrawn = false;
         {
             float depth = 80.0f;
             float thicknessWorld = bowlThickness * (100.0f / acBody.h);
@@ -859,7 +971,7 @@ int main()
                     if (maxInnerHeightWorld < 0.0f) maxInnerHeightWorld = 0.0f;
                     float waterHWorld = maxInnerHeightWorld * appState.waterLevel;
 
-                    renderer3D.drawHollowBoxAt(pos, innerWWorld, heldBoxHeight, depth, thicknessWorld, glm::vec3(bowlOutline.color.r, bowlOutline.color.g, bowlOutline.color.b));
+                    drawHollowBoxAt(pos, innerWWorld, heldBoxHeight, depth, thicknessWorld, glm::vec3(bowlOutline.color.r, bowlOutline.color.g, bowlOutline.color.b));
                     if (appState.waterLevel > 0.0f) {
                         // compute inner top Y and center of water column
                         float topY = pos.y + (heldBoxHeight * 0.5f) - thicknessWorld;
@@ -869,22 +981,20 @@ int main()
                         float innerDepth = depth - 2.0f * thicknessWorld;
                         if (innerDepth < 2.0f) innerDepth = 2.0f;
                         wmodel = glm::scale(wmodel, glm::vec3(innerWWorld, waterHWorld, innerDepth));
-                        renderer3D.drawCube(wmodel, glm::vec3(waterColor.r, waterColor.g, waterColor.b));
+                        drawCube(wmodel, glm::vec3(waterColor.r, waterColor.g, waterColor.b));
                     }
-                    if (appState.waterLevel >= 1.0f) droplets.clear();
                 }
             }
             else
             {
                 // default on-floor bowl
-                float wworld = bowlDraw.w * (240.0f / acBody.w);
-                float hworld = bowlDraw.h * (100.0f / acBody.h);
-                float bowlFullHeight = hworld * 0.5f;
-                float acHalfHeight = 100.0f * 0.5f;
-                float gap = 300.0f;
-                glm::vec3 pos = glm::vec3(0.0f, -acHalfHeight - (bowlFullHeight * 0.5f) - gap, 0.0f);
+                float wworld = bowlNode.worldHalfExtents.x * 2.0f;
+                float bowlFullHeight = bowlHWorld;
+                glm::vec3 pos = bowlWorldPos;
 
-                renderer3D.drawHollowBoxAt(pos, wworld, bowlFullHeight, depth, thicknessWorld, glm::vec3(bowlOutline.color.r, bowlOutline.color.g, bowlOutline.color.b));
+                setObjectId(static_cast<unsigned int>(pickBowl + 1));
+                drawHollowBoxAt(pos, wworld, bowlFullHeight, depth, thicknessWorld, glm::vec3(bowlOutline.color.r, bowlOutline.color.g, bowlOutline.color.b));
+                setObjectId(0);
 
                 // place toilet at a fixed world position behind the player (computed once)
                 static bool toiletWorldSet = false;
@@ -908,25 +1018,29 @@ int main()
                     m = glm::rotate(m, glm::radians(270.0f), glm::vec3(1.0f, 0.0f, 0.0f));
                     // scale down a bit so model fits the scene
                     m = glm::scale(m, glm::vec3(6.0f));
-                    renderer3D.drawModel(toiletModelId, m, glm::vec3(0.95f, 0.95f, 0.97f));
+                    setObjectId(static_cast<unsigned int>(pickToilet + 1));
+                    drawModel(toiletModelId, m, glm::vec3(0.95f, 0.95f, 0.97f));
+                    setObjectId(0);
+                    pickScene.setTransform(pickToilet, m);
+                    toiletDrawn = true;
                 } else {
                     glm::vec3 toiletColor = glm::vec3(0.95f, 0.95f, 0.97f);
                     float toiletRadius = wworld * 0.35f;
                     float toiletHeight = bowlFullHeight * 1.2f;
                     float toiletThickness = thicknessWorld * 1.2f;
-                    renderer3D.drawHollowCylinderAt(toiletPos, toiletRadius, toiletHeight, toiletThickness, 32, toiletColor);
+                    drawHollowCylinderAt(toiletPos, toiletRadius, toiletHeight, toiletThickness, 32, toiletColor);
                     glm::mat4 tankModel = glm::mat4(1.0f);
                     glm::vec3 tankSize = glm::vec3(toiletRadius * 1.2f * 2.0f, toiletHeight * 0.6f, 40.0f);
                     glm::vec3 tankPos = toiletPos + glm::vec3(0.0f, toiletHeight * 0.5f + tankSize.y * 0.5f - 10.0f, -20.0f);
                     tankModel = glm::translate(tankModel, tankPos);
                     tankModel = glm::scale(tankModel, tankSize);
-                    renderer3D.drawCube(tankModel, toiletColor);
+                    drawCube(tankModel, toiletColor);
                     glm::mat4 seatModel = glm::mat4(1.0f);
                     glm::vec3 seatSize = glm::vec3(toiletRadius * 1.6f * 2.0f, 6.0f, toiletRadius * 1.6f * 2.0f);
                     glm::vec3 seatPos = toiletPos + glm::vec3(0.0f, toiletHeight * 0.45f + 3.0f, 0.0f);
                     seatModel = glm::translate(seatModel, seatPos);
                     seatModel = glm::scale(seatModel, seatSize);
-                    renderer3D.drawCube(seatModel, glm::vec3(0.9f, 0.9f, 0.91f));
+                    drawCube(seatModel, glm::vec3(0.9f, 0.9f, 0.91f));
                 }
 
                 // water inside bowl
@@ -946,176 +1060,158 @@ int main()
                     float innerDepth = depth - 2.0f * thicknessWorld;
                     if (innerDepth < 2.0f) innerDepth = 2.0f;
                     wmodel = glm::scale(wmodel, glm::vec3(innerWWorld, waterHWorld, innerDepth));
-                    renderer3D.drawCube(wmodel, glm::vec3(waterColor.r, waterColor.g, waterColor.b));
-                    if (appState.waterLevel >= 1.0f) droplets.clear();
+                    drawCube(wmodel, glm::vec3(waterColor.r, waterColor.g, waterColor.b));
                 }
             }
         }
 
-        // draw scene-light marker on top of 3D scene
-        renderer3D.render();
+        // the toilet is only pickable while it is on screen
+        pickScene.setEnabled(pickToilet, toiletDrawn);
 
-        // now disable depth and draw text overlays as before
-        glDisable(GL_DEPTH_TEST);
-
-        // Render status icon onto the third screen as a colored patch on the model
+        renderThread.record([&renderer3D, &textRenderer, &fpsRun, &depthRun, &cullRun, &nameplateRun, &memoryRuns,
+                             &statsRuns, &lastFrameStats, &perfRuns, renderWidth, renderHeight, depthTestEnabled, cullEnabled, showMemory, showStats,
+                             showPerf]
         {
-            float cx = screensDraw[2].x + screensDraw[2].w * 0.5f;
-            float cy = screensDraw[2].y + screensDraw[2].h * 0.5f;
-            glm::vec3 pos = mapToAC(cx, cy, 40.0f + 4.0f);
-            float iconSizePixels = std::min(screensDraw[2].w, screensDraw[2].h) * 0.6f;
-            float iconW = iconSizePixels * (240.0f / acBody.w);
-            float iconH = iconSizePixels * (100.0f / acBody.h);
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, pos);
-            model = glm::scale(model, glm::vec3(iconW, iconH, 4.0f));
-
-            // draw status icon on the rightmost screen using 3D primitives so it sits on the panel
-            auto drawStatusIcon3D = [&](const RectShape& screen, float desired, float current)
-            {
-                float cx = screen.x + screen.w * 0.5f;
-                float cy = screen.y + screen.h * 0.5f;
-                float z = 40.0f + 6.0f; // slightly in front of screen
-                glm::vec3 center = mapToAC(cx, cy, z);
-                float scaleX = 240.0f / acBody.w;
-                float scaleY = 100.0f / acBody.h;
-                float wworld = screen.w * scaleX;
-                float hworld = screen.h * scaleY;
-
-                const float tolerance = 0.25f;
-                float diff = desired - current;
-
-                if (diff > tolerance)
-                {
-                    // Heat icon: approximate flame with stacked boxes (vertical taper)
-                    int bands = 5;
-                    for (int i = 0; i < bands; ++i)
-                    {
-                        float t = 1.0f - static_cast<float>(i) / static_cast<float>(bands);
-                        float bw = wworld * (0.4f * t + 0.1f);
-                        float bh = hworld * 0.12f;
-                        float y = center.y - hworld * 0.25f + i * (bh * 0.9f);
-                        glm::mat4 m = glm::mat4(1.0f);
-                        m = glm::translate(m, glm::vec3(center.x, y, center.z + 1.0f));
-                        m = glm::scale(m, glm::vec3(bw, bh, 2.0f));
-                        renderer3D.drawCube(m, glm::vec3(0.96f, 0.46f, 0.28f));
-                    }
-                }
-                else if (diff < -tolerance)
-                {
-                    // Snow icon: cross arms
-                    float armW = wworld * 0.08f;
-                    float armL = wworld * 0.6f;
-                    glm::mat4 m1 = glm::mat4(1.0f);
-                    m1 = glm::translate(m1, glm::vec3(center.x, center.y, center.z + 1.0f));
-                    m1 = glm::scale(m1, glm::vec3(armL, armW, 2.0f));
-                    renderer3D.drawCube(m1, glm::vec3(0.66f, 0.85f, 0.98f));
-                    glm::mat4 m2 = glm::mat4(1.0f);
-                    m2 = glm::translate(m2, glm::vec3(center.x, center.y, center.z + 1.0f));
-                    m2 = glm::scale(m2, glm::vec3(armW, armL, 2.0f));
-                    renderer3D.drawCube(m2, glm::vec3(0.66f, 0.85f, 0.98f));
-                }
-                else
-                {
-                    // Check icon: two segments
-                    float dot = std::min(wworld, hworld) * 0.08f;
-                    glm::vec3 p1(center.x - wworld*0.15f, center.y + hworld*0.05f, center.z + 1.0f);
-                    glm::vec3 p2(center.x - wworld*0.02f, center.y - hworld*0.15f, center.z + 1.0f);
-                    glm::vec3 p3(center.x + wworld*0.20f, center.y + hworld*0.18f, center.z + 1.0f);
-                    // first segment
-                    glm::mat4 mA = glm::mat4(1.0f);
-                    glm::vec3 midA = (p1 + p2) * 0.5f;
-                    glm::vec3 dirA = p2 - p1;
-                    float lenA = glm::length(dirA);
-                    mA = glm::translate(mA, glm::vec3(midA.x, midA.y, midA.z));
-                    mA = glm::rotate(mA, atan2(dirA.y, dirA.x), glm::vec3(0.0f,0.0f,1.0f));
-                    mA = glm::scale(mA, glm::vec3(lenA, dot, 2.0f));
-                    renderer3D.drawCube(mA, glm::vec3(0.38f, 0.92f, 0.58f));
-                    // second segment
-                    glm::mat4 mB = glm::mat4(1.0f);
-                    glm::vec3 midB = (p2 + p3) * 0.5f;
-                    glm::vec3 dirB = p3 - p2;
-                    float lenB = glm::length(dirB);
-                    mB = glm::translate(mB, glm::vec3(midB.x, midB.y, midB.z));
-                    mB = glm::rotate(mB, atan2(dirB.y, dirB.x), glm::vec3(0.0f,0.0f,1.0f));
-                    mB = glm::scale(mB, glm::vec3(lenB, dot, 2.0f));
-                    renderer3D.drawCube(mB, glm::vec3(0.38f, 0.92f, 0.58f));
-                }
-            };
+            // draw scene-light marker on top of 3D scene
+            renderer3D.render();
 
-            drawStatusIcon3D(screensDraw[2], appState.desiredTemp, appState.currentTemp);
-        }
+            // now disable depth and draw text overlays as before
+            glDisable(GL_DEPTH_TEST);
 
+            // back to the default framebuffer; the 2D shader has no id output
+            renderer3D.endScene();
 
-        if (!frameStats.empty())
-        {
             // Ensure UI text and overlays are not culled by face-culling state
             GLboolean prevCull = glIsEnabled(GL_CULL_FACE);
             if (prevCull) glDisable(GL_CULL_FACE);
 
-            float statsScale = 0.6f;
             float margin = 16.0f;
-            textRenderer.drawText(frameStats, margin, margin, statsScale, digitColor);
+            textRenderer.drawRun(fpsRun, margin, margin);
+            float my = margin + textRenderer.layoutRun(fpsRun).height + 8.0f;
+            if (showMemory)
+            {
+                for (TextRun& run : memoryRuns)
+                {
+                    textRenderer.drawRun(run, margin, my);
+                    my += textRenderer.layoutRun(run).height + 2.0f;
+                }
+            }
+            if (showPerf)
+            {
+                for (TextRun& run : perfRuns)
+                {
+                    if (run.text().empty()) continue;
+                    textRenderer.drawRun(run, margin, my);
+                    my += textRenderer.layoutRun(run).height + 2.0f;
+                }
+            }
 
             // show depth/cull mode indicators at top-right
-            float indicatorScale = 0.6f;
-            std::string depthStr = depthTestEnabled ? std::string("Depth: ON (T)") : std::string("Depth: OFF (T)");
-            std::string cullStr = cullEnabled ? std::string("Cull: ON (C)") : std::string("Cull: OFF (C)");
-            TextMetrics dm = textRenderer.measure(depthStr, indicatorScale);
-            TextMetrics cm = textRenderer.measure(cullStr, indicatorScale);
-            float iright = static_cast<float>(windowWidth) - margin;
-            float dx = iright - dm.width;
+            depthRun.setText(depthTestEnabled ? "Depth: ON (T)" : "Depth: OFF (T)");
+            cullRun.setText(cullEnabled ? "Cull: ON (C)" : "Cull: OFF (C)");
+            const TextMetrics& dm = textRenderer.layoutRun(depthRun);
+            const TextMetrics& cm = textRenderer.layoutRun(cullRun);
+            float iright = static_cast<float>(renderWidth) - margin;
             float dy = margin;
-            textRenderer.drawText(depthStr, dx, dy, indicatorScale, digitColor);
-            textRenderer.drawText(cullStr, iright - cm.width, dy + dm.height + 4.0f, indicatorScale, digitColor);
-
-            // draw nameplate overlay if present
-            if (nameplateTexture != 0)
+            textRenderer.drawRun(depthRun, iright - dm.width, dy);
+            textRenderer.drawRun(cullRun, iright - cm.width, dy + dm.height + 4.0f);
+            if (showStats)
             {
-                float margin2 = 20.0f;
-                float overlayX = static_cast<float>(windowWidth) - static_cast<float>(nameplateW) - margin2;
-                float overlayY = static_cast<float>(windowHeight) - static_cast<float>(nameplateH) - margin2;
-
-                float vertices[6][4] = {
-                    { overlayX,                          overlayY + nameplateH, 0.0f, 0.0f },
-                    { overlayX,                          overlayY,               0.0f, 1.0f },
-                    { overlayX + nameplateW,             overlayY,               1.0f, 1.0f },
-
-                    { overlayX,                          overlayY + nameplateH, 0.0f, 0.0f },
-                    { overlayX + nameplateW,             overlayY,               1.0f, 1.0f },
-                    { overlayX + nameplateW,             overlayY + nameplateH, 1.0f, 0.0f },
-                };
-
-                glUseProgram(overlayProgram);
-                glUniform2f(overlayWindowSizeLoc, static_cast<float>(windowWidth), static_cast<float>(windowHeight));
-                glUniform4f(overlayTintLoc, 1.0f, 1.0f, 1.0f, 1.0f);
-                glUniform1i(overlayTextureLoc, 0);
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, nameplateTexture);
-
-                glBindVertexArray(overlayVao);
-                glBindBuffer(GL_ARRAY_BUFFER, overlayVbo);
-                glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-                glDrawArrays(GL_TRIANGLES, 0, 6);
-                glBindVertexArray(0);
+                const RenderStats& s = lastFrameStats;
+                char line[96];
+                std::snprintf(line, sizeof(line), "draws %u  tris %u  verts %u  programs %u", s.drawCalls, s.triangles, s.vertices,
+                              s.programSwitches);
+                statsRuns[0].setText(line);
+                std::snprintf(line, sizeof(line), "tex binds %u  uniforms %u  buf %.1f KB  tex %.1f KB", s.textureBinds, s.uniformUploads,
+                              s.bufferBytes / 1024.0, s.textureBytes / 1024.0);
+                statsRuns[1].setText(line);
+                float sy = dy + dm.height + 4.0f + cm.height + 4.0f;
+                for (TextRun& run : statsRuns)
+                {
+                    const TextMetrics& sm = textRenderer.layoutRun(run);
+                    textRenderer.drawRun(run, iright - sm.width, sy);
+                    sy += sm.height + 2.0f;
+                }
             }
 
+            // nameplate at bottom-right; its background box extends 10px past the text
+            const TextMetrics& nm = textRenderer.layoutRun(nameplateRun);
+            float margin2 = 20.0f;
+            float padding = 10.0f;
+            float nameX = static_cast<float>(renderWidth) - nm.width - padding - margin2;
+            float nameY = static_cast<float>(renderHeight) - nm.height - padding - margin2;
+            textRenderer.drawRun(nameplateRun, nameX, nameY);
+
             // restore culling state
             if (prevCull) glEnable(GL_CULL_FACE);
-        }
 
-        glfwSwapBuffers(window);
+            // the HUD is the last work of the frame, so this closes the frame's counters
+            lastFrameStats = renderer3D.stats();
+            lastFrameStats += textRenderer.stats();
+            renderer3D.resetStats();
+            textRenderer.resetStats();
+        });
+
+        // the GL thread presents this frame while the next one is built
+        renderThread.submit();
         glfwPollEvents();
 
+        if (!firstTextFrameReported && renderThread.presentedFrames() > 0)
+        {
+            // the HUD text is drawn every frame, so the first presented frame is the first text frame
+            startup.markFirstFrame(renderThread.firstPresentTime());
+            fprintf(stderr, "Startup to first text frame: %.1f ms\n", startup.timeToFirstFrameMs());
+            firstTextFrameReported = true;
+            if (const char* trace = std::getenv("AC_STARTUP_TRACE"))
+            {
+                if (!startup.writeTrace(trace)) fprintf(stderr, "Could not write startup trace to %s\n", trace);
+            }
+        }
+
+        // counts every thread, so simulation steps and GL work finished during this frame are included
+        logAllocations += AllocTracker::endFrame().allocations;
+        // main-thread counters only; the sleep below is not counted since the thread is off the CPU
+        if (PerfCounters::enabled())
+        {
+            logPerf += PerfCounters::endFrame();
+            ++logPerfFrames;
+        }
+
         auto targetTime = frameStartTime + std::chrono::duration<double>(TARGET_FRAME_TIME);
         auto now = std::chrono::steady_clock::now();
+        mainBusySeconds += std::chrono::duration<double>(now - frameStartTime).count();
         if (now < targetTime)
         {
             std::this_thread::sleep_until(targetTime); // coarse frame limiter to ~75 FPS
         }
     }
 
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    simulation.stop();
+    // GL objects are destroyed on this thread as main returns, so take the context back first
+    renderThread.stop();
+    if (AllocTracker::kEnabled) AllocTracker::writeReport(stderr);
+    if (PerfCounters::enabled()) PerfCounters::writeReport(stderr);
+    if (perfTracePath && PerfCounters::enabled() && !PerfCounters::writeTrace(perfTracePath))
+    {
+        fprintf(stderr, "Could not write perf trace to %s\n", perfTracePath);
+    }
+    if (profilePath)
+    {
+        SamplingProfiler::stop();
+        if (SamplingProfiler::writeFolded(profilePath))
+        {
+            fprintf(stderr, "Profile: %llu samples (%llu dropped) in %s; symbolize with Tools/symbolize_folded.py\n",
+                    static_cast<unsigned long long>(SamplingProfiler::sampleCount()),
+                    static_cast<unsigned long long>(SamplingProfiler::droppedCount()), profilePath);
+        }
+        else
+        {
+            fprintf(stderr, "Could not write profile to %s\n", profilePath);
+        }
+    }
+    GlPoolStats pool = GlResourcePool::stats();
+    std::fprintf(stderr, "GL pool: %.0f%% hits (%llu/%llu), %.1f MiB live, %.1f MiB idle\n", pool.hitRate() * 100.0f,
+                 static_cast<unsigned long long>(pool.hits), static_cast<unsigned long long>(pool.hits + pool.misses),
+                 pool.liveBytes / (1024.0 * 1024.0), pool.idleBytes / (1024.0 * 1024.0));
     return 0;
 }
@@ -0,0 +1,177 @@
+#include "../Header/MemoryLedger.h"
+
+#include "../Header/GlHandle.h"
+
+#include <GL/glew.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+    struct Category
+    {
+        std::atomic<int64_t> bytes{ 0 };
+        std::atomic<int64_t> peakBytes{ 0 };
+        std::atomic<int64_t> objects{ 0 };
+    };
+
+    struct GlEntry
+    {
+        MemoryCategory category;
+        size_t bytes;
+    };
+
+    Category g_categories[kMemoryCategoryCount];
+
+    // GL objects are created on the GL thread but the overlay may total from another
+    std::mutex g_glMutex;
+    std::unordered_map<uint64_t, GlEntry> g_glObjects;
+
+    const char* const kNames[kMemoryCategoryCount] = {
+        "textures", "render targets", "meshes", "dynamic buffers", "glyph atlas", "pool idle",
+        "droplets", "glyphs", "mesh staging", "frame arenas",
+    };
+
+    const char* const kTypeNames[] = { "texture", "buffer", "vertex array", "program", "framebuffer", "renderbuffer" };
+
+    uint64_t glKey(GlObjectType type, uint32_t id)
+    {
+        return (static_cast<uint64_t>(type) << 32) | id;
+    }
+
+    void charge(MemoryCategory category, int64_t bytes, int64_t objects)
+    {
+        Category& c = g_categories[static_cast<size_t>(category)];
+        int64_t now = c.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        c.objects.fetch_add(objects, std::memory_order_relaxed);
+        int64_t peak = c.peakBytes.load(std::memory_order_relaxed);
+        while (now > peak && !c.peakBytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+    }
+}
+
+const char* MemoryLedger::name(MemoryCategory category)
+{
+    return kNames[static_cast<size_t>(category)];
+}
+
+bool MemoryLedger::isGpu(MemoryCategory category)
+{
+    return category < MemoryCategory::Droplets;
+}
+
+void MemoryLedger::trackGl(MemoryCategory category, GlObjectType type, uint32_t id, size_t bytes)
+{
+    if (id == 0) return;
+    std::lock_guard<std::mutex> lock(g_glMutex);
+    auto [it, inserted] = g_glObjects.try_emplace(glKey(type, id), GlEntry{ category, bytes });
+    if (!inserted)
+    {
+        // re-specified storage or a pool hand-over: move the old charge
+        charge(it->second.category, -static_cast<int64_t>(it->second.bytes), -1);
+        it->second = GlEntry{ category, bytes };
+    }
+    charge(category, static_cast<int64_t>(bytes), 1);
+}
+
+void MemoryLedger::untrackGl(GlObjectType type, uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(g_glMutex);
+    auto it = g_glObjects.find(glKey(type, id));
+    if (it == g_glObjects.end()) return;
+    charge(it->second.category, -static_cast<int64_t>(it->second.bytes), -1);
+    g_glObjects.erase(it);
+}
+
+void MemoryLedger::addCpu(MemoryCategory category, int64_t bytes)
+{
+    charge(category, bytes, 0);
+}
+
+MemoryCategoryTotals MemoryLedger::totals(MemoryCategory category)
+{
+    const Category& c = g_categories[static_cast<size_t>(category)];
+    MemoryCategoryTotals t;
+    t.bytes = c.bytes.load(std::memory_order_relaxed);
+    t.peakBytes = c.peakBytes.load(std::memory_order_relaxed);
+    t.objects = c.objects.load(std::memory_order_relaxed);
+    return t;
+}
+
+int64_t MemoryLedger::gpuBytes()
+{
+    int64_t sum = 0;
+    for (size_t i = 0; i < kMemoryCategoryCount; ++i)
+    {
+        if (isGpu(static_cast<MemoryCategory>(i))) sum += g_categories[i].bytes.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+int64_t MemoryLedger::cpuBytes()
+{
+    int64_t sum = 0;
+    for (size_t i = 0; i < kMemoryCategoryCount; ++i)
+    {
+        if (!isGpu(static_cast<MemoryCategory>(i))) sum += g_categories[i].bytes.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+bool MemoryLedger::reportLeaks(FILE* out)
+{
+    size_t leaks = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_glMutex);
+        for (const auto& [key, entry] : g_glObjects)
+        {
+            std::fprintf(out, "  leaked GL %s %u (%s, %zu bytes)\n", kTypeNames[key >> 32], static_cast<unsigned>(key & 0xFFFFFFFFu),
+                         name(entry.category), entry.bytes);
+            ++leaks;
+        }
+    }
+    for (size_t i = 0; i < kMemoryCategoryCount; ++i)
+    {
+        MemoryCategory category = static_cast<MemoryCategory>(i);
+        int64_t bytes = g_categories[i].bytes.load(std::memory_order_relaxed);
+        if (isGpu(category) || bytes == 0) continue;
+        std::fprintf(out, "  leaked %lld bytes of %s\n", static_cast<long long>(bytes), name(category));
+        ++leaks;
+    }
+    if (leaks > 0) std::fprintf(out, "Memory ledger: %zu leak(s) at shutdown\n", leaks);
+    return leaks == 0;
+}
+
+size_t MemoryLedger::texelBytes(uint32_t internalFormat)
+{
+    switch (internalFormat)
+    {
+    case GL_RED:
+    case GL_R8: return 1;
+    case GL_RG:
+    case GL_RG8: return 2;
+    case GL_RGB:
+    case GL_RGB8: return 3;
+    case GL_RGBA16F: return 8;
+    case GL_RGBA32F: return 16;
+    default: return 4; // RGBA, RGBA8, R32UI, R32F, DEPTH24_STENCIL8, ...
+    }
+}
+
+MemoryCharge::MemoryCharge(MemoryCategory category, size_t bytes)
+    : m_category(category)
+{
+    set(bytes);
+}
+
+MemoryCharge::~MemoryCharge()
+{
+    set(0);
+}
+
+void MemoryCharge::set(size_t bytes)
+{
+    if (bytes == m_bytes) return;
+    MemoryLedger::addCpu(m_category, static_cast<int64_t>(bytes) - static_cast<int64_t>(m_bytes));
+    m_bytes = bytes;
+}
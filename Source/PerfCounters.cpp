@@ -0,0 +1,303 @@
+#include "../Header/PerfCounters.h"
+
+#if AC_PERF_COUNTERS
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr int kMaxZones = 32;
+    // four minutes at the target frame rate; older frames are not traced
+    constexpr size_t kMaxTraceFrames = 18000;
+
+    const uint64_t kConfigs[kPerfCounterCount] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    struct Zone
+    {
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<uint64_t> entries{ 0 };
+        std::atomic<uint64_t> values[kPerfCounterCount] = {};
+        std::atomic<uint8_t> valid{ 0 };
+    };
+
+    // One counter group per thread, led by the cycle counter so all members are scheduled together.
+    struct ThreadCounters
+    {
+        int fds[kPerfCounterCount] = { -1, -1, -1, -1 };
+        PerfCounter order[kPerfCounterCount] = {}; // position of each opened counter in a group read
+        int opened = 0;
+        bool tried = false;
+        PerfSample frameStart;
+
+        ~ThreadCounters()
+        {
+            for (int fd : fds)
+            {
+                if (fd >= 0) close(fd);
+            }
+        }
+    };
+
+    struct TraceFrame
+    {
+        uint64_t timeUs;
+        PerfSample sample;
+    };
+
+    std::atomic<bool> g_enabled{ false };
+    std::atomic<const char*> g_unavailable{ "off" };
+
+    Zone g_zones[kMaxZones];
+    std::atomic<int> g_zoneCount{ 0 };
+    std::atomic_flag g_zoneLock = ATOMIC_FLAG_INIT;
+
+    // frame thread only; reserved by enable() so endFrame never allocates
+    std::vector<TraceFrame> g_frames;
+    std::chrono::steady_clock::time_point g_start;
+
+    thread_local ThreadCounters t_counters;
+
+    int openCounter(uint64_t config, int group)
+    {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // user space only, which is all perf_event_paranoid=2 allows
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC));
+    }
+
+    const char* reasonFor(int error)
+    {
+        switch (error)
+        {
+        case EACCES:
+        case EPERM: return "not permitted (see /proc/sys/kernel/perf_event_paranoid)";
+        case ENOENT:
+        case ENODEV:
+        case EOPNOTSUPP: return "no hardware counters on this CPU or VM";
+        case ENOSYS: return "kernel without perf events";
+        default: return "perf_event_open failed";
+        }
+    }
+
+    bool openThread(ThreadCounters& t)
+    {
+        if (t.tried) return t.opened > 0;
+        t.tried = true;
+        int leader = openCounter(kConfigs[0], -1);
+        if (leader < 0)
+        {
+            g_unavailable.store(reasonFor(errno), std::memory_order_relaxed);
+            return false;
+        }
+        t.fds[0] = leader;
+        t.order[t.opened++] = PerfCounter::Cycles;
+        // the others are optional; some PMUs lack a cache or branch event
+        for (size_t i = 1; i < kPerfCounterCount; ++i)
+        {
+            int fd = openCounter(kConfigs[i], leader);
+            if (fd < 0) continue;
+            t.fds[i] = fd;
+            t.order[t.opened++] = static_cast<PerfCounter>(i);
+        }
+        return true;
+    }
+
+    PerfSample readThread()
+    {
+        PerfSample s;
+        ThreadCounters& t = t_counters;
+        if (!g_enabled.load(std::memory_order_relaxed) || !openThread(t)) return s;
+
+        // nr, time enabled, time running, then one value per counter in the order opened
+        uint64_t data[3 + kPerfCounterCount];
+        ssize_t bytes = ::read(t.fds[0], data, sizeof(data));
+        if (bytes < static_cast<ssize_t>((3 + t.opened) * sizeof(uint64_t))) return s;
+        // scale up when the kernel had to multiplex the group with other events
+        double scale = data[2] > 0 && data[2] < data[1] ? static_cast<double>(data[1]) / static_cast<double>(data[2]) : 1.0;
+        for (uint64_t i = 0; i < data[0] && i < static_cast<uint64_t>(t.opened); ++i)
+        {
+            size_t counter = static_cast<size_t>(t.order[i]);
+            s.values[counter] = static_cast<uint64_t>(static_cast<double>(data[3 + i]) * scale);
+            s.valid |= static_cast<uint8_t>(1u << counter);
+        }
+        return s;
+    }
+
+    int zoneIndex(const char* name)
+    {
+        int count = g_zoneCount.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i)
+        {
+            if (g_zones[i].name.load(std::memory_order_relaxed) == name) return i;
+        }
+
+        while (g_zoneLock.test_and_set(std::memory_order_acquire)) {}
+        int index = -1;
+        count = g_zoneCount.load(std::memory_order_relaxed);
+        for (int i = 0; i < count && index < 0; ++i)
+        {
+            if (g_zones[i].name.load(std::memory_order_relaxed) == name) index = i;
+        }
+        if (index < 0 && count < kMaxZones)
+        {
+            index = count;
+            g_zones[index].name.store(name, std::memory_order_relaxed);
+            g_zoneCount.store(count + 1, std::memory_order_release);
+        }
+        g_zoneLock.clear(std::memory_order_release);
+        return index;
+    }
+
+    PerfZoneTotals zoneTotals(int index)
+    {
+        const Zone& z = g_zones[index];
+        PerfZoneTotals t;
+        t.name = z.name.load(std::memory_order_relaxed);
+        t.entries = z.entries.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < kPerfCounterCount; ++i) t.sample.values[i] = z.values[i].load(std::memory_order_relaxed);
+        t.sample.valid = z.valid.load(std::memory_order_relaxed);
+        return t;
+    }
+}
+
+bool PerfCounters::enable()
+{
+    if (g_enabled.load(std::memory_order_relaxed)) return true;
+    g_enabled.store(true, std::memory_order_relaxed);
+    if (!openThread(t_counters))
+    {
+        g_enabled.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    g_unavailable.store(nullptr, std::memory_order_relaxed);
+    g_frames.reserve(kMaxTraceFrames);
+    g_start = std::chrono::steady_clock::now();
+    t_counters.frameStart = readThread();
+    return true;
+}
+
+bool PerfCounters::enabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+const char* PerfCounters::unavailableReason()
+{
+    return g_unavailable.load(std::memory_order_relaxed);
+}
+
+PerfSample PerfCounters::read()
+{
+    return readThread();
+}
+
+PerfSample PerfCounters::endFrame()
+{
+    if (!g_enabled.load(std::memory_order_relaxed)) return PerfSample{};
+    PerfSample now = readThread();
+    PerfSample frame = now;
+    frame -= t_counters.frameStart;
+    t_counters.frameStart = now;
+    if (g_frames.size() < kMaxTraceFrames)
+    {
+        auto since = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_start);
+        g_frames.push_back(TraceFrame{ static_cast<uint64_t>(since.count()), frame });
+    }
+    return frame;
+}
+
+size_t PerfCounters::zones(PerfZoneTotals* out, size_t max)
+{
+    int count = g_zoneCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count && static_cast<size_t>(i) < max; ++i) out[i] = zoneTotals(i);
+    return static_cast<size_t>(count);
+}
+
+void PerfCounters::writeReport(FILE* out)
+{
+    if (!enabled())
+    {
+        std::fprintf(out, "perf counters: %s\n", unavailableReason());
+        return;
+    }
+    int count = g_zoneCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i)
+    {
+        PerfZoneTotals t = zoneTotals(i);
+        double entries = t.entries > 0 ? static_cast<double>(t.entries) : 1.0;
+        std::fprintf(out, "  perf zone %-16s %8llu entries  IPC %.2f  LLC misses %.0f  branch misses %.0f (per entry)\n", t.name,
+                     static_cast<unsigned long long>(t.entries), t.sample.ipc(), t.sample[PerfCounter::CacheMisses] / entries,
+                     t.sample[PerfCounter::BranchMisses] / entries);
+    }
+}
+
+bool PerfCounters::writeTrace(const char* path)
+{
+    FILE* out = std::fopen(path, "w");
+    if (!out) return false;
+    std::fprintf(out, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < g_frames.size(); ++i)
+    {
+        const TraceFrame& f = g_frames[i];
+        std::fprintf(out,
+                     "{\"name\":\"cpu counters\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":%llu,\"args\":{\"ipc\":%.3f,\"llc_misses\":%llu,"
+                     "\"branch_misses\":%llu}}%s\n",
+                     static_cast<unsigned long long>(f.timeUs), f.sample.ipc(),
+                     static_cast<unsigned long long>(f.sample[PerfCounter::CacheMisses]),
+                     static_cast<unsigned long long>(f.sample[PerfCounter::BranchMisses]), i + 1 < g_frames.size() ? "," : "");
+    }
+    std::fprintf(out, "]}\n");
+    return std::fclose(out) == 0;
+}
+
+PerfZone::PerfZone(const char* name)
+{
+    if (!g_enabled.load(std::memory_order_relaxed)) return;
+    m_zone = zoneIndex(name);
+    m_start = readThread();
+}
+
+PerfZone::~PerfZone()
+{
+    if (m_zone < 0) return;
+    PerfSample delta = readThread();
+    delta -= m_start;
+    Zone& z = g_zones[m_zone];
+    z.entries.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < kPerfCounterCount; ++i)
+    {
+        if (delta.has(static_cast<PerfCounter>(i))) z.values[i].fetch_add(delta.values[i], std::memory_order_relaxed);
+    }
+    z.valid.fetch_or(delta.valid, std::memory_order_relaxed);
+}
+
+#else
+
+bool PerfCounters::enable() { return false; }
+bool PerfCounters::enabled() { return false; }
+const char* PerfCounters::unavailableReason() { return "needs Linux perf_event_open"; }
+PerfSample PerfCounters::read() { return PerfSample{}; }
+PerfSample PerfCounters::endFrame() { return PerfSample{}; }
+size_t PerfCounters::zones(PerfZoneTotals*, size_t) { return 0; }
+void PerfCounters::writeReport(FILE* out) { std::fprintf(out, "perf counters: %s\n", unavailableReason()); }
+bool PerfCounters::writeTrace(const char*) { return false; }
+
+#endif
@@ -0,0 +1,109 @@
+#include "../Header/RenderThread.h"
+
+#include "../Header/AllocTracker.h"
+#include "../Header/GlHandle.h"
+#include "../Header/GlInterpose.h"
+#include "../Header/PerfCounters.h"
+#include "../Header/SamplingProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+RenderThread::RenderThread(GLFWwindow* window, bool threaded, int framesInFlight)
+    : m_window(window)
+    , m_threaded(threaded)
+    , m_framesInFlight(std::max(framesInFlight, 1))
+{
+    for (int i = 0; i < m_framesInFlight + 1; ++i) m_buffers.push_back(std::make_unique<CommandBuffer>());
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+}
+
+void RenderThread::start()
+{
+    if (!m_threaded || m_thread.joinable()) return;
+    m_stopping = false;
+    glfwMakeContextCurrent(nullptr);
+    m_thread = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::stop()
+{
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+    glfwMakeContextCurrent(m_window);
+}
+
+void RenderThread::submit()
+{
+    if (!m_threaded || !m_thread.joinable())
+    {
+        executeAndPresent(*m_buffers[m_recording]);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ++m_pending;
+    m_cv.notify_all();
+    // the next list to record into is the oldest one still queued when the pipeline is full
+    m_cv.wait(lock, [this] { return m_pending <= m_framesInFlight; });
+    m_recording = (m_recording + 1) % m_buffers.size();
+}
+
+void RenderThread::executeAndPresent(CommandBuffer& buffer)
+{
+    AllocZone zone("gl.frame");
+    PerfZone perfZone("gl.frame");
+    buffer.execute();
+    // objects released during the frame are freed once the GPU is done with it
+    GlDeletionQueue::endFrame();
+    glfwSwapBuffers(m_window);
+    if (m_presented.load(std::memory_order_relaxed) == 0) m_firstPresent = std::chrono::steady_clock::now();
+    GlInterpose::endFrame();
+    m_frameArena.reset();
+    m_presented.fetch_add(1, std::memory_order_release);
+}
+
+void RenderThread::run()
+{
+    ProfiledThread profiled("gl");
+    using Clock = std::chrono::steady_clock;
+    glfwMakeContextCurrent(m_window);
+
+    Clock::time_point windowStart = Clock::now();
+    Clock::duration busy{};
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_cv.wait(lock, [this] { return m_pending > 0 || m_stopping; });
+        if (m_pending == 0) break; // stopping with nothing left to draw
+
+        CommandBuffer& buffer = *m_buffers[m_nextToExecute];
+        lock.unlock();
+        Clock::time_point start = Clock::now();
+        executeAndPresent(buffer);
+        Clock::time_point end = Clock::now();
+        busy += end - start;
+        if (end - windowStart >= std::chrono::seconds(1))
+        {
+            m_utilization.store(std::chrono::duration<float>(busy).count() / std::chrono::duration<float>(end - windowStart).count(), std::memory_order_relaxed);
+            busy = Clock::duration{};
+            windowStart = end;
+        }
+        lock.lock();
+
+        m_nextToExecute = (m_nextToExecute + 1) % m_buffers.size();
+        --m_pending;
+        m_cv.notify_all();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
@@ -1,21 +1,23 @@
 #include "Renderer.h"
+#include "GlBindings.h"
 #include <GL/glew.h>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <utility>
 #include <vector>
 #include <glm/gtc/type_ptr.hpp>
 
 Renderer::Renderer() {}
 Renderer::~Renderer() {
-  if (phongProgram_ != 0) glDeleteProgram(phongProgram_);
-  if (blinnProgram_ != 0) glDeleteProgram(blinnProgram_);
+  destroyIdTargets();
 }
 
 bool Renderer::init() {
   // Compile and link shaders
-  phongProgram_ = createShaderProgram("Shaders/phong.vert", "Shaders/phong.frag");
-  blinnProgram_ = createShaderProgram("Shaders/phong.vert", "Shaders/blinn.frag");
+  phongProgram_ = GlProgram(createShaderProgram("Shaders/phong.vert", "Shaders/phong.frag"));
+  blinnProgram_ = GlProgram(createShaderProgram("Shaders/phong.vert", "Shaders/blinn.frag"));
   if (phongProgram_ == 0) {
     std::cerr << "Failed to create Phong shader program" << std::endl;
     return false;
@@ -26,13 +28,14 @@ bool Renderer::init() {
   }
 
   // Create a simple white 1x1 texture
-  glGenTextures(1, &defaultTex_);
-  glBindTexture(GL_TEXTURE_2D, defaultTex_);
+  defaultTex_ = GlTexture::create();
+  GlBindings::bindTexture2D(defaultTex_, &stats_);
   unsigned char white[4] = {255,255,255,255};
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+  MemoryLedger::trackGl(MemoryCategory::Textures, GlObjectType::Texture, defaultTex_, sizeof(white));
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glBindTexture(GL_TEXTURE_2D, 0);
+  GlBindings::bindTexture2D(0, &stats_);
 
   // Create cube geometry (positions, normals, texcoords) - 36 vertices
   float verts[] = {
@@ -80,11 +83,12 @@ bool Renderer::init() {
     -0.5f, -0.5f,  0.5f, 0,-1,0, 0,0,
     -0.5f, -0.5f, -0.5f, 0,-1,0, 0,1
   };
-  glGenVertexArrays(1, &cubeVao_);
-  glGenBuffers(1, &cubeVbo_);
+  cubeVao_ = GlVertexArray::create();
+  cubeVbo_ = GlBuffer::create();
   glBindVertexArray(cubeVao_);
   glBindBuffer(GL_ARRAY_BUFFER, cubeVbo_);
   glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+  MemoryLedger::trackGl(MemoryCategory::Meshes, GlObjectType::Buffer, cubeVbo_, sizeof(verts));
   // pos
   glEnableVertexAttribArray(0);
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(0));
@@ -109,18 +113,21 @@ void Renderer::render() {
   // use constant yellow so marker never disappears if intensity changes
   glm::vec3 markerColor = glm::vec3(1.0f, 1.0f, 0.0f);
 
-  // draw on top of scene
+  // draw on top of scene; the marker hides what is behind it, so it clears the pick id too
   GLboolean prevDepth = glIsEnabled(GL_DEPTH_TEST);
   if (prevDepth) glDisable(GL_DEPTH_TEST);
   glDepthMask(GL_FALSE);
+  unsigned int prevId = objectId_;
+  objectId_ = 0;
   drawCube(lightModel, markerColor);
+  objectId_ = prevId;
   glDepthMask(GL_TRUE);
   if (prevDepth) glEnable(GL_DEPTH_TEST);
 }
 
 void Renderer::drawCube(const glm::mat4& model, const glm::vec3& color) {
   if (phongProgram_ == 0) return;
-  glUseProgram(phongProgram_);
+  GlBindings::useProgram(phongProgram_, &stats_);
 
   GLint locModel = glGetUniformLocation(phongProgram_, "model");
   if (locModel >= 0) glUniformMatrix4fv(locModel, 1, GL_FALSE, glm::value_ptr(model));
@@ -135,22 +142,24 @@ void Renderer::drawCube(const glm::mat4& model, const glm::vec3& color) {
 
   // bind default texture
   glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, defaultTex_);
+  GlBindings::bindTexture2D(defaultTex_, &stats_);
   GLint texLoc = glGetUniformLocation(phongProgram_, "tex");
   if (texLoc >= 0) glUniform1i(texLoc, 0);
   // ensure flipV is disabled for colored cube draws
   GLint flipLoc = glGetUniformLocation(phongProgram_, "flipV");
   if (flipLoc >= 0) glUniform1i(flipLoc, 0);
+  applyObjectId(phongProgram_);
+  stats_.uniformUploads += liveUniforms(locModel, locMat, locSpec, locSh, alphaLoc, texLoc, flipLoc);
 
   glBindVertexArray(cubeVao_);
   glDrawArrays(GL_TRIANGLES, 0, cubeVboCount_);
+  stats_.addDraw(GL_TRIANGLES, cubeVboCount_);
   glBindVertexArray(0);
-  glUseProgram(0);
 }
 
-void Renderer::drawTexturedCube(const glm::mat4& model, GLuint texture, const glm::vec3& color) {
+void Renderer::drawTexturedCube(const glm::mat4& model, GLuint texture, const glm::vec3& color, bool flipV) {
   if (phongProgram_ == 0) return;
-  glUseProgram(phongProgram_);
+  GlBindings::useProgram(phongProgram_, &stats_);
 
   GLint locModel = glGetUniformLocation(phongProgram_, "model");
   if (locModel >= 0) glUniformMatrix4fv(locModel, 1, GL_FALSE, glm::value_ptr(model));
@@ -163,25 +172,27 @@ void Renderer::drawTexturedCube(const glm::mat4& model, GLuint texture, const gl
 
   // bind provided texture
   glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, texture ? texture : defaultTex_);
+  GlBindings::bindTexture2D(texture ? texture : defaultTex_, &stats_);
   GLint texLoc = glGetUniformLocation(phongProgram_, "tex");
   if (texLoc >= 0) glUniform1i(texLoc, 0);
   // flip vertically so text appears upright on cube faces
   GLint flipLoc = glGetUniformLocation(phongProgram_, "flipV");
-  if (flipLoc >= 0) glUniform1i(flipLoc, 1);
+  if (flipLoc >= 0) glUniform1i(flipLoc, flipV ? 1 : 0);
   // set alpha to fully opaque for textured faces unless caller changes
   GLint alphaLoc = glGetUniformLocation(phongProgram_, "uAlpha");
   if (alphaLoc >= 0) glUniform1f(alphaLoc, 1.0f);
+  applyObjectId(phongProgram_);
+  stats_.uniformUploads += liveUniforms(locModel, locMat, locSpec, locSh, alphaLoc, texLoc, flipLoc);
 
   glBindVertexArray(cubeVao_);
   glDrawArrays(GL_TRIANGLES, 0, cubeVboCount_);
+  stats_.addDraw(GL_TRIANGLES, cubeVboCount_);
   glBindVertexArray(0);
-  glUseProgram(0);
 }
 
 void Renderer::drawParticle(const glm::mat4& model, const glm::vec3& color, float alpha) {
   if (phongProgram_ == 0) return;
-  glUseProgram(phongProgram_);
+  GlBindings::useProgram(phongProgram_, &stats_);
   GLint locModel = glGetUniformLocation(phongProgram_, "model");
   if (locModel >= 0) glUniformMatrix4fv(locModel, 1, GL_FALSE, glm::value_ptr(model));
   GLint locMat = glGetUniformLocation(phongProgram_, "materialDiffuse");
@@ -192,18 +203,22 @@ void Renderer::drawParticle(const glm::mat4& model, const glm::vec3& color, floa
   if (locSh >= 0) glUniform1f(locSh, 8.0f);
 
   glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, defaultTex_);
+  GlBindings::bindTexture2D(defaultTex_, &stats_);
   GLint texLoc = glGetUniformLocation(phongProgram_, "tex");
   if (texLoc >= 0) glUniform1i(texLoc, 0);
   GLint flipLoc = glGetUniformLocation(phongProgram_, "flipV");
   if (flipLoc >= 0) glUniform1i(flipLoc, 0);
   GLint alphaLoc = glGetUniformLocation(phongProgram_, "uAlpha");
   if (alphaLoc >= 0) glUniform1f(alphaLoc, alpha);
+  // translucent particles must not replace the id of what is seen through them
+  if (sceneActive_) glColorMaski(1, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  stats_.uniformUploads += liveUniforms(locModel, locMat, locSpec, locSh, texLoc, flipLoc, alphaLoc);
 
   glBindVertexArray(cubeVao_);
   glDrawArrays(GL_TRIANGLES, 0, cubeVboCount_);
+  stats_.addDraw(GL_TRIANGLES, cubeVboCount_);
   glBindVertexArray(0);
-  glUseProgram(0);
+  if (sceneActive_) glColorMaski(1, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 }
 
 void Renderer::drawHollowBoxAt(const glm::vec3& center, float width, float height, float depth, float thickness, const glm::vec3& color) {
@@ -258,12 +273,18 @@ void Renderer::drawHollowCylinderAt(const glm::vec3& center, float radius, float
 
 // Simple OBJ loader and model draw implementation appended
 int Renderer::loadOBJModel(const std::string& path) {
+  std::vector<float> interleaved;
+  if (!parseOBJModel(path, interleaved)) return -1;
+  return addModel(interleaved);
+}
+
+bool Renderer::parseOBJModel(const std::string& path, std::vector<float>& interleaved) {
+  interleaved.clear();
   std::ifstream in(path);
-  if (!in) return -1;
+  if (!in) return false;
   std::vector<glm::vec3> positions;
   std::vector<glm::vec3> normals;
   std::vector<glm::vec2> texcoords;
-  std::vector<float> interleaved;
 
   std::string line;
   while (std::getline(in, line)) {
@@ -319,14 +340,22 @@ int Renderer::loadOBJModel(const std::string& path) {
     }
   }
 
+  return !interleaved.empty();
+}
+
+int Renderer::addModel(const std::vector<float>& interleaved) {
   if (interleaved.empty()) return -1;
+  // charged until the upload below is done, so the ledger's peak shows the load spike
+  MemoryCharge staging(MemoryCategory::MeshStaging, interleaved.capacity() * sizeof(float));
 
-  ModelMesh m{};
-  glGenVertexArrays(1, &m.vao);
-  glGenBuffers(1, &m.vbo);
+  ModelMesh m;
+  m.vao = GlVertexArray::create();
+  m.vbo = GlBuffer::create();
   glBindVertexArray(m.vao);
   glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
   glBufferData(GL_ARRAY_BUFFER, interleaved.size() * sizeof(float), interleaved.data(), GL_STATIC_DRAW);
+  stats_.bufferBytes += interleaved.size() * sizeof(float);
+  MemoryLedger::trackGl(MemoryCategory::Meshes, GlObjectType::Buffer, m.vbo, interleaved.size() * sizeof(float));
   // pos
   glEnableVertexAttribArray(0);
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
@@ -338,15 +367,26 @@ int Renderer::loadOBJModel(const std::string& path) {
   glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
   glBindVertexArray(0);
   m.vertCount = static_cast<int>(interleaved.size() / 8);
-  models_.push_back(m);
+  m.positions.reserve(m.vertCount);
+  for (size_t i = 0; i < interleaved.size(); i += 8) {
+    m.positions.emplace_back(interleaved[i], interleaved[i + 1], interleaved[i + 2]);
+  }
+  modelPositionsMemory_.set(modelPositionsMemory_.bytes() + m.positions.capacity() * sizeof(glm::vec3));
+  models_.push_back(std::move(m));
   return static_cast<int>(models_.size() - 1);
 }
 
+const std::vector<glm::vec3>& Renderer::modelPositions(int modelId) const {
+  static const std::vector<glm::vec3> empty;
+  if (modelId < 0 || modelId >= (int)models_.size()) return empty;
+  return models_[modelId].positions;
+}
+
 void Renderer::drawModel(int modelId, const glm::mat4& model, const glm::vec3& color) {
   if (phongProgram_ == 0) return;
   if (modelId < 0 || modelId >= (int)models_.size()) return;
   const ModelMesh &m = models_[modelId];
-  glUseProgram(phongProgram_);
+  GlBindings::useProgram(phongProgram_, &stats_);
   GLint locModel = glGetUniformLocation(phongProgram_, "model");
   if (locModel >= 0) glUniformMatrix4fv(locModel, 1, GL_FALSE, glm::value_ptr(model));
   GLint locMat = glGetUniformLocation(phongProgram_, "materialDiffuse");
@@ -356,15 +396,17 @@ void Renderer::drawModel(int modelId, const glm::mat4& model, const glm::vec3& c
   GLint locSh = glGetUniformLocation(phongProgram_, "shininess");
   if (locSh >= 0) glUniform1f(locSh, 32.0f);
   glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, defaultTex_);
+  GlBindings::bindTexture2D(defaultTex_, &stats_);
   GLint texLoc = glGetUniformLocation(phongProgram_, "tex");
   if (texLoc >= 0) glUniform1i(texLoc, 0);
   GLint flipLoc = glGetUniformLocation(phongProgram_, "flipV");
   if (flipLoc >= 0) glUniform1i(flipLoc, 0);
+  applyObjectId(phongProgram_);
+  stats_.uniformUploads += liveUniforms(locModel, locMat, locSpec, locSh, texLoc, flipLoc);
   glBindVertexArray(m.vao);
   glDrawArrays(GL_TRIANGLES, 0, m.vertCount);
+  stats_.addDraw(GL_TRIANGLES, m.vertCount);
   glBindVertexArray(0);
-  glUseProgram(0);
 }
 
 void Renderer::setViewProjection(const glm::mat4& view, const glm::mat4& proj) {
@@ -378,11 +420,11 @@ void Renderer::setViewProjection(const glm::mat4& view, const glm::mat4& proj) {
   float lightIntensity = sceneLightIntensity_;
 
   if (phongProgram_ != 0) {
-    glUseProgram(phongProgram_);
-    GLint loc = glGetUniformLocation(phongProgram_, "view");
-    if (loc >= 0) glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(view));
-    loc = glGetUniformLocation(phongProgram_, "projection");
-    if (loc >= 0) glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(proj));
+    GlBindings::useProgram(phongProgram_, &stats_);
+    GLint locView = glGetUniformLocation(phongProgram_, "view");
+    if (locView >= 0) glUniformMatrix4fv(locView, 1, GL_FALSE, glm::value_ptr(view));
+    GLint locProj = glGetUniformLocation(phongProgram_, "projection");
+    if (locProj >= 0) glUniformMatrix4fv(locProj, 1, GL_FALSE, glm::value_ptr(proj));
 
     GLint lp = glGetUniformLocation(phongProgram_, "light.position");
     GLint lc = glGetUniformLocation(phongProgram_, "light.color");
@@ -403,6 +445,7 @@ void Renderer::setViewProjection(const glm::mat4& view, const glm::mat4& proj) {
 
     GLint viewPosLoc = glGetUniformLocation(phongProgram_, "viewPos");
     if (viewPosLoc >= 0) glUniform3f(viewPosLoc, camPos.x, camPos.y, camPos.z);
+    stats_.uniformUploads += liveUniforms(locView, locProj, lp, lc, li, lpp, lpc, lpi, len, viewPosLoc);
 
     // log once so user can inspect coordinates (helpful for debugging visibility)
     static bool lightLogged = false;
@@ -414,11 +457,11 @@ void Renderer::setViewProjection(const glm::mat4& view, const glm::mat4& proj) {
   }
 
   if (blinnProgram_ != 0) {
-    glUseProgram(blinnProgram_);
-    GLint loc = glGetUniformLocation(blinnProgram_, "view");
-    if (loc >= 0) glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(view));
-    loc = glGetUniformLocation(blinnProgram_, "projection");
-    if (loc >= 0) glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(proj));
+    GlBindings::useProgram(blinnProgram_, &stats_);
+    GLint locView = glGetUniformLocation(blinnProgram_, "view");
+    if (locView >= 0) glUniformMatrix4fv(locView, 1, GL_FALSE, glm::value_ptr(view));
+    GLint locProj = glGetUniformLocation(blinnProgram_, "projection");
+    if (locProj >= 0) glUniformMatrix4fv(locProj, 1, GL_FALSE, glm::value_ptr(proj));
 
     GLint lp = glGetUniformLocation(blinnProgram_, "light.position");
     GLint lc = glGetUniformLocation(blinnProgram_, "light.color");
@@ -439,8 +482,8 @@ void Renderer::setViewProjection(const glm::mat4& view, const glm::mat4& proj) {
 
     GLint viewPosLoc = glGetUniformLocation(blinnProgram_, "viewPos");
     if (viewPosLoc >= 0) glUniform3f(viewPosLoc, camPos.x, camPos.y, camPos.z);
+    stats_.uniformUploads += liveUniforms(locView, locProj, lp, lc, li, lpp, lpc, lpi, len, viewPosLoc);
   }
-  glUseProgram(0);
 }
 
 void Renderer::setSceneLight(const glm::vec3& pos, const glm::vec3& color, float intensity) {
@@ -457,6 +500,162 @@ void Renderer::setLampLight(const glm::vec3& pos, const glm::vec3& color, float
   lampEnabled_ = enabled;
 }
 
+void Renderer::applyObjectId(unsigned int program) {
+  GLint idLoc = glGetUniformLocation(program, "uObjectId");
+  if (idLoc >= 0) glUniform1ui(idLoc, objectId_);
+  stats_.uniformUploads += liveUniforms(idLoc);
+}
+
+void Renderer::setIdBufferEnabled(bool enabled) {
+  if (enabled == idBufferEnabled_) return;
+  idBufferEnabled_ = enabled;
+  // targets are (re)created lazily by beginScene at the current framebuffer size
+  if (!enabled) destroyIdTargets();
+}
+
+bool Renderer::createIdTargets(int width, int height) {
+  destroyIdTargets();
+
+  // pooled: toggling picking or resizing back to an earlier size reuses the old storage
+  sceneColorTex_ = GlResourcePool::acquireTexture(MemoryCategory::RenderTargets, GL_RGBA8, width, height);
+  GlBindings::bindTexture2D(sceneColorTex_, &stats_);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  sceneIdTex_ = GlResourcePool::acquireTexture(MemoryCategory::RenderTargets, GL_R32UI, width, height);
+  GlBindings::bindTexture2D(sceneIdTex_, &stats_);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  GlBindings::bindTexture2D(0, &stats_);
+
+  sceneDepthRb_ = GlRenderbuffer::create();
+  glBindRenderbuffer(GL_RENDERBUFFER, sceneDepthRb_);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+  MemoryLedger::trackGl(MemoryCategory::RenderTargets, GlObjectType::Renderbuffer, sceneDepthRb_, size_t(4) * width * height);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  sceneFbo_ = GlFramebuffer::create();
+  glBindFramebuffer(GL_FRAMEBUFFER, sceneFbo_);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sceneColorTex_, 0);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, sceneIdTex_, 0);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, sceneDepthRb_);
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "ID buffer framebuffer incomplete (0x" << std::hex << status << std::dec << "); GPU picking disabled" << std::endl;
+    destroyIdTargets();
+    return false;
+  }
+
+  for (PickSlot& slot : pickSlots_) {
+    slot.pbo = GlBuffer::create();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(GLuint), nullptr, GL_STREAM_READ);
+    MemoryLedger::trackGl(MemoryCategory::RenderTargets, GlObjectType::Buffer, slot.pbo, sizeof(GLuint));
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  sceneWidth_ = width;
+  sceneHeight_ = height;
+  return true;
+}
+
+void Renderer::destroyIdTargets() {
+  for (PickSlot& slot : pickSlots_) {
+    if (slot.fence) glDeleteSync(slot.fence);
+    slot = PickSlot{};
+  }
+  pickHead_ = 0;
+  pickCount_ = 0;
+  pickRequested_ = false;
+  // the blit and pick reads of earlier frames may still use these; the deletion queue waits for them
+  sceneFbo_.reset();
+  sceneColorTex_.reset();
+  sceneIdTex_.reset();
+  sceneDepthRb_.reset();
+  sceneWidth_ = sceneHeight_ = 0;
+}
+
+void Renderer::beginScene(int width, int height) {
+  sceneActive_ = false;
+  if (!idBufferEnabled_ || width <= 0 || height <= 0) return;
+  if ((width != sceneWidth_ || height != sceneHeight_) && !createIdTargets(width, height)) {
+    idBufferEnabled_ = false;
+    return;
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, sceneFbo_);
+  const GLenum buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+  glDrawBuffers(2, buffers);
+  // glClear would write float values into the integer attachment, so clear each buffer explicitly
+  GLfloat clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+  const GLuint noObject[4] = { 0, 0, 0, 0 };
+  const GLfloat farDepth = 1.0f;
+  glClearBufferfv(GL_COLOR, 0, clearColor);
+  glClearBufferuiv(GL_COLOR, 1, noObject);
+  glClearBufferfv(GL_DEPTH, 0, &farDepth);
+  sceneActive_ = true;
+}
+
+void Renderer::endScene() {
+  if (!sceneActive_) return;
+  sceneActive_ = false;
+  if (pickRequested_) issuePickReadback();
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFbo_);
+  glReadBuffer(GL_COLOR_ATTACHMENT0);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  glBlitFramebuffer(0, 0, sceneWidth_, sceneHeight_, 0, 0, sceneWidth_, sceneHeight_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Renderer::requestPick(int x, int y) {
+  pickRequested_ = true;
+  pickX_ = x;
+  pickY_ = y;
+}
+
+void Renderer::issuePickReadback() {
+  pickRequested_ = false;
+  // every slot still in flight: drop the click rather than wait on the GPU
+  if (pickCount_ == kPickSlots) return;
+  if (pickX_ < 0 || pickY_ < 0 || pickX_ >= sceneWidth_ || pickY_ >= sceneHeight_) return;
+
+  PickSlot& slot = pickSlots_[(pickHead_ + pickCount_) % kPickSlots];
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFbo_);
+  glReadBuffer(GL_COLOR_ATTACHMENT1);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+  // with a pack buffer bound this only queues the copy; the pointer is an offset into the buffer
+  glReadPixels(pickX_, sceneHeight_ - 1 - pickY_, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  ++pickCount_;
+}
+
+bool Renderer::pollPick(unsigned int& id) {
+  if (pickCount_ == 0) return false;
+  PickSlot& slot = pickSlots_[pickHead_];
+  GLenum state = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+  if (state == GL_TIMEOUT_EXPIRED) return false;
+  glDeleteSync(slot.fence);
+  slot.fence = nullptr;
+
+  id = 0;
+  if (state != GL_WAIT_FAILED) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(GLuint), GL_MAP_READ_BIT);
+    if (data) {
+      std::memcpy(&id, data, sizeof(GLuint));
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+  pickHead_ = (pickHead_ + 1) % kPickSlots;
+  --pickCount_;
+  return true;
+}
+
 std::string Renderer::loadShaderSource(const char* path) {
   std::vector<std::string> candidates = { std::string(path), std::string("../") + path, std::string("./") + path };
   for (const auto& p : candidates) {
@@ -1,31 +1,53 @@
 #include "../Header/Renderer2D.h"
 
+#include "../Header/GlBindings.h"
 #include "../Header/Util.h"
-#include "Renderer.h"
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
 
 namespace
 {
-    void fillRectVertices(float x, float y, float w, float h, float windowWidth, float windowHeight, float* outVertices)
+    constexpr int kVertexFloats = 6;
+    constexpr int kShapeFloats = 16;
+    constexpr const char* kShapeVertexShader = "Shaders/shape.vert";
+    constexpr const char* kShapeFragmentShader = "Shaders/shape.frag";
+
+    void configureFlatArray(GLuint vao, GLuint vbo)
+    {
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, kVertexFloats * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, kVertexFloats * sizeof(float), (void*)(2 * sizeof(float)));
+        glBindVertexArray(0);
+    }
+
+    void configureShapeArray(GLuint vao, GLuint vbo)
+    {
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        for (GLuint attrib = 0; attrib < 4; ++attrib)
+        {
+            glEnableVertexAttribArray(attrib);
+            glVertexAttribPointer(attrib, 4, GL_FLOAT, GL_FALSE, kShapeFloats * sizeof(float), (void*)(attrib * 4 * sizeof(float)));
+            glVertexAttribDivisor(attrib, 1);
+        }
+        glBindVertexArray(0);
+    }
+
+    // Uploads data; when the buffer is too small it is swapped for a larger pooled one and the
+    // old one goes back to the pool. Returns true if the vertex array must be re-pointed.
+    bool uploadFloats(PooledBuffer& vbo, const std::vector<float>& data)
     {
-        // Convert from pixel coords (origin top-left) to NDC (-1..1)
-        float x0 = 2.0f * x / windowWidth - 1.0f;
-        float x1 = 2.0f * (x + w) / windowWidth - 1.0f;
-        float y0 = 1.0f - 2.0f * y / windowHeight;
-        float y1 = 1.0f - 2.0f * (y + h) / windowHeight;
-
-        // Two triangles (6 vertices)
-        outVertices[0] = x0; outVertices[1] = y0;
-        outVertices[2] = x1; outVertices[3] = y0;
-        outVertices[4] = x1; outVertices[5] = y1;
-
-        outVertices[6] = x0; outVertices[7] = y0;
-        outVertices[8] = x1; outVertices[9] = y1;
-        outVertices[10] = x0; outVertices[11] = y1;
+        size_t bytes = data.size() * sizeof(float);
+        bool replaced = bytes > vbo.capacity();
+        if (replaced) vbo = GlResourcePool::acquireBuffer(MemoryCategory::DynamicBuffers, bytes);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, data.data());
+        return replaced;
     }
 }
 
@@ -33,116 +55,154 @@ Renderer2D::Renderer2D(int windowWidth, int windowHeight, const char* vertexShad
     : m_windowWidth(static_cast<float>(windowWidth))
     , m_windowHeight(static_cast<float>(windowHeight))
 {
-    m_program = createShader(vertexShaderPath, fragmentShaderPath);
-    m_uColorLocation = glGetUniformLocation(m_program, "uColor");
+    m_program = GlProgram(createShader(vertexShaderPath, fragmentShaderPath));
 
-    glGenVertexArrays(1, &m_vao);
-    glGenBuffers(1, &m_vbo);
-    glBindVertexArray(m_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    // room for a few hundred primitives; grows on demand
+    m_vao = GlVertexArray::create();
+    m_vbo = GlResourcePool::acquireBuffer(MemoryCategory::DynamicBuffers, sizeof(float) * kVertexFloats * 1024);
+    configureFlatArray(m_vao, m_vbo);
 
-    float initialVertices[12] = { 0.0f };
-    glBufferData(GL_ARRAY_BUFFER, sizeof(initialVertices), initialVertices, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glBindVertexArray(0);
-}
+    m_vertices.reserve(static_cast<size_t>(kVertexFloats) * 1024);
 
-Renderer2D::~Renderer2D()
-{
-    if (m_vbo != 0) glDeleteBuffers(1, &m_vbo);
-    if (m_vao != 0) glDeleteVertexArrays(1, &m_vao);
-    if (m_program != 0) glDeleteProgram(m_program);
+    // Shapes: the quad corners come from gl_VertexID, so the buffer only holds per-instance data.
+    m_shapeProgram = GlProgram(createShader(kShapeVertexShader, kShapeFragmentShader));
+    m_uShapeWindowSize = glGetUniformLocation(m_shapeProgram, "uWindowSize");
+    m_shapeVao = GlVertexArray::create();
+    m_shapeVbo = GlResourcePool::acquireBuffer(MemoryCategory::DynamicBuffers, sizeof(float) * kShapeFloats * 256);
+    configureShapeArray(m_shapeVao, m_shapeVbo);
 }
 
 void Renderer2D::setWindowSize(float width, float height)
 {
+    // queued vertices are already in NDC for the old size
+    flush();
     m_windowWidth = width;
     m_windowHeight = height;
 }
 
-// Helper: convert pixel center to world position using simple mapping (pixels -> world * scale)
-static glm::vec3 pixelToWorld(float px, float py, float windowW, float windowH)
+void Renderer2D::beginBatch()
 {
-    // center origin
-    float sx = (px - windowW * 0.5f);
-    float sy = (windowH * 0.5f - py);
-    const float scale = 0.5f; // world units per pixel (empirical)
-    return glm::vec3(sx * scale, sy * scale, 80.0f); // place slightly in front of AC base
+    flush();
+    m_batching = true;
 }
 
-void Renderer2D::drawRect(float x, float y, float w, float h, const Color& color) const
+void Renderer2D::flush()
 {
-    if (renderer3D_) {
-        // draw thin box in 3D at mapped position
-        float cx = x + w * 0.5f;
-        float cy = y + h * 0.5f;
-        glm::vec3 pos = pixelToWorld(cx, cy, m_windowWidth, m_windowHeight);
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, pos);
-        model = glm::scale(model, glm::vec3(w * 0.5f, h * 0.5f, 2.0f));
-        renderer3D_->drawCube(model, glm::vec3(color.r, color.g, color.b));
-        return;
-    }
-
-    float vertices[12];
-    fillRectVertices(x, y, w, h, m_windowWidth, m_windowHeight, vertices);
+    // at most one of the two queues is non-empty, see appendVertex/appendShape
+    submitFlat();
+    submitShapes();
+    m_batching = false;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+void Renderer2D::submitFlat()
+{
+    if (m_vertices.empty()) return;
 
-    glUseProgram(m_program);
-    glUniform4f(m_uColorLocation, color.r, color.g, color.b, color.a);
+    if (uploadFloats(m_vbo, m_vertices)) configureFlatArray(m_vao, m_vbo);
+    GlBindings::useProgram(m_program, &m_stats);
     glBindVertexArray(m_vao);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    GLsizei count = static_cast<GLsizei>(m_vertices.size() / kVertexFloats);
+    glDrawArrays(GL_TRIANGLES, 0, count);
+    m_stats.bufferBytes += m_vertices.size() * sizeof(float);
+    m_stats.addDraw(GL_TRIANGLES, count);
     glBindVertexArray(0);
+    m_vertices.clear();
 }
 
-void Renderer2D::drawCircle(float cx, float cy, float radius, const Color& color, int segments) const
+void Renderer2D::submitShapes()
 {
-    if (renderer3D_) {
-        glm::vec3 pos = pixelToWorld(cx, cy, m_windowWidth, m_windowHeight);
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, pos);
-        model = glm::scale(model, glm::vec3(radius * 0.5f, radius * 0.5f, 2.0f));
-        renderer3D_->drawCube(model, glm::vec3(color.r, color.g, color.b));
-        return;
-    }
+    if (m_shapes.empty()) return;
 
-    // Fan triangulation for filled circle.
-    std::vector<float> vertices;
-    vertices.reserve((segments + 2) * 2);
+    if (uploadFloats(m_shapeVbo, m_shapes)) configureShapeArray(m_shapeVao, m_shapeVbo);
+    GlBindings::useProgram(m_shapeProgram, &m_stats);
+    glUniform2f(m_uShapeWindowSize, m_windowWidth, m_windowHeight);
+    glBindVertexArray(m_shapeVao);
+    GLsizei instances = static_cast<GLsizei>(m_shapes.size() / kShapeFloats);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instances);
+    m_stats.uniformUploads++;
+    m_stats.bufferBytes += m_shapes.size() * sizeof(float);
+    m_stats.addDraw(GL_TRIANGLE_STRIP, 4, instances);
+    glBindVertexArray(0);
+    m_shapes.clear();
+}
 
-    float centerX = 2.0f * cx / m_windowWidth - 1.0f;
-    float centerY = 1.0f - 2.0f * cy / m_windowHeight;
-    vertices.push_back(centerX);
-    vertices.push_back(centerY);
+void Renderer2D::appendShape(ShapeKind kind, float minX, float minY, float maxX, float maxY, const float (&params)[7], const Color& color)
+{
+    // keep painter's order: flat primitives queued earlier must land first
+    submitFlat();
+    // one extra pixel on every side leaves room for the anti-aliased edge
+    const float instance[kShapeFloats] = {
+        minX - 1.0f, minY - 1.0f, maxX + 1.0f, maxY + 1.0f,
+        params[0], params[1], params[2], params[3],
+        params[4], params[5], params[6], static_cast<float>(kind),
+        color.r, color.g, color.b, color.a
+    };
+    m_shapes.insert(m_shapes.end(), instance, instance + kShapeFloats);
+}
 
-    const float twoPi = 6.28318530718f;
-    for (int i = 0; i <= segments; ++i)
-    {
-        float angle = twoPi * static_cast<float>(i) / static_cast<float>(segments);
-        float px = cx + std::cos(angle) * radius;
-        float py = cy + std::sin(angle) * radius;
+void Renderer2D::appendVertex(float px, float py, const Color& color)
+{
+    submitShapes();
+
+    // Convert from pixel coords (origin top-left) to NDC (-1..1)
+    float ndcX = 2.0f * px / m_windowWidth - 1.0f;
+    float ndcY = 1.0f - 2.0f * py / m_windowHeight;
+    const float v[kVertexFloats] = { ndcX, ndcY, color.r, color.g, color.b, color.a };
+    m_vertices.insert(m_vertices.end(), v, v + kVertexFloats);
+}
 
-        float ndcX = 2.0f * px / m_windowWidth - 1.0f;
-        float ndcY = 1.0f - 2.0f * py / m_windowHeight;
+void Renderer2D::endPrimitive()
+{
+    // immediate mode: draw right away, keeping the old one-draw-per-primitive behaviour
+    if (!m_batching) flush();
+}
 
-        vertices.push_back(ndcX);
-        vertices.push_back(ndcY);
+const std::vector<float>& Renderer2D::unitCircle(int segments)
+{
+    std::vector<float>& table = m_circleTables[segments];
+    if (table.empty())
+    {
+        const float twoPi = 6.28318530718f;
+        table.reserve(static_cast<size_t>(segments + 1) * 2);
+        for (int i = 0; i <= segments; ++i)
+        {
+            float angle = twoPi * static_cast<float>(i) / static_cast<float>(segments);
+            table.push_back(std::cos(angle));
+            table.push_back(std::sin(angle));
+        }
     }
+    return table;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_DYNAMIC_DRAW);
+void Renderer2D::drawRect(float x, float y, float w, float h, const Color& color)
+{
+    // Two triangles (6 vertices)
+    appendVertex(x, y, color);
+    appendVertex(x + w, y, color);
+    appendVertex(x + w, y + h, color);
 
-    glUseProgram(m_program);
-    glUniform4f(m_uColorLocation, color.r, color.g, color.b, color.a);
-    glBindVertexArray(m_vao);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, static_cast<GLsizei>(vertices.size() / 2));
-    glBindVertexArray(0);
+    appendVertex(x, y, color);
+    appendVertex(x + w, y + h, color);
+    appendVertex(x, y + h, color);
+    endPrimitive();
+}
+
+void Renderer2D::drawCircle(float cx, float cy, float radius, const Color& color, int segments)
+{
+    if (segments < 3) return;
+
+    // Fan triangulation for filled circle, emitted as a plain triangle list so it can share a batch.
+    const std::vector<float>& unit = unitCircle(segments);
+    for (int i = 0; i < segments; ++i)
+    {
+        appendVertex(cx, cy, color);
+        appendVertex(cx + unit[i * 2] * radius, cy + unit[i * 2 + 1] * radius, color);
+        appendVertex(cx + unit[i * 2 + 2] * radius, cy + unit[i * 2 + 3] * radius, color);
+    }
+    endPrimitive();
 }
 
-void Renderer2D::drawFrame(const RectShape& rect, float thickness) const
+void Renderer2D::drawFrame(const RectShape& rect, float thickness)
 {
     drawRect(rect.x, rect.y, rect.w, thickness, rect.color); // top
     drawRect(rect.x, rect.y + rect.h - thickness, rect.w, thickness, rect.color); // bottom
@@ -150,45 +210,61 @@ void Renderer2D::drawFrame(const RectShape& rect, float thickness) const
     drawRect(rect.x + rect.w - thickness, rect.y, thickness, rect.h, rect.color); // right
 }
 
-void Renderer2D::drawTriangle(float x1, float y1, float x2, float y2, float x3, float y3, const Color& color) const
+void Renderer2D::drawTriangle(float x1, float y1, float x2, float y2, float x3, float y3, const Color& color)
 {
-    if (renderer3D_) {
-        float cx = (x1 + x2 + x3) / 3.0f;
-        float cy = (y1 + y2 + y3) / 3.0f;
-        glm::vec3 pos = pixelToWorld(cx, cy, m_windowWidth, m_windowHeight);
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, pos);
-        model = glm::scale(model, glm::vec3(10.0f, 10.0f, 2.0f));
-        renderer3D_->drawCube(model, glm::vec3(color.r, color.g, color.b));
-        return;
-    }
-
-    float vertices[6];
-    auto toNdc = [&](float x, float y)
-    {
-        float ndcX = 2.0f * x / m_windowWidth - 1.0f;
-        float ndcY = 1.0f - 2.0f * y / m_windowHeight;
-        return std::pair<float, float>(ndcX, ndcY);
-    };
+    appendVertex(x1, y1, color);
+    appendVertex(x2, y2, color);
+    appendVertex(x3, y3, color);
+    endPrimitive();
+}
 
-    auto p1 = toNdc(x1, y1);
-    auto p2 = toNdc(x2, y2);
-    auto p3 = toNdc(x3, y3);
+void Renderer2D::drawRoundedRect(float x, float y, float w, float h, float radius, const Color& color)
+{
+    radius = std::max(0.0f, std::min(radius, std::min(w, h) * 0.5f));
+    const float params[7] = { x + w * 0.5f, y + h * 0.5f, w * 0.5f, h * 0.5f, radius, 0.0f, 0.0f };
+    appendShape(ShapeKind::RoundedRect, x, y, x + w, y + h, params, color);
+    endPrimitive();
+}
 
-    vertices[0] = p1.first; vertices[1] = p1.second;
-    vertices[2] = p2.first; vertices[3] = p2.second;
-    vertices[4] = p3.first; vertices[5] = p3.second;
+void Renderer2D::drawDisc(float cx, float cy, float radius, const Color& color)
+{
+    const float params[7] = { cx, cy, radius, 0.0f, 0.0f, 0.0f, 0.0f };
+    appendShape(ShapeKind::Disc, cx - radius, cy - radius, cx + radius, cy + radius, params, color);
+    endPrimitive();
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+void Renderer2D::drawCapsule(float x1, float y1, float x2, float y2, float thickness, const Color& color)
+{
+    float r = thickness * 0.5f;
+    float minX = std::min(x1, x2) - r;
+    float minY = std::min(y1, y2) - r;
+    float maxX = std::max(x1, x2) + r;
+    float maxY = std::max(y1, y2) + r;
+    const float params[7] = { x1, y1, x2, y2, r, 0.0f, 0.0f };
+    appendShape(ShapeKind::Capsule, minX, minY, maxX, maxY, params, color);
+    endPrimitive();
+}
 
-    glUseProgram(m_program);
-    glUniform4f(m_uColorLocation, color.r, color.g, color.b, color.a);
-    glBindVertexArray(m_vao);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-    glBindVertexArray(0);
+void Renderer2D::drawSegment(float x1, float y1, float x2, float y2, float thickness, const Color& color)
+{
+    // the corners of a rotated box stay within half the thickness of the end points
+    float r = thickness * 0.5f;
+    float minX = std::min(x1, x2) - r;
+    float minY = std::min(y1, y2) - r;
+    float maxX = std::max(x1, x2) + r;
+    float maxY = std::max(y1, y2) + r;
+    const float params[7] = { x1, y1, x2, y2, r, 0.0f, 0.0f };
+    appendShape(ShapeKind::Segment, minX, minY, maxX, maxY, params, color);
+    endPrimitive();
 }
 
-void Renderer2D::set3DRenderer(Renderer* r) {
-    renderer3D_ = r;
+void Renderer2D::drawRoundedTriangle(float x1, float y1, float x2, float y2, float x3, float y3, float radius, const Color& color)
+{
+    float minX = std::min({ x1, x2, x3 }) - radius;
+    float minY = std::min({ y1, y2, y3 }) - radius;
+    float maxX = std::max({ x1, x2, x3 }) + radius;
+    float maxY = std::max({ y1, y2, y3 }) + radius;
+    const float params[7] = { x1, y1, x2, y2, x3, y3, radius };
+    appendShape(ShapeKind::Triangle, minX, minY, maxX, maxY, params, color);
+    endPrimitive();
 }
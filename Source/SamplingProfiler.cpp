@@ -0,0 +1,306 @@
+#include "../Header/SamplingProfiler.h"
+
+#if AC_SAMPLING_PROFILER
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <link.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr int kMaxDepth = 48;
+    constexpr size_t kMaxSamples = size_t(1) << 16;
+    constexpr int kMaxThreads = 64;
+
+    struct Sample
+    {
+        std::atomic<bool> ready{ false };
+        uint16_t thread = 0;
+        uint16_t depth = 0;
+        uintptr_t pcs[kMaxDepth]; // leaf first; the rest are return addresses
+    };
+
+    struct ThreadInfo
+    {
+        const char* name = nullptr;
+        uintptr_t stackLow = 0;
+        uintptr_t stackHigh = 0;
+    };
+
+    std::atomic<bool> g_running{ false };
+    unsigned g_hz = 0;
+    Sample* g_samples = nullptr;
+    std::atomic<uint64_t> g_next{ 0 };
+    std::atomic<uint64_t> g_dropped{ 0 };
+
+    ThreadInfo g_threads[kMaxThreads];
+    std::atomic<int> g_threadCount{ 0 };
+
+    // index into g_threads; the handler only runs on threads that set it
+    thread_local int t_thread = -1;
+
+    void readContext(const ucontext_t* context, uintptr_t& pc, uintptr_t& fp, uintptr_t& sp)
+    {
+#if defined(__x86_64__)
+        pc = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RIP]);
+        fp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RBP]);
+        sp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RSP]);
+#elif defined(__aarch64__)
+        pc = static_cast<uintptr_t>(context->uc_mcontext.pc);
+        fp = static_cast<uintptr_t>(context->uc_mcontext.regs[29]);
+        sp = static_cast<uintptr_t>(context->uc_mcontext.sp);
+#else
+        (void)context;
+        pc = 0;
+        fp = 0;
+        sp = 0;
+#endif
+    }
+
+    // Async-signal-safe: no locks, no allocation, and the walk never leaves the thread's stack.
+    void onSignal(int, siginfo_t*, void* raw)
+    {
+        if (!g_running.load(std::memory_order_relaxed) || t_thread < 0) return;
+        const int savedErrno = errno;
+        uint64_t index = g_next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= kMaxSamples)
+        {
+            g_dropped.fetch_add(1, std::memory_order_relaxed);
+            errno = savedErrno;
+            return;
+        }
+
+        Sample& s = g_samples[index];
+        const ThreadInfo& thread = g_threads[t_thread];
+        uintptr_t pc = 0;
+        uintptr_t fp = 0;
+        uintptr_t sp = 0;
+        readContext(static_cast<const ucontext_t*>(raw), pc, fp, sp);
+        int depth = 0;
+        if (pc != 0) s.pcs[depth++] = pc;
+        // Live frames sit between the interrupted stack pointer and the top of the stack; code
+        // built without frame pointers (libc, the GL driver) leaves anything in fp, so an fp
+        // outside that range ends the walk.
+        const uintptr_t low = std::max(sp, thread.stackLow);
+        // each frame starts with the caller's frame pointer followed by the return address
+        while (depth < kMaxDepth && fp >= low && fp + 2 * sizeof(uintptr_t) <= thread.stackHigh && fp % sizeof(uintptr_t) == 0)
+        {
+            const uintptr_t* frame = reinterpret_cast<const uintptr_t*>(fp);
+            const uintptr_t next = frame[0];
+            const uintptr_t ret = frame[1];
+            if (ret == 0) break;
+            s.pcs[depth++] = ret;
+            if (next <= fp) break; // stacks grow down, so callers live higher
+            fp = next;
+        }
+        s.thread = static_cast<uint16_t>(t_thread);
+        s.depth = static_cast<uint16_t>(depth);
+        s.ready.store(true, std::memory_order_release);
+        errno = savedErrno;
+    }
+
+    struct Module
+    {
+        std::string path;
+        uintptr_t base = 0;
+        std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+    };
+
+    int collectModule(dl_phdr_info* info, size_t, void* data)
+    {
+        auto& modules = *static_cast<std::vector<Module>*>(data);
+        Module m;
+        m.base = info->dlpi_addr;
+        if (info->dlpi_name && info->dlpi_name[0] != '\0')
+        {
+            m.path = info->dlpi_name;
+        }
+        else if (modules.empty())
+        {
+            // the executable comes first and has no name
+            char exe[4096];
+            ssize_t length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+            if (length > 0) m.path.assign(exe, static_cast<size_t>(length));
+        }
+        for (int i = 0; i < info->dlpi_phnum; ++i)
+        {
+            const ElfW(Phdr)& segment = info->dlpi_phdr[i];
+            if (segment.p_type != PT_LOAD || !(segment.p_flags & PF_X)) continue;
+            uintptr_t begin = info->dlpi_addr + segment.p_vaddr;
+            m.ranges.emplace_back(begin, begin + segment.p_memsz);
+        }
+        if (!m.path.empty() && !m.ranges.empty()) modules.push_back(std::move(m));
+        return 0;
+    }
+
+    // "module+0xoffset", offsets in the module's own address space as addr2line expects
+    std::string frameName(const std::vector<Module>& modules, uintptr_t pc)
+    {
+        char text[64];
+        for (const Module& m : modules)
+        {
+            for (const auto& range : m.ranges)
+            {
+                if (pc < range.first || pc >= range.second) continue;
+                std::snprintf(text, sizeof(text), "+0x%llx", static_cast<unsigned long long>(pc - m.base));
+                return m.path + text;
+            }
+        }
+        std::snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(pc));
+        return text;
+    }
+}
+
+bool SamplingProfiler::start(unsigned hz)
+{
+    if (g_running.load(std::memory_order_relaxed)) return true;
+    if (!g_samples) g_samples = new Sample[kMaxSamples];
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = &onSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0)
+    {
+        std::perror("SamplingProfiler: sigaction");
+        return false;
+    }
+    g_hz = std::max(hz, 1u);
+    g_running.store(true, std::memory_order_release);
+    return true;
+}
+
+void SamplingProfiler::stop()
+{
+    g_running.store(false, std::memory_order_release);
+}
+
+bool SamplingProfiler::running()
+{
+    return g_running.load(std::memory_order_relaxed);
+}
+
+uint64_t SamplingProfiler::sampleCount()
+{
+    return std::min<uint64_t>(g_next.load(std::memory_order_relaxed), kMaxSamples);
+}
+
+uint64_t SamplingProfiler::droppedCount()
+{
+    return g_dropped.load(std::memory_order_relaxed);
+}
+
+bool SamplingProfiler::writeFolded(const char* path)
+{
+    std::vector<Module> modules;
+    dl_iterate_phdr(&collectModule, &modules);
+
+    std::map<std::string, uint64_t> stacks;
+    const uint64_t count = sampleCount();
+    std::string stack;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        const Sample& s = g_samples[i];
+        // a handler may still be filling the last slots
+        if (!s.ready.load(std::memory_order_acquire)) continue;
+        const char* thread = g_threads[s.thread].name;
+        stack = thread ? thread : "thread";
+        for (int d = s.depth - 1; d >= 0; --d)
+        {
+            // return addresses point past the call; step back into it so lines resolve to the call site
+            stack += ';';
+            stack += frameName(modules, d == 0 ? s.pcs[d] : s.pcs[d] - 1);
+        }
+        ++stacks[stack];
+    }
+
+    FILE* out = std::fopen(path, "w");
+    if (!out) return false;
+    for (const auto& [frames, samples] : stacks) std::fprintf(out, "%s %llu\n", frames.c_str(), static_cast<unsigned long long>(samples));
+    return std::fclose(out) == 0;
+}
+
+ProfiledThread::ProfiledThread(const char* name)
+{
+    if (!g_running.load(std::memory_order_acquire)) return;
+    int index = g_threadCount.fetch_add(1, std::memory_order_relaxed);
+    if (index >= kMaxThreads) return;
+
+    ThreadInfo& info = g_threads[index];
+    info.name = name;
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0)
+    {
+        void* low = nullptr;
+        size_t size = 0;
+        if (pthread_attr_getstack(&attr, &low, &size) == 0)
+        {
+            info.stackLow = reinterpret_cast<uintptr_t>(low);
+            info.stackHigh = info.stackLow + size;
+        }
+        pthread_attr_destroy(&attr);
+    }
+    t_thread = index;
+
+    // fires on this thread only, after every 1/hz seconds of CPU time it uses
+    sigevent event;
+    std::memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event._sigev_un._tid = static_cast<pid_t>(syscall(SYS_gettid));
+    timer_t timer;
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) != 0)
+    {
+        std::fprintf(stderr, "SamplingProfiler: timer_create for thread %s failed: %s\n", name, std::strerror(errno));
+        return;
+    }
+    // tv_nsec must stay below one second, so 1 Hz is a whole second
+    const uint64_t periodNs = 1000000000ull / g_hz;
+    itimerspec interval{};
+    interval.it_interval.tv_sec = static_cast<time_t>(periodNs / 1000000000ull);
+    interval.it_interval.tv_nsec = static_cast<long>(periodNs % 1000000000ull);
+    interval.it_value = interval.it_interval;
+    if (timer_settime(timer, 0, &interval, nullptr) != 0)
+    {
+        std::fprintf(stderr, "SamplingProfiler: timer_settime for thread %s failed: %s\n", name, std::strerror(errno));
+        timer_delete(timer);
+        return;
+    }
+    static_assert(sizeof(timer_t) <= sizeof(m_timer), "timer_t does not fit");
+    std::memcpy(&m_timer, &timer, sizeof(timer));
+    m_armed = true;
+}
+
+ProfiledThread::~ProfiledThread()
+{
+    if (!m_armed) return;
+    timer_t timer;
+    std::memcpy(&timer, &m_timer, sizeof(timer));
+    timer_delete(timer);
+    t_thread = -1;
+}
+
+#else
+
+bool SamplingProfiler::start(unsigned) { return false; }
+void SamplingProfiler::stop() {}
+bool SamplingProfiler::running() { return false; }
+uint64_t SamplingProfiler::sampleCount() { return 0; }
+uint64_t SamplingProfiler::droppedCount() { return 0; }
+bool SamplingProfiler::writeFolded(const char*) { return false; }
+
+#endif
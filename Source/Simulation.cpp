@@ -0,0 +1,251 @@
+#include "../Header/Simulation.h"
+
+#include "../Header/AllocTracker.h"
+#include "../Header/JobSystem.h"
+#include "../Header/PerfCounters.h"
+#include "../Header/SamplingProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // droplet physics is cheap per drop; smaller batches cost more in scheduling than they save
+    constexpr size_t kDropletBatch = 64;
+}
+
+float SimSnapshot::alpha(std::chrono::steady_clock::time_point now) const
+{
+    if (stepSeconds <= 0.0f) return 1.0f;
+    float a = std::chrono::duration<float>(now - stepTime).count() / stepSeconds;
+    return std::min(std::max(a, 0.0f), 1.0f);
+}
+
+Simulation::Simulation(const AppState& initial, const SimWorld& world, double tickRate, int maxStepsPerFrame, JobSystem* jobs)
+    : m_state(initial)
+    , m_world(world)
+    , m_clock(tickRate, maxStepsPerFrame)
+    , m_jobs(jobs)
+{
+    m_prevVentOpenness = m_state.ventOpenness;
+    // the render thread may read before the first step lands
+    publish();
+}
+
+Simulation::~Simulation()
+{
+    stop();
+}
+
+void Simulation::start()
+{
+    if (m_running.exchange(true)) return;
+    m_thread = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop()
+{
+    if (!m_running.exchange(false)) return;
+    if (m_thread.joinable()) m_thread.join();
+}
+
+bool Simulation::push(const SimEvent& event)
+{
+    return m_events.push(event);
+}
+
+const SimSnapshot& Simulation::latest()
+{
+    m_snapshots.update();
+    return m_snapshots.front();
+}
+
+void Simulation::run()
+{
+    ProfiledThread profiled("sim");
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point last = Clock::now();
+    Clock::time_point windowStart = last;
+    Clock::duration busy{};
+
+    while (m_running.load(std::memory_order_acquire))
+    {
+        Clock::time_point now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - last).count();
+        last = now;
+
+        SimEvent event;
+        while (m_events.pop(event)) applyEvent(event);
+
+        int steps = m_clock.advance(elapsed);
+        for (int i = 0; i < steps; ++i) step(m_clock.step());
+        if (steps > 0) publish();
+
+        Clock::time_point workEnd = Clock::now();
+        busy += workEnd - now;
+        if (workEnd - windowStart >= std::chrono::seconds(1))
+        {
+            m_utilization.store(std::chrono::duration<float>(busy).count() / std::chrono::duration<float>(workEnd - windowStart).count(), std::memory_order_relaxed);
+            busy = Clock::duration{};
+            windowStart = workEnd;
+        }
+
+        // wake when the next step is due
+        double untilNext = (1.0 - static_cast<double>(m_clock.alpha())) * m_clock.step();
+        std::this_thread::sleep_until(now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(untilNext)));
+    }
+}
+
+void Simulation::applyEvent(const SimEvent& event)
+{
+    switch (event.type)
+    {
+    case SimEventType::Keys:
+        handleTemperatureInput(m_state, event.upPressed, event.downPressed);
+        handleWaterInput(m_state, event.spacePressed, event.camPos, event.camForward);
+        break;
+    case SimEventType::TogglePower:
+        if (!(event.respectLock && m_state.lockedByFullBowl)) m_state.isOn = !m_state.isOn;
+        break;
+    case SimEventType::ChangeDesiredTemp:
+        if (m_state.lockedByFullBowl) break;
+        m_state.desiredTemp += m_state.tempChangeStep * static_cast<float>(event.tempSteps);
+        if (m_state.desiredTemp < -10.0f) m_state.desiredTemp = -10.0f;
+        if (m_state.desiredTemp > 40.0f) m_state.desiredTemp = 40.0f;
+        break;
+    case SimEventType::ToggleBowl:
+        // a full bowl can only be picked up once the AC is off
+        if (m_state.waterLevel >= 0.99f && !m_state.isOn) m_state.holdingBowl = !m_state.holdingBowl;
+        break;
+    }
+}
+
+void Simulation::step(float dt)
+{
+    AllocZone zone("sim.step");
+    PerfZone perfZone("sim.step");
+    // keep the previous step so rendering can interpolate towards the current one
+    m_prevVentOpenness = m_state.ventOpenness;
+    m_prevLidAngle = m_lidAngle;
+    for (int i = 0; i < m_dropletCount; ++i) m_droplets[i].prevPos = m_droplets[i].pos;
+
+    updateVent(m_state, dt);
+    updateTemperature(m_state, dt);
+    updateWater(m_state, dt);
+    stepDroplets(dt);
+
+    // lid swings open while the AC runs
+    const float targetAngle = m_state.isOn ? 60.0f : 0.0f;
+    const float angSpeed = 90.0f; // degrees per second
+    if (m_lidAngle < targetAngle) m_lidAngle = std::min(targetAngle, m_lidAngle + angSpeed * dt);
+    else if (m_lidAngle > targetAngle) m_lidAngle = std::max(targetAngle, m_lidAngle - angSpeed * dt);
+}
+
+void Simulation::stepDroplets(float dt)
+{
+    // drops still in the air vanish once the bowl is full
+    if (m_state.waterLevel >= 1.0f) m_dropletCount = 0;
+
+    // spawn rate per second (drops) proportional to vent openness (reduced)
+    std::uniform_real_distribution<float> randX(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> randZ(-10.0f, 10.0f);
+    float spawnRate = 6.0f * m_state.ventOpenness; // drops/sec (was 12)
+    if (m_state.isOn && spawnRate > 0.0f) {
+        m_spawnAccumulator += spawnRate * dt;
+        while (m_spawnAccumulator >= 1.0f) {
+            m_spawnAccumulator -= 1.0f;
+            if (m_dropletCount == kMaxDroplets) continue;
+            DropletState& p = m_droplets[m_dropletCount++];
+            // spawn under AC bottom center (local coords)
+            float spawnY = -50.0f - 5.0f;
+            p.pos = glm::vec3(randX(m_rng), spawnY, randZ(m_rng));
+            p.prevPos = p.pos;
+            // slower initial downward velocity to avoid tunneling
+            p.vel = glm::vec3(0.0f, -60.0f - std::abs(randZ(m_rng)) * 1.0f, 0.0f);
+            p.radius = 4.0f;
+        }
+    }
+
+    // physics integration (reduced gravity); drops only touch themselves here, so batches run
+    // as jobs and the effects on the shared state are applied serially afterwards
+    const glm::vec3 gravity(0.0f, -400.0f, 0.0f); // was -980
+    auto integrate = [&](size_t begin, size_t end)
+    {
+        // allow small tolerance to avoid tunneling and accept near-misses
+        const float verticalTolerance = 4.0f;
+        const float rimTolerance = 2.0f;
+        const float innerRadius = m_world.bowlInnerRadius;
+        const float bowlTopY = m_world.bowlTopY;
+
+        for (size_t i = begin; i < end; ++i) {
+            DropletState& d = m_droplets[i];
+            d.vel += gravity * dt;
+            d.pos += d.vel * dt;
+
+            DropletFate fate = DropletFate::Falling;
+            if (d.pos.y - d.radius <= bowlTopY + verticalTolerance) {
+                // compute horizontal distance to bowl center
+                float dx = d.pos.x - m_world.bowlCenter.x;
+                float dz = d.pos.z - m_world.bowlCenter.z;
+                float distXZ = std::sqrt(dx * dx + dz * dz);
+
+                if (distXZ <= innerRadius - 1.0f) {
+                    // clearly inside
+                    fate = DropletFate::Collected;
+                } else if (d.pos.y <= bowlTopY - verticalTolerance && distXZ <= innerRadius + rimTolerance) {
+                    // tunneled through but horizontally near center -> collect
+                    fate = DropletFate::Collected;
+                } else if (distXZ <= innerRadius + rimTolerance) {
+                    // considered hitting rim: bounce outward slightly
+                    if (distXZ < 0.001f) distXZ = 0.001f;
+                    d.vel.x += (dx / distXZ) * 50.0f;
+                    d.vel.z += (dz / distXZ) * 50.0f;
+                    // and move above rim
+                    d.pos.y = bowlTopY + d.radius + 1.0f;
+                }
+            }
+
+            // kill if too low
+            if (fate == DropletFate::Falling && d.pos.y < m_world.bowlCenter.y - 1000.0f) fate = DropletFate::Lost;
+            m_dropletFate[i] = fate;
+        }
+    };
+    if (m_jobs) m_jobs->parallelFor(static_cast<size_t>(m_dropletCount), kDropletBatch, integrate);
+    else integrate(0, static_cast<size_t>(m_dropletCount));
+
+    int i = 0;
+    while (i < m_dropletCount) {
+        DropletFate fate = m_dropletFate[i];
+        if (fate == DropletFate::Falling) {
+            ++i;
+            continue;
+        }
+        if (fate == DropletFate::Collected) {
+            m_state.waterLevel += 0.0015f; // each drop adds less
+            if (m_state.waterLevel >= 1.0f) {
+                m_state.waterLevel = 1.0f;
+                m_state.isOn = false;
+                m_state.lockedByFullBowl = true;
+            }
+        }
+        // dead drops are replaced by the last one; order does not matter
+        --m_dropletCount;
+        m_droplets[i] = m_droplets[m_dropletCount];
+        m_dropletFate[i] = m_dropletFate[m_dropletCount];
+    }
+}
+
+void Simulation::publish()
+{
+    SimSnapshot& snap = m_snapshots.back();
+    snap.state = m_state;
+    std::copy(m_droplets.begin(), m_droplets.begin() + m_dropletCount, snap.droplets.begin());
+    snap.dropletCount = m_dropletCount;
+    snap.lidAngle = m_lidAngle;
+    snap.prevLidAngle = m_prevLidAngle;
+    snap.prevVentOpenness = m_prevVentOpenness;
+    snap.tick = m_clock.ticks();
+    snap.stepSeconds = m_clock.step();
+    snap.stepTime = std::chrono::steady_clock::now();
+    m_snapshots.publish();
+}
@@ -0,0 +1,196 @@
+#include "../Header/StartupGraph.h"
+
+#include "../Header/JobSystem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
+
+namespace
+{
+    // Completion channel from the workers back to the context thread.
+    struct RunState
+    {
+        JobSystem* jobs = nullptr;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::vector<int> finished;
+        JobCounter outstanding;
+    };
+}
+
+StartupGraph::StartupGraph(Clock::time_point origin)
+    : m_origin(origin)
+    , m_contextThread(std::this_thread::get_id())
+{
+}
+
+int StartupGraph::add(const char* name, Where where, std::function<void()> fn, std::initializer_list<int> after)
+{
+    int id = static_cast<int>(m_tasks.size());
+    Task task;
+    task.where = where;
+    task.fn = std::move(fn);
+    task.span.name = name;
+    for (int dependency : after)
+    {
+        // ids come from earlier add() calls, which also rules out cycles
+        assert(dependency >= 0 && dependency < id);
+        m_tasks[dependency].dependents.push_back(id);
+        ++task.pending;
+    }
+    m_tasks.push_back(std::move(task));
+    return id;
+}
+
+void StartupGraph::execute(Task& task, JobSystem& jobs)
+{
+    task.span.thread = std::this_thread::get_id() == m_contextThread ? 0 : static_cast<int>(jobs.threadIndex()) + 1;
+    task.span.start = Clock::now();
+    task.fn();
+    task.span.end = Clock::now();
+}
+
+void StartupGraph::run(JobSystem& jobs)
+{
+    // Only this thread walks the graph, so the pending counts need no synchronization; workers
+    // just hand back the ids of the tasks they finished.
+    RunState state;
+    state.jobs = &jobs;
+    const bool inlineWorkers = jobs.workerCount() == 0;
+    std::vector<int> readyContext;
+    size_t done = 0;
+
+    m_runStart = Clock::now();
+    auto dispatch = [&](int id)
+    {
+        if (m_tasks[id].where == Where::Context || inlineWorkers)
+        {
+            readyContext.push_back(id);
+            return;
+        }
+        RunState* s = &state;
+        jobs.run([this, s, id]
+        {
+            execute(m_tasks[id], *s->jobs);
+            std::lock_guard<std::mutex> lock(s->mutex);
+            s->finished.push_back(id);
+            s->wake.notify_one();
+        }, &state.outstanding);
+    };
+    auto complete = [&](int id)
+    {
+        ++done;
+        for (int dependent : m_tasks[id].dependents)
+        {
+            if (--m_tasks[dependent].pending == 0) dispatch(dependent);
+        }
+    };
+
+    for (size_t i = 0; i < m_tasks.size(); ++i)
+    {
+        if (m_tasks[i].pending == 0) dispatch(static_cast<int>(i));
+    }
+    std::vector<int> batch;
+    while (done < m_tasks.size())
+    {
+        if (!readyContext.empty())
+        {
+            // lowest id first, so context work keeps the order it was added in
+            auto next = std::min_element(readyContext.begin(), readyContext.end());
+            int id = *next;
+            readyContext.erase(next);
+            execute(m_tasks[id], jobs);
+            complete(id);
+            continue;
+        }
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.wake.wait(lock, [&] { return !state.finished.empty(); });
+            batch.swap(state.finished);
+        }
+        for (int id : batch) complete(id);
+        batch.clear();
+    }
+    // the last jobs may still be returning from their notify
+    jobs.wait(state.outstanding);
+    m_runEnd = Clock::now();
+
+    m_runTaskTime = Clock::duration::zero();
+    for (const Task& task : m_tasks)
+    {
+        m_runTaskTime += task.span.end - task.span.start;
+        m_spans.push_back(task.span);
+    }
+    m_runTasks = m_tasks.size();
+    m_tasks.clear();
+}
+
+void StartupGraph::record(const char* name, Clock::time_point start, Clock::time_point end)
+{
+    Span span;
+    span.name = name;
+    span.thread = 0;
+    span.start = start;
+    span.end = end;
+    m_spans.push_back(span);
+}
+
+void StartupGraph::markFirstFrame(Clock::time_point when)
+{
+    if (m_hasFirstFrame) return;
+    m_firstFrame = when;
+    m_hasFirstFrame = true;
+}
+
+float StartupGraph::timeToFirstFrameMs() const
+{
+    return m_hasFirstFrame ? sinceOrigin(m_firstFrame) : -1.0f;
+}
+
+float StartupGraph::sinceOrigin(Clock::time_point t) const
+{
+    return std::chrono::duration<float, std::milli>(t - m_origin).count();
+}
+
+void StartupGraph::writeReport(FILE* out) const
+{
+    using Ms = std::chrono::duration<float, std::milli>;
+    std::fprintf(out, "Startup graph: %zu tasks in %.1f ms (%.1f ms of task time)\n", m_runTasks,
+                 Ms(m_runEnd - m_runStart).count(), Ms(m_runTaskTime).count());
+    std::vector<Span> spans = m_spans;
+    std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) { return a.start < b.start; });
+    for (const Span& span : spans)
+    {
+        std::fprintf(out, "  %-20s %s %-2d at %7.1f ms  %7.1f ms\n", span.name, span.thread == 0 ? "context" : "worker ",
+                     span.thread, sinceOrigin(span.start), Ms(span.end - span.start).count());
+    }
+}
+
+bool StartupGraph::writeTrace(const char* path) const
+{
+    using Us = std::chrono::duration<double, std::micro>;
+    FILE* out = std::fopen(path, "w");
+    if (!out) return false;
+    std::fprintf(out, "{\"traceEvents\":[\n");
+    std::fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"context\"}}");
+    int maxThread = 0;
+    for (const Span& span : m_spans) maxThread = std::max(maxThread, span.thread);
+    for (int thread = 1; thread <= maxThread; ++thread)
+    {
+        std::fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"worker %d\"}}", thread, thread - 1);
+    }
+    for (const Span& span : m_spans)
+    {
+        std::fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.1f,\"dur\":%.1f}", span.name, span.thread,
+                     Us(span.start - m_origin).count(), Us(span.end - span.start).count());
+    }
+    if (m_hasFirstFrame)
+    {
+        std::fprintf(out, ",\n{\"name\":\"first frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.1f}",
+                     Us(m_firstFrame - m_origin).count());
+    }
+    std::fprintf(out, "\n]}\n");
+    return std::fclose(out) == 0;
+}
@@ -3,23 +3,6 @@
 #include <algorithm>
 #include <cmath>
 
-void handlePowerToggle(AppState& state, double mouseX, double mouseY, bool mouseDown, const CircleShape& lamp)
-{
-    // Toggle AC on lamp click; ignore if locked by full bowl.
-    if (mouseDown && !state.prevMouseDown)
-    {
-        float dx = static_cast<float>(mouseX) - lamp.x;
-        float dy = static_cast<float>(mouseY) - lamp.y;
-        float distSq = dx * dx + dy * dy;
-        if (distSq <= lamp.radius * lamp.radius && !state.lockedByFullBowl)
-        {
-            state.isOn = !state.isOn;
-        }
-    }
-
-    state.prevMouseDown = mouseDown;
-}
-
 void updateVent(AppState& state, float deltaTime)
 {
     // Animate vent toward open/closed target.
@@ -74,9 +57,9 @@ void updateTemperature(AppState& state, float deltaTime)
     }
 }
 
-void updateWater(AppState& state, float deltaTime, bool spacePressed, const glm::vec3& camPos, const glm::vec3& camForward)
+void handleWaterInput(AppState& state, bool spacePressed, const glm::vec3& camPos, const glm::vec3& camForward)
 {
-    // Fill bowl over time while AC runs; Space drains and unlocks only when holding bowl and oriented correctly.
+    // Space drains and unlocks only when holding bowl and oriented correctly.
     bool spaceEdge = spacePressed && !state.prevSpacePressed;
     if (spaceEdge)
     {
@@ -109,14 +92,15 @@ void updateWater(AppState& state, float deltaTime, bool spacePressed, const glm:
         }
     }
 
+    state.prevSpacePressed = spacePressed;
+}
+
+void updateWater(AppState& state, float deltaTime)
+{
+    // Fill bowl continuously while AC runs.
     if (state.isOn && !state.lockedByFullBowl)
     {
-        state.waterAccum += deltaTime;
-        while (state.waterAccum >= 1.0f)
-        {
-            state.waterAccum -= 1.0f;
-            state.waterLevel += state.waterFillPerSecond;
-        }
+        state.waterLevel += state.waterFillPerSecond * deltaTime;
     }
 
     if (state.waterLevel > 1.0f)
@@ -129,6 +113,4 @@ void updateWater(AppState& state, float deltaTime, bool spacePressed, const glm:
         state.isOn = false;
         state.lockedByFullBowl = true;
     }
-
-    state.prevSpacePressed = spacePressed;
 }
@@ -1,9 +1,10 @@
 #include "../Header/TemperatureUI.h"
 
 #include <algorithm>
+#include <charconv>
 #include <cmath>
 #include <cstdint>
-#include <sstream>
+#include <string>
 
 namespace
 {
@@ -14,110 +15,69 @@ namespace
         return v;
     }
 
-    // Simple flame shape built from circles and bands.
+    // Flame: a disc body with a triangular tongue, and a smaller copy inside for contrast.
     void drawHeatIcon(Renderer2D& renderer, float cx, float cy, float radius, const Color& outer, const Color& inner)
     {
-        float baseY = cy + radius * 0.04f; // slight drop to center visually
-
-        // Outer flame: layered taper made of circles and shrinking bands
-        renderer.drawCircle(cx, baseY, radius, outer);
-
-        float bandHeight = radius * 0.25f;
-        float bandWidth = radius * 1.3f;
-        for (int i = 0; i < 5; ++i)
-        {
-            float t = static_cast<float>(i);
-            float shrink = 1.0f - t * 0.18f;
-            float w = bandWidth * shrink;
-            float h = bandHeight;
-            float y = baseY + radius * 0.35f - t * (h * 0.75f);
-            renderer.drawRect(cx - w * 0.5f, y - h * 0.5f, w, h, outer);
-        }
-
-        // Inner flame: smaller droplet for contrast
-        float innerR = radius * 0.6f;
-        renderer.drawCircle(cx, baseY + innerR * 0.05f, innerR, inner);
-
-        float innerBandW = innerR * 1.1f;
-        float innerBandH = innerR * 0.35f;
-        for (int i = 0; i < 3; ++i)
-        {
-            float t = static_cast<float>(i);
-            float shrink = 1.0f - t * 0.22f;
-            float w = innerBandW * shrink;
-            float h = innerBandH;
-            float y = baseY + innerR * 0.4f - t * (h * 0.8f);
-            renderer.drawRect(cx - w * 0.5f, y - h * 0.5f, w, h, inner);
-        }
+        float bodyR = radius * 0.62f;
+        float bodyY = cy + radius * 0.3f;
+        float tipY = cy - radius;
+        renderer.drawDisc(cx, bodyY, bodyR, outer);
+        renderer.drawRoundedTriangle(cx - bodyR * 0.97f, bodyY, cx + bodyR * 0.97f, bodyY, cx, tipY, radius * 0.04f, outer);
+
+        float innerR = bodyR * 0.55f;
+        float innerY = bodyY + bodyR * 0.3f;
+        float innerTipY = bodyY - radius * 0.55f;
+        renderer.drawDisc(cx, innerY, innerR, inner);
+        renderer.drawRoundedTriangle(cx - innerR * 0.97f, innerY, cx + innerR * 0.97f, innerY, cx, innerTipY, radius * 0.03f, inner);
     }
 
+    // Snowflake: a cross of round-ended arms plus two thinner diagonals.
     void drawSnowIcon(Renderer2D& renderer, float cx, float cy, float size, const Color& color)
     {
         float arm = size * 0.48f;
         float thickness = size * 0.12f;
 
-        // Cross arms
-        renderer.drawRect(cx - thickness * 0.5f, cy - arm, thickness, arm * 2.0f, color);
-        renderer.drawRect(cx - arm, cy - thickness * 0.5f, arm * 2.0f, thickness, color);
-
-        // End caps
-        float cap = thickness * 1.2f;
-        renderer.drawRect(cx - cap * 0.5f, cy - arm - cap * 0.5f, cap, cap, color);
-        renderer.drawRect(cx - cap * 0.5f, cy + arm - cap * 0.5f, cap, cap, color);
-        renderer.drawRect(cx - arm - cap * 0.5f, cy - cap * 0.5f, cap, cap, color);
-        renderer.drawRect(cx + arm - cap * 0.5f, cy - cap * 0.5f, cap, cap, color);
-
-        // Diagonal arms made of stepped squares (since we can't rotate rects)
-        float step = thickness * 0.9f;
-        int steps = 4;
-        auto drawDiag = [&](float dxSign, float dySign)
-        {
-            for (int i = 1; i <= steps; ++i)
-            {
-                float off = step * static_cast<float>(i);
-                renderer.drawRect(cx + dxSign * off - step * 0.5f, cy + dySign * off - step * 0.5f, step, step, color);
-                renderer.drawRect(cx + dxSign * (off - step * 0.5f) - step * 0.5f, cy + dySign * (off + step * 0.5f) - step * 0.5f, step, step, color);
-            }
-        };
-
-        drawDiag(1.0f, 1.0f);
-        drawDiag(1.0f, -1.0f);
-        drawDiag(-1.0f, 1.0f);
-        drawDiag(-1.0f, -1.0f);
+        renderer.drawCapsule(cx, cy - arm, cx, cy + arm, thickness, color);
+        renderer.drawCapsule(cx - arm, cy, cx + arm, cy, thickness, color);
+
+        float diag = arm * 0.78f;
+        renderer.drawCapsule(cx - diag, cy - diag, cx + diag, cy + diag, thickness * 0.8f, color);
+        renderer.drawCapsule(cx - diag, cy + diag, cx + diag, cy - diag, thickness * 0.8f, color);
     }
 
-    // Checkmark assembled from tiny squares.
+    // Checkmark: two strokes meeting at the bottom.
     void drawCheckIcon(Renderer2D& renderer, float cx, float cy, float size, const Color& color)
     {
-        float dot = size * 0.1f;
+        float thickness = size * 0.12f;
         float startX = cx - size * 0.35f;
-        float startY = cy + size * 0.05f;
-
-        for (int i = 0; i < 4; ++i)
-        {
-            float step = static_cast<float>(i) * dot * 1.1f;
-            renderer.drawRect(startX + step, startY + step, dot, dot, color);
-        }
-
-        float midX = startX + 3.0f * dot * 1.1f;
-        float midY = startY + 3.0f * dot * 1.1f;
-        for (int i = 0; i < 6; ++i)
-        {
-            float step = static_cast<float>(i) * dot * 1.1f;
-            renderer.drawRect(midX + step, midY - step, dot, dot, color);
-        }
+        float startY = cy;
+        float midX = cx - size * 0.08f;
+        float midY = cy + size * 0.28f;
+
+        renderer.drawCapsule(startX, startY, midX, midY, thickness, color);
+        renderer.drawCapsule(midX, midY, cx + size * 0.4f, cy - size * 0.3f, thickness, color);
     }
 }
 
+StatusCategory statusCategory(float desired, float current)
+{
+    const float tolerance = 0.25f;
+    float diff = desired - current;
+    if (diff > tolerance) return StatusCategory::Heating;
+    if (diff < -tolerance) return StatusCategory::Cooling;
+    return StatusCategory::Holding;
+}
+
 void drawTemperatureValue(TextRenderer& textRenderer, float value, const RectShape& screen, const Color& color)
 {
     // Auto-scale numeric text to fit screen bounds.
     int rounded = static_cast<int>(std::round(value));
     rounded = clampInt(rounded, -99, 99);
 
-    std::ostringstream ss;
-    ss << rounded;
-    std::string text = ss.str();
+    // at most three characters, so the string stays in its small buffer
+    char digits[8];
+    std::to_chars_result printed = std::to_chars(digits, digits + sizeof(digits), rounded);
+    std::string text(digits, printed.ptr);
 
     TextMetrics metrics = textRenderer.measure(text, 1.0f);
     float baseWidth = std::max(metrics.width, 1.0f);
@@ -143,24 +103,27 @@ void drawStatusIcon(Renderer2D& renderer, const RectShape& screen, float desired
     float cy = screen.y + screen.h * 0.5f;
     float size = std::min(screen.w, screen.h) * 0.35f;
 
-    const float tolerance = 0.25f;
-    float diff = desired - current;
-
     Color heatOuter{ 0.96f, 0.46f, 0.28f, 1.0f };
     Color heatInner{ 0.99f, 0.66f, 0.32f, 1.0f };
     Color snowColor{ 0.66f, 0.85f, 0.98f, 1.0f };
     Color checkColor{ 0.38f, 0.92f, 0.58f, 1.0f };
 
-    if (diff > tolerance)
+    // icons are dozens of small primitives; collect them into one draw unless the caller already batches
+    bool ownBatch = !renderer.isBatching();
+    if (ownBatch) renderer.beginBatch();
+
+    switch (statusCategory(desired, current))
     {
+    case StatusCategory::Heating:
         drawHeatIcon(renderer, cx, cy, size, heatOuter, heatInner);
-    }
-    else if (diff < -tolerance)
-    {
+        break;
+    case StatusCategory::Cooling:
         drawSnowIcon(renderer, cx, cy, size, snowColor);
-    }
-    else
-    {
+        break;
+    case StatusCategory::Holding:
         drawCheckIcon(renderer, cx, cy, size, checkColor);
+        break;
     }
+
+    if (ownBatch) renderer.flush();
 }
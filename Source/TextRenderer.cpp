@@ -1,18 +1,34 @@
 #include "../Header/TextRenderer.h"
 
+#include "../Header/DistanceField.h"
+#include "../Header/FontAtlasCache.h"
+#include "../Header/GlBindings.h"
+#include "../Header/JobSystem.h"
 #include "../Header/Util.h"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 
 namespace
 {
     constexpr const char* kTextVertexShader = "Shaders/text.vert";
     constexpr const char* kTextFragmentShader = "Shaders/text.frag";
+    constexpr int kAtlasSize = 1024;
+    constexpr const char* kAtlasCacheDir = "cache";
+    // glyphs we preload up front, a broad set of printable ASCII so UI strings render reliably
+    constexpr const char* kPreloadCharset = " !\"#$%&'()*+,-./0123456789:;<>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
 
     static std::string detectDefaultFontPath()
     {
@@ -30,36 +46,206 @@ namespace
         }
         return std::string();
     }
+
+    // Decodes the UTF-8 sequence starting at s[i] and advances i past it.
+    // Invalid lead bytes are skipped and reported as 0.
+    uint32_t nextCodepoint(const std::string& s, size_t& i)
+    {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        auto cont = [&](size_t k) { return static_cast<uint32_t>(static_cast<unsigned char>(s[i + k]) & 0x3F); };
+        uint32_t cp = 0;
+        if (c < 0x80)
+        {
+            cp = c;
+            i += 1;
+        }
+        else if ((c >> 5) == 0x6 && i + 1 < s.size())
+        {
+            cp = ((c & 0x1Fu) << 6) | cont(1);
+            i += 2;
+        }
+        else if ((c >> 4) == 0xE && i + 2 < s.size())
+        {
+            cp = ((c & 0x0Fu) << 12) | (cont(1) << 6) | cont(2);
+            i += 3;
+        }
+        else if ((c >> 3) == 0x1E && i + 3 < s.size())
+        {
+            cp = ((c & 0x07u) << 18) | (cont(1) << 12) | (cont(2) << 6) | cont(3);
+            i += 4;
+        }
+        else
+        {
+            i += 1; // skip invalid byte
+        }
+        return cp;
+    }
+
+    // Glyph rasterized on the CPU before it is packed into the atlas. Its buffers come from
+    // `memory`, the frame arena for glyphs rasterized on demand.
+    struct RasterGlyph
+    {
+        explicit RasterGlyph(std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+            : coverage(memory)
+            , image(memory)
+        {
+        }
+
+        uint32_t codepoint = 0;
+        Glyph metrics;
+        std::pmr::vector<unsigned char> coverage;
+        std::pmr::vector<unsigned char> image; // padded cell contents (coverage or distance field)
+    };
+
+    bool rasterizeCoverage(FT_Face face, uint32_t codepoint, int maxInk, RasterGlyph& out)
+    {
+        if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER)) return false;
+
+        const FT_Bitmap& bitmap = face->glyph->bitmap;
+        out.codepoint = codepoint;
+        out.metrics.width = std::min(static_cast<int>(bitmap.width), maxInk);
+        out.metrics.height = std::min(static_cast<int>(bitmap.rows), maxInk);
+        out.metrics.bearingX = face->glyph->bitmap_left;
+        out.metrics.bearingY = face->glyph->bitmap_top;
+        out.metrics.advance = static_cast<unsigned int>(face->glyph->advance.x);
+        // FreeType rows may be padded, so copy row by row using the pitch
+        out.coverage.resize(static_cast<size_t>(out.metrics.width) * static_cast<size_t>(out.metrics.height));
+        for (int row = 0; row < out.metrics.height; ++row)
+        {
+            const unsigned char* src = bitmap.buffer + row * bitmap.pitch;
+            std::copy(src, src + out.metrics.width, out.coverage.begin() + static_cast<size_t>(row) * out.metrics.width);
+        }
+        return true;
+    }
+
+    // Writes the glyph into a cellSize x cellSize image, top-left aligned, rest cleared.
+    void buildCellImage(RasterGlyph& rg, GlyphRasterMode mode, int pad, int cellSize)
+    {
+        int w = rg.metrics.width;
+        int h = rg.metrics.height;
+        int imageW = w + pad * 2;
+        int imageH = h + pad * 2;
+        rg.image.assign(static_cast<size_t>(cellSize) * static_cast<size_t>(cellSize), 0);
+        if (w == 0 || h == 0) return;
+
+        std::pmr::vector<unsigned char> padded(static_cast<size_t>(imageW) * static_cast<size_t>(imageH), 0, rg.image.get_allocator());
+        if (mode == GlyphRasterMode::SignedDistance)
+        {
+            buildSignedDistanceField(rg.coverage.data(), w, h, pad, padded.data());
+        }
+        else
+        {
+            for (int row = 0; row < h; ++row)
+            {
+                std::copy(rg.coverage.begin() + static_cast<size_t>(row) * w, rg.coverage.begin() + static_cast<size_t>(row + 1) * w,
+                          padded.begin() + static_cast<size_t>(row + pad) * imageW + pad);
+            }
+        }
+        for (int row = 0; row < imageH; ++row)
+        {
+            std::copy(padded.begin() + static_cast<size_t>(row) * imageW, padded.begin() + static_cast<size_t>(row + 1) * imageW,
+                      rg.image.begin() + static_cast<size_t>(row) * cellSize);
+        }
+    }
+
+    // Runs body(worker, i) for every i in [0, count), on the job system when there is one;
+    // worker is the job-system slot of the thread running the item (0 without a job system).
+    template <typename Fn>
+    void parallelFor(JobSystem* jobs, size_t count, Fn body)
+    {
+        if (jobs == nullptr)
+        {
+            for (size_t i = 0; i < count; ++i) body(size_t(0), i);
+            return;
+        }
+        jobs->parallelFor(count, 1, [&](size_t begin, size_t end)
+        {
+            size_t worker = jobs->threadIndex();
+            for (size_t i = begin; i < end; ++i) body(worker, i);
+        });
+    }
+
+    // position (2), atlas uv (2), rgba (4)
+    constexpr int kVertexFloats = 8;
+
+    void writeQuad(float* dst, float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, const Color& c)
+    {
+        const float quad[6][kVertexFloats] = {
+            { x0, y1, u0, v1, c.r, c.g, c.b, c.a },
+            { x0, y0, u0, v0, c.r, c.g, c.b, c.a },
+            { x1, y0, u1, v0, c.r, c.g, c.b, c.a },
+
+            { x0, y1, u0, v1, c.r, c.g, c.b, c.a },
+            { x1, y0, u1, v0, c.r, c.g, c.b, c.a },
+            { x1, y1, u1, v1, c.r, c.g, c.b, c.a }
+        };
+        std::copy(&quad[0][0], &quad[0][0] + 6 * kVertexFloats, dst);
+    }
+
+    void appendQuad(std::vector<float>& out, float x0, float y0, float x1, float y1, const Glyph& g, const Color& c)
+    {
+        size_t at = out.size();
+        out.resize(at + 6 * kVertexFloats);
+        writeQuad(out.data() + at, x0, y0, x1, y1, g.u0, g.v0, g.u1, g.v1, c);
+    }
+
+    // Window pixels (origin top-left, +y down) to clip space.
+    glm::mat4 screenTransform(float width, float height)
+    {
+        return glm::ortho(0.0f, width, height, 0.0f, -1.0f, 1.0f);
+    }
+
+    void configureTextVertexArray(GLuint vao, GLuint vbo)
+    {
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, kVertexFloats * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, kVertexFloats * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, kVertexFloats * sizeof(float), (void*)(4 * sizeof(float)));
+        glBindVertexArray(0);
+    }
+
+    // Uploads vertices; a buffer that is too small is swapped for a larger pooled one and the
+    // vertex array re-pointed at it.
+    void uploadVertices(PooledBuffer& vbo, GLuint vao, const std::vector<float>& vertices)
+    {
+        size_t bytes = vertices.size() * sizeof(float);
+        if (bytes > vbo.capacity())
+        {
+            vbo = GlResourcePool::acquireBuffer(MemoryCategory::DynamicBuffers, bytes);
+            configureTextVertexArray(vao, vbo);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+    }
 }
 
-TextRenderer::TextRenderer(int windowWidth, int windowHeight)
+TextRenderer::TextRenderer(int windowWidth, int windowHeight, JobSystem* jobs)
     : m_windowWidth(static_cast<float>(windowWidth))
     , m_windowHeight(static_cast<float>(windowHeight))
+    , m_jobs(jobs)
 {
-    m_program = createShader(kTextVertexShader, kTextFragmentShader);
+    m_program = GlProgram(createShader(kTextVertexShader, kTextFragmentShader));
     m_uTextColor = glGetUniformLocation(m_program, "uTextColor");
-    m_uWindowSize = glGetUniformLocation(m_program, "uWindowSize");
+    m_uTransform = glGetUniformLocation(m_program, "uTransform");
     m_uTexture = glGetUniformLocation(m_program, "uTexture");
+    m_uDistanceField = glGetUniformLocation(m_program, "uDistanceField");
+    m_uOffset = glGetUniformLocation(m_program, "uOffset");
 
-    glGenVertexArrays(1, &m_vao);
-    glGenBuffers(1, &m_vbo);
-
-    glBindVertexArray(m_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
-
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glBindVertexArray(0);
+    m_vao = GlVertexArray::create();
+    m_vbo = GlResourcePool::acquireBuffer(MemoryCategory::DynamicBuffers, sizeof(float) * 6 * kVertexFloats);
+    configureTextVertexArray(m_vao, m_vbo);
 
     // Create a tiny 1x1 white fallback texture bound to texture unit 0 so shaders always have a valid texture.
     unsigned char whitePixel[4] = { 255, 255, 255, 255 };
-    glGenTextures(1, &m_blankTexture);
+    m_blankTexture = GlTexture::create();
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, m_blankTexture);
+    GlBindings::bindTexture2D(m_blankTexture, &m_stats);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, whitePixel);
+    MemoryLedger::trackGl(MemoryCategory::Textures, GlObjectType::Texture, m_blankTexture, sizeof(whitePixel));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
@@ -84,33 +270,33 @@ TextRenderer::~TextRenderer()
 
 void TextRenderer::cleanup()
 {
-    destroyGlyphTextures();
-
-    if (m_blankTexture != 0) glDeleteTextures(1, &m_blankTexture);
-    if (m_vbo != 0) glDeleteBuffers(1, &m_vbo);
-    if (m_vao != 0) glDeleteVertexArrays(1, &m_vao);
-    if (m_program != 0) glDeleteProgram(m_program);
+    destroyAtlas();
 
-    m_blankTexture = 0;
-    m_vbo = 0;
-    m_vao = 0;
-    m_program = 0;
+    m_blankTexture.reset();
+    m_vbo.reset();
+    m_vao.reset();
+    m_program.reset();
 }
 
-void TextRenderer::destroyGlyphTextures()
+void TextRenderer::destroyAtlas()
 {
-    for (auto& kv : m_glyphs)
-    {
-        if (kv.second.texture != 0)
-        {
-            glDeleteTextures(1, &kv.second.texture);
-        }
-    }
+    // runs drawn earlier this frame still sample the old atlas; the deletion queue waits for them
+    m_atlasTexture.reset();
     m_glyphs.clear();
+    m_slots.clear();
+    chargeGlyphMemory();
+    ++m_atlasGeneration;
+
+    if (m_ftFace != nullptr) FT_Done_Face(m_ftFace);
+    if (m_ftLibrary != nullptr) FT_Done_FreeType(m_ftLibrary);
+    m_ftFace = nullptr;
+    m_ftLibrary = nullptr;
 }
 
-bool TextRenderer::loadFont(const std::string& fontPath, unsigned int pixelHeight)
+bool TextRenderer::loadFont(const std::string& fontPath, unsigned int pixelHeight, GlyphRasterMode mode)
 {
+    auto startTime = std::chrono::steady_clock::now();
+
     FT_Library ft;
     if (FT_Init_FreeType(&ft))
     {
@@ -126,59 +312,332 @@ bool TextRenderer::loadFont(const std::string& fontPath, unsigned int pixelHeigh
         return false;
     }
 
+    destroyAtlas();
+    m_ftLibrary = ft;
+    m_ftFace = face;
     m_fontPath = fontPath;
     FT_Set_Pixel_Sizes(face, 0, pixelHeight);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    destroyGlyphTextures();
     m_fontPixelHeight = pixelHeight;
+    m_rasterMode = mode;
+    // distance fields need room to fall off around the outline; bitmaps only need a gutter against bleeding
+    m_glyphPadding = mode == GlyphRasterMode::SignedDistance ? std::max(4, static_cast<int>(pixelHeight) / 8) : 1;
+    m_atlasWidth = kAtlasSize;
+    m_atlasHeight = kAtlasSize;
+
+    // The baked atlas only depends on the font file contents and the bake parameters.
+    uint64_t key = 0;
+    std::string cachePath;
+    if (hashFile(fontPath, key))
+    {
+        const uint32_t params[] = { pixelHeight, static_cast<uint32_t>(mode), static_cast<uint32_t>(m_glyphPadding), static_cast<uint32_t>(kAtlasSize) };
+        key = hashBytes(params, sizeof(params), key);
+        key = hashBytes(kPreloadCharset, std::strlen(kPreloadCharset), key);
+        char name[64];
+        std::snprintf(name, sizeof(name), "fontatlas-%016llx.bin", static_cast<unsigned long long>(key));
+        cachePath = std::string(kAtlasCacheDir) + "/" + name;
+    }
+
+    bool fromCache = !cachePath.empty() && loadBakedAtlas(cachePath, key);
+    if (!fromCache && !bakeAtlas(cachePath, key))
+    {
+        destroyAtlas();
+        return false;
+    }
+
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "Font atlas " << (fromCache ? "loaded from cache" : "baked") << " in " << ms << " ms (" << m_glyphs.size() << " glyphs)\n";
+    return !m_glyphs.empty();
+}
+
+bool TextRenderer::loadBakedAtlas(const std::string& cachePath, uint64_t key)
+{
+    FontAtlasFile file;
+    if (!file.open(cachePath, key)) return false;
+    if (file.atlasWidth() != m_atlasWidth || file.atlasHeight() != m_atlasHeight) return false;
+
+    // a rejected file must leave nothing behind for bakeAtlas to build on
+    const int previousCellSize = m_cellSize;
+    auto reject = [&]()
+    {
+        m_glyphs.clear();
+        m_slots.clear();
+        m_cellSize = previousCellSize;
+        return false;
+    };
+    m_cellSize = file.cellSize();
+    if (!allocateSlots(file.glyphCount())) return reject();
+    for (size_t i = 0; i < file.glyphCount(); ++i)
+    {
+        const BakedGlyph& bg = file.glyphs()[i];
+        if (bg.slot < 0 || static_cast<size_t>(bg.slot) + 1 >= m_slots.size()) return reject();
+        Glyph glyph;
+        glyph.width = bg.width;
+        glyph.height = bg.height;
+        glyph.bearingX = bg.bearingX;
+        glyph.bearingY = bg.bearingY;
+        glyph.advance = bg.advance;
+        pinGlyph(bg.slot, bg.codepoint, glyph);
+    }
+    pinSolidCell();
 
-    // preload a broad set of common printable ASCII characters so UI strings render reliably
-    const std::string charset = " !\"#$%&'()*+,-./0123456789:;<>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~"; // glyphs we preload up front
-    for (char c : charset)
+    // pixels come straight from the mapping, including the solid cell
+    uploadAtlas(file.pixels());
+    return true;
+}
+
+bool TextRenderer::bakeAtlas(const std::string& cachePath, uint64_t key)
+{
+    int pad = m_glyphPadding;
+    GlyphRasterMode mode = m_rasterMode;
+    size_t charCount = std::strlen(kPreloadCharset);
+
+    // FreeType faces are not thread safe, so each job-system thread rasterizes through its own
+    // face. Faces are opened on first use under a lock because FT_New_Face on a shared library
+    // must be serialized; the calling thread keeps using the main face.
+    size_t workers = m_jobs ? m_jobs->threadCount() + 1 : 1;
+    unsigned callerSlot = m_jobs ? m_jobs->threadIndex() : 0;
+    std::vector<FT_Face> faces(workers, nullptr);
+    std::vector<char> faceOpened(workers, 0);
+    std::mutex faceMutex;
+    auto faceFor = [&](size_t worker) -> FT_Face
     {
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
+        if (worker == callerSlot) return m_ftFace;
+        std::lock_guard<std::mutex> lock(faceMutex);
+        if (!faceOpened[worker])
+        {
+            faceOpened[worker] = 1;
+            if (FT_New_Face(m_ftLibrary, m_fontPath.c_str(), 0, &faces[worker]) == 0) FT_Set_Pixel_Sizes(faces[worker], 0, m_fontPixelHeight);
+            else faces[worker] = nullptr;
+        }
+        return faces[worker];
+    };
+
+    std::vector<RasterGlyph> raster(charCount);
+    std::vector<char> rasterized(charCount, 0);
+    parallelFor(m_jobs, charCount, [&](size_t worker, size_t i)
+    {
+        FT_Face face = faceFor(worker);
+        if (face == nullptr) return; // picked up serially below
+        rasterized[i] = rasterizeCoverage(face, static_cast<unsigned char>(kPreloadCharset[i]), kAtlasSize, raster[i]) ? 1 : 0;
+    });
+    for (FT_Face face : faces)
+    {
+        if (face != nullptr) FT_Done_Face(face);
+    }
+
+    int largestGlyph = static_cast<int>((m_ftFace->size->metrics.ascender - m_ftFace->size->metrics.descender) >> 6);
+    std::vector<RasterGlyph> loaded;
+    loaded.reserve(charCount);
+    for (size_t i = 0; i < charCount; ++i)
+    {
+        char c = kPreloadCharset[i];
+        if (rasterized[i] == 0 && !rasterizeCoverage(m_ftFace, static_cast<unsigned char>(c), kAtlasSize, raster[i]))
         {
             std::cout << "Failed to load glyph: " << c << "\n";
             continue;
         }
+        largestGlyph = std::max(largestGlyph, std::max(raster[i].metrics.width, raster[i].metrics.height));
+        loaded.push_back(std::move(raster[i]));
+    }
 
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Every glyph gets one equally sized cell in a single atlas that serves all text sizes;
+    // cells past the preloaded charset are handed out lazily and recycled when the atlas fills up.
+    m_cellSize = largestGlyph + pad * 2;
+    if (!allocateSlots(loaded.size())) return false;
 
-        Glyph glyph;
-        glyph.texture = texture;
-        glyph.width = face->glyph->bitmap.width;
-        glyph.height = face->glyph->bitmap.rows;
-        glyph.bearingX = face->glyph->bitmap_left;
-        glyph.bearingY = face->glyph->bitmap_top;
-        glyph.advance = static_cast<unsigned int>(face->glyph->advance.x);
+    // Distance fields are the expensive part, so spread them over worker threads.
+    parallelFor(m_jobs, loaded.size(), [&](size_t, size_t i)
+    {
+        buildCellImage(loaded[i], mode, pad, m_cellSize);
+    });
 
-        m_glyphs[c] = glyph;
+    std::vector<unsigned char> atlas(static_cast<size_t>(m_atlasWidth) * static_cast<size_t>(m_atlasHeight), 0);
+    std::vector<BakedGlyph> baked;
+    baked.reserve(loaded.size());
+    for (size_t i = 0; i < loaded.size(); ++i)
+    {
+        RasterGlyph& rg = loaded[i];
+        int slot = static_cast<int>(i);
+        int cellX = slot % m_atlasColumns * m_cellSize;
+        int cellY = slot / m_atlasColumns * m_cellSize;
+        for (int row = 0; row < m_cellSize; ++row)
+        {
+            std::copy(rg.image.begin() + static_cast<size_t>(row) * m_cellSize, rg.image.begin() + static_cast<size_t>(row + 1) * m_cellSize,
+                      atlas.begin() + static_cast<size_t>(cellY + row) * m_atlasWidth + cellX);
+        }
+        pinGlyph(slot, rg.codepoint, rg.metrics);
+
+        BakedGlyph bg;
+        bg.codepoint = rg.codepoint;
+        bg.slot = slot;
+        bg.width = rg.metrics.width;
+        bg.height = rg.metrics.height;
+        bg.bearingX = rg.metrics.bearingX;
+        bg.bearingY = rg.metrics.bearingY;
+        bg.advance = rg.metrics.advance;
+        baked.push_back(bg);
     }
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+    pinSolidCell();
+    int solidSlot = static_cast<int>(m_slots.size()) - 1;
+    int solidX = solidSlot % m_atlasColumns * m_cellSize;
+    int solidY = solidSlot / m_atlasColumns * m_cellSize;
+    for (int row = 0; row < m_cellSize; ++row)
+    {
+        std::fill_n(atlas.begin() + static_cast<size_t>(solidY + row) * m_atlasWidth + solidX, m_cellSize, static_cast<unsigned char>(255));
+    }
 
-    return !m_glyphs.empty();
+    uploadAtlas(atlas.data());
+
+    if (!cachePath.empty() && !writeFontAtlasFile(cachePath, key, m_atlasWidth, m_atlasHeight, m_cellSize, baked, atlas.data()))
+    {
+        std::cout << "Could not write font atlas cache: " << cachePath << "\n";
+    }
+    return true;
+}
+
+bool TextRenderer::allocateSlots(size_t pinnedGlyphs)
+{
+    m_atlasColumns = m_atlasWidth / m_cellSize;
+    int rows = m_atlasHeight / m_cellSize;
+    m_slots.assign(static_cast<size_t>(m_atlasColumns * rows), AtlasSlot{});
+    // one extra cell for the solid background block
+    if (m_slots.size() < pinnedGlyphs + 1)
+    {
+        std::cout << "Glyph atlas too small for font size " << m_fontPixelHeight << "\n";
+        return false;
+    }
+    return true;
+}
+
+void TextRenderer::pinGlyph(int slot, uint32_t codepoint, const Glyph& metrics)
+{
+    int pad = m_glyphPadding;
+    int cellX = slot % m_atlasColumns * m_cellSize;
+    int cellY = slot / m_atlasColumns * m_cellSize;
+
+    Glyph glyph = metrics;
+    glyph.atlasSlot = slot;
+    glyph.u0 = static_cast<float>(cellX) / static_cast<float>(m_atlasWidth);
+    glyph.v0 = static_cast<float>(cellY) / static_cast<float>(m_atlasHeight);
+    glyph.u1 = static_cast<float>(cellX + glyph.width + pad * 2) / static_cast<float>(m_atlasWidth);
+    glyph.v1 = static_cast<float>(cellY + glyph.height + pad * 2) / static_cast<float>(m_atlasHeight);
+    m_glyphs.insert(codepoint, glyph);
+
+    m_slots[slot].codepoint = codepoint;
+    m_slots[slot].used = true;
+    m_slots[slot].pinned = true;
+}
+
+void TextRenderer::pinSolidCell()
+{
+    // Last cell is reserved as a solid block; backgrounds sample its centre texel.
+    int slot = static_cast<int>(m_slots.size()) - 1;
+    int cellX = slot % m_atlasColumns * m_cellSize;
+    int cellY = slot / m_atlasColumns * m_cellSize;
+    m_solidU = (static_cast<float>(cellX) + m_cellSize * 0.5f) / static_cast<float>(m_atlasWidth);
+    m_solidV = (static_cast<float>(cellY) + m_cellSize * 0.5f) / static_cast<float>(m_atlasHeight);
+    m_slots[slot].codepoint = 0xFFFFFFFFu;
+    m_slots[slot].used = true;
+    m_slots[slot].pinned = true;
+}
+
+void TextRenderer::uploadAtlas(const unsigned char* pixels)
+{
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    m_atlasTexture = GlTexture::create();
+    GlBindings::bindTexture2D(m_atlasTexture, &m_stats);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m_atlasWidth, m_atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    m_stats.textureBytes += static_cast<uint64_t>(m_atlasWidth) * m_atlasHeight;
+    MemoryLedger::trackGl(MemoryCategory::GlyphAtlas, GlObjectType::Texture, m_atlasTexture, static_cast<size_t>(m_atlasWidth) * m_atlasHeight);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GlBindings::bindTexture2D(0, &m_stats);
+    // slots and pinned glyphs are in place by the time the atlas is uploaded
+    chargeGlyphMemory();
+}
+
+void TextRenderer::chargeGlyphMemory()
+{
+    m_glyphMemory.set(m_glyphs.memoryBytes() + m_slots.capacity() * sizeof(AtlasSlot));
+}
+
+int TextRenderer::acquireSlot()
+{
+    int victim = -1;
+    for (size_t i = 0; i < m_slots.size(); ++i)
+    {
+        const AtlasSlot& s = m_slots[i];
+        if (!s.used) return static_cast<int>(i);
+        // never evict pinned glyphs or ones already emitted by the current draw
+        if (s.pinned || s.lastUsed == m_useStamp) continue;
+        if (victim < 0 || s.lastUsed < m_slots[victim].lastUsed) victim = static_cast<int>(i);
+    }
+
+    if (victim >= 0)
+    {
+        m_glyphs.erase(m_slots[victim].codepoint);
+        m_slots[victim] = AtlasSlot{};
+        ++m_atlasGeneration;
+    }
+    return victim;
+}
+
+const Glyph* TextRenderer::rasterizeOnDemand(uint32_t codepoint)
+{
+    if (m_ftFace == nullptr || m_atlasTexture == 0) return nullptr;
+
+    int pad = m_glyphPadding;
+    RasterGlyph rg(frameMemory());
+    if (!rasterizeCoverage(m_ftFace, codepoint, m_cellSize - pad * 2, rg)) return nullptr;
+
+    int slot = acquireSlot();
+    if (slot < 0) return nullptr;
+    buildCellImage(rg, m_rasterMode, pad, m_cellSize);
+
+    // upload the whole cell so nothing from an evicted glyph bleeds in through filtering
+    int cellX = slot % m_atlasColumns * m_cellSize;
+    int cellY = slot / m_atlasColumns * m_cellSize;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GlBindings::bindTexture2D(m_atlasTexture, &m_stats);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, cellX, cellY, m_cellSize, m_cellSize, GL_RED, GL_UNSIGNED_BYTE, rg.image.data());
+    m_stats.textureBytes += static_cast<uint64_t>(m_cellSize) * m_cellSize;
+    GlBindings::bindTexture2D(0, &m_stats);
+
+    Glyph glyph = rg.metrics;
+    glyph.atlasSlot = slot;
+    glyph.u0 = static_cast<float>(cellX) / static_cast<float>(m_atlasWidth);
+    glyph.v0 = static_cast<float>(cellY) / static_cast<float>(m_atlasHeight);
+    glyph.u1 = static_cast<float>(cellX + glyph.width + pad * 2) / static_cast<float>(m_atlasWidth);
+    glyph.v1 = static_cast<float>(cellY + glyph.height + pad * 2) / static_cast<float>(m_atlasHeight);
+
+    m_slots[slot].codepoint = codepoint;
+    m_slots[slot].used = true;
+    m_slots[slot].lastUsed = m_useStamp;
+    Glyph* inserted = m_glyphs.insert(codepoint, glyph);
+    chargeGlyphMemory();
+    return inserted;
+}
+
+void TextRenderer::setFrameMemory(std::pmr::memory_resource* memory)
+{
+    m_frameMemory = memory;
+}
+
+std::pmr::memory_resource* TextRenderer::frameMemory() const
+{
+    return m_frameMemory != nullptr ? m_frameMemory : std::pmr::get_default_resource();
+}
+
+const Glyph* TextRenderer::glyphFor(uint32_t codepoint)
+{
+    const Glyph* g = m_glyphs.find(codepoint);
+    if (g == nullptr) return rasterizeOnDemand(codepoint);
+    m_slots[g->atlasSlot].lastUsed = m_useStamp;
+    return g;
 }
 
 void TextRenderer::setWindowSize(float width, float height)
@@ -187,21 +646,21 @@ void TextRenderer::setWindowSize(float width, float height)
     m_windowHeight = height;
 }
 
-TextMetrics TextRenderer::measure(const std::string& text, float scale) const
+TextMetrics TextRenderer::measure(const std::string& text, float scale)
 {
     float width = 0.0f;
     float maxAscent = 0.0f;
     float maxDescent = 0.0f;
 
-    for (char c : text)
+    for (size_t i = 0; i < text.size();)
     {
-        auto it = m_glyphs.find(c);
-        if (it == m_glyphs.end()) continue;
-        const Glyph& g = it->second;
+        uint32_t cp = nextCodepoint(text, i);
+        const Glyph* g = cp != 0 ? glyphFor(cp) : nullptr;
+        if (g == nullptr) continue;
 
-        width += (g.advance >> 6) * scale;
-        maxAscent = std::max(maxAscent, static_cast<float>(g.bearingY) * scale);
-        float descent = static_cast<float>(g.height - g.bearingY) * scale;
+        width += (g->advance >> 6) * scale;
+        maxAscent = std::max(maxAscent, static_cast<float>(g->bearingY) * scale);
+        float descent = static_cast<float>(g->height - g->bearingY) * scale;
         maxDescent = std::max(maxDescent, descent);
     }
 
@@ -218,225 +677,169 @@ TextMetrics TextRenderer::measure(const std::string& text, float scale) const
     return metrics;
 }
 
-void TextRenderer::drawText(const std::string& text, float x, float y, float scale, const Color& color)
+TextMetrics TextRenderer::layoutText(const std::string& text, float scale, const Color& color, std::vector<float>& out)
 {
-    if (m_glyphs.empty()) return;
-
-    TextMetrics m = measure(text, scale);
-    float baselineY = y + m.ascent;
-
-    glUseProgram(m_program);
-    glUniform4f(m_uTextColor, color.r, color.g, color.b, color.a);
-    glUniform2f(m_uWindowSize, m_windowWidth, m_windowHeight);
-    glUniform1i(m_uTexture, 0);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(m_vao);
-
-    float cursorX = x;
-    for (char c : text)
+    // One walk over the string: quads are placed against a baseline at y = 0 and
+    // shifted down by the ascent once it is known.
+    size_t first = out.size();
+    float pad = static_cast<float>(m_glyphPadding) * scale;
+    float cursorX = 0.0f;
+    float maxAscent = 0.0f;
+    float maxDescent = 0.0f;
+    for (size_t i = 0; i < text.size();)
     {
-        auto it = m_glyphs.find(c);
-        if (it == m_glyphs.end()) continue;
-        const Glyph& g = it->second;
+        uint32_t cp = nextCodepoint(text, i);
+        const Glyph* g = cp != 0 ? glyphFor(cp) : nullptr;
+        if (g == nullptr) continue;
 
-        float xpos = cursorX + static_cast<float>(g.bearingX) * scale;
-        float ypos = baselineY - static_cast<float>(g.bearingY) * scale;
-
-        float w = static_cast<float>(g.width) * scale;
-        float h = static_cast<float>(g.height) * scale;
-
-        float vertices[6][4] = {
-            { xpos,     ypos + h, 0.0f, 0.0f },
-            { xpos,     ypos,     0.0f, 1.0f },
-            { xpos + w, ypos,     1.0f, 1.0f },
-
-            { xpos,     ypos + h, 0.0f, 0.0f },
-            { xpos + w, ypos,     1.0f, 1.0f },
-            { xpos + w, ypos + h, 1.0f, 0.0f }
-        };
+        maxAscent = std::max(maxAscent, static_cast<float>(g->bearingY) * scale);
+        maxDescent = std::max(maxDescent, static_cast<float>(g->height - g->bearingY) * scale);
 
-        glBindTexture(GL_TEXTURE_2D, g.texture);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        cursorX += (g.advance >> 6) * scale;
-    }
-
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-}
-
-bool TextRenderer::createTextTexture(const std::string& text, const Color& textColor, const Color& bgColor, unsigned int padding, unsigned int pixelHeight, GLuint& outTexture, int& outWidth, int& outHeight)
-{
-    auto decodeUtf8 = [](const std::string& s)
-    {
-        std::vector<uint32_t> codepoints;
-        size_t i = 0;
-        while (i < s.size())
+        if (g->width > 0 && g->height > 0)
         {
-            unsigned char c = static_cast<unsigned char>(s[i]);
-            if (c < 0x80)
-            {
-                codepoints.push_back(c);
-                ++i;
-            }
-            else if ((c >> 5) == 0x6 && i + 1 < s.size())
-            {
-                uint32_t cp = ((c & 0x1F) << 6) | (static_cast<unsigned char>(s[i + 1]) & 0x3F);
-                codepoints.push_back(cp);
-                i += 2;
-            }
-            else if ((c >> 4) == 0xE && i + 2 < s.size())
-            {
-                uint32_t cp = ((c & 0x0F) << 12) | ((static_cast<unsigned char>(s[i + 1]) & 0x3F) << 6) | (static_cast<unsigned char>(s[i + 2]) & 0x3F);
-                codepoints.push_back(cp);
-                i += 3;
-            }
-            else if ((c >> 3) == 0x1E && i + 3 < s.size())
-            {
-                uint32_t cp = ((c & 0x07) << 18) | ((static_cast<unsigned char>(s[i + 1]) & 0x3F) << 12) | ((static_cast<unsigned char>(s[i + 2]) & 0x3F) << 6) | (static_cast<unsigned char>(s[i + 3]) & 0x3F);
-                codepoints.push_back(cp);
-                i += 4;
-            }
-            else
-            {
-                ++i; // skip invalid byte
-            }
+            float xpos = cursorX + static_cast<float>(g->bearingX) * scale - pad;
+            float ypos = -static_cast<float>(g->bearingY) * scale - pad;
+            float w = static_cast<float>(g->width) * scale + pad * 2.0f;
+            float h = static_cast<float>(g->height) * scale + pad * 2.0f;
+            appendQuad(out, xpos, ypos, xpos + w, ypos + h, *g, color);
         }
-        return codepoints;
-    };
 
-    std::vector<uint32_t> codepoints = decodeUtf8(text);
-    if (codepoints.empty())
-    {
-        std::cout << "No characters to render for text texture.\n";
-        return false;
+        cursorX += (g->advance >> 6) * scale;
     }
 
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft))
+    // Fallback so height is non-zero even if glyph set is incomplete.
+    if (maxAscent + maxDescent <= 0.0f && m_fontPixelHeight > 0)
     {
-        std::cout << "FreeType init failed for text texture.\n";
-        return false;
+        maxAscent = static_cast<float>(m_fontPixelHeight) * scale;
     }
-
-    FT_Face face;
-    if (FT_New_Face(ft, m_fontPath.c_str(), 0, &face))
+    for (size_t v = first; v < out.size(); v += kVertexFloats)
     {
-        std::cout << "Failed to load font for text texture: " << m_fontPath << "\n";
-        FT_Done_FreeType(ft);
-        return false;
+        out[v + 1] += maxAscent;
     }
 
-    FT_Set_Pixel_Sizes(face, 0, pixelHeight);
+    TextMetrics metrics;
+    metrics.width = cursorX;
+    metrics.ascent = maxAscent;
+    metrics.height = maxAscent + maxDescent;
+    return metrics;
+}
 
-    // Measure text
-    int width = 0;
-    int maxAscent = 0;
-    int maxDescent = 0;
-    for (uint32_t cp : codepoints)
-    {
-        if (FT_Load_Char(face, cp, FT_LOAD_RENDER))
-        {
-            std::cout << "Failed to load glyph codepoint: " << cp << "\n";
-            continue;
-        }
-        width += face->glyph->advance.x >> 6;
-        maxAscent = std::max(maxAscent, face->glyph->bitmap_top);
-        int descent = static_cast<int>(face->glyph->bitmap.rows) - face->glyph->bitmap_top;
-        maxDescent = std::max(maxDescent, descent);
-    }
+void TextRenderer::useTextProgram(const Color& tint, const glm::mat4& transform, float offsetX, float offsetY)
+{
+    GlBindings::useProgram(m_program, &m_stats);
+    glUniform4f(m_uTextColor, tint.r, tint.g, tint.b, tint.a);
+    glUniformMatrix4fv(m_uTransform, 1, GL_FALSE, glm::value_ptr(transform));
+    glUniform2f(m_uOffset, offsetX, offsetY);
+    glUniform1i(m_uTexture, 0);
+    glUniform1i(m_uDistanceField, m_rasterMode == GlyphRasterMode::SignedDistance ? 1 : 0);
 
-    if (width == 0)
-    {
-        FT_Done_Face(face);
-        FT_Done_FreeType(ft);
-        return false;
-    }
+    glActiveTexture(GL_TEXTURE0);
+    GlBindings::bindTexture2D(m_atlasTexture, &m_stats);
+    m_stats.uniformUploads += 5;
+}
 
-    width += static_cast<int>(padding) * 2;
-    int height = maxAscent + maxDescent + static_cast<int>(padding) * 2;
-    outWidth = width;
-    outHeight = height;
+void TextRenderer::drawText(const std::string& text, float x, float y, float scale, const Color& color)
+{
+    if (m_glyphs.empty() || m_atlasTexture == 0) return;
+
+    // new stamp: glyphs touched from here on are protected from eviction until the draw is issued
+    ++m_useStamp;
+    const Color white{ 1.0f, 1.0f, 1.0f, 1.0f };
+    m_vertexScratch.clear();
+    layoutText(text, scale, white, m_vertexScratch);
+    if (m_vertexScratch.empty()) return;
+
+    // All glyphs live in one atlas, so the whole string becomes a single draw.
+    uploadVertices(m_vbo, m_vao, m_vertexScratch);
+    m_stats.bufferBytes += m_vertexScratch.size() * sizeof(float);
+    useTextProgram(color, screenTransform(m_windowWidth, m_windowHeight), x, y);
+    glBindVertexArray(m_vao);
+    GLsizei count = static_cast<GLsizei>(m_vertexScratch.size() / kVertexFloats);
+    glDrawArrays(GL_TRIANGLES, 0, count);
+    m_stats.addDraw(GL_TRIANGLES, count);
+    glBindVertexArray(0);
+}
 
-    std::vector<unsigned char> pixels(static_cast<size_t>(width * height * 4), 0);
+const TextMetrics& TextRenderer::layoutRun(TextRun& run)
+{
+    if (!run.m_dirty && run.m_atlasGeneration == m_atlasGeneration) return run.m_metrics;
+    if (m_atlasTexture == 0) return run.m_metrics;
 
-    auto toByte = [](float v)
+    ++m_useStamp;
+    m_vertexScratch.clear();
+    if (run.m_hasBackground)
     {
-        float clamped = std::max(0.0f, std::min(1.0f, v));
-        return static_cast<unsigned char>(clamped * 255.0f + 0.5f);
-    };
-
-    unsigned char bgR = toByte(bgColor.r);
-    unsigned char bgG = toByte(bgColor.g);
-    unsigned char bgB = toByte(bgColor.b);
-    unsigned char bgA = toByte(bgColor.a);
-
-    unsigned char textR = toByte(textColor.r);
-    unsigned char textG = toByte(textColor.g);
-    unsigned char textB = toByte(textColor.b);
-    float textAlpha = std::max(0.0f, std::min(1.0f, textColor.a));
-
-    for (int i = 0; i < width * height; ++i)
+        // reserve the first quad so the background is drawn underneath the glyphs
+        m_vertexScratch.resize(6 * kVertexFloats);
+    }
+    run.m_metrics = layoutText(run.m_text, run.m_scale, run.m_color, m_vertexScratch);
+    if (run.m_hasBackground)
     {
-        pixels[i * 4 + 0] = bgR;
-        pixels[i * 4 + 1] = bgG;
-        pixels[i * 4 + 2] = bgB;
-        pixels[i * 4 + 3] = bgA;
+        float p = run.m_backgroundPadding;
+        writeQuad(m_vertexScratch.data(), -p, -p, run.m_metrics.width + p, run.m_metrics.height + p,
+                  m_solidU, m_solidV, m_solidU, m_solidV, run.m_background);
     }
 
-    int cursorX = static_cast<int>(padding);
-    int baseline = static_cast<int>(padding) + maxAscent;
-
-    for (uint32_t cp : codepoints)
+    if (run.m_vao == 0)
     {
-        if (FT_Load_Char(face, cp, FT_LOAD_RENDER))
-        {
-            continue;
-        }
+        run.m_vao = GlVertexArray::create();
+    }
+    if (!m_vertexScratch.empty())
+    {
+        uploadVertices(run.m_vbo, run.m_vao, m_vertexScratch);
+        m_stats.bufferBytes += m_vertexScratch.size() * sizeof(float);
+    }
+    run.m_vertexCount = static_cast<GLsizei>(m_vertexScratch.size() / kVertexFloats);
+    run.m_dirty = false;
+    run.m_atlasGeneration = m_atlasGeneration;
+    return run.m_metrics;
+}
 
-        int glyphW = face->glyph->bitmap.width;
-        int glyphH = face->glyph->bitmap.rows;
-        int bearingX = face->glyph->bitmap_left;
-        int bearingY = face->glyph->bitmap_top;
+void TextRenderer::drawRun(TextRun& run, float x, float y)
+{
+    layoutRun(run);
+    if (run.m_vertexCount == 0) return;
+
+    const Color white{ 1.0f, 1.0f, 1.0f, 1.0f };
+    useTextProgram(white, screenTransform(m_windowWidth, m_windowHeight), x, y);
+    glBindVertexArray(run.m_vao);
+    glDrawArrays(GL_TRIANGLES, 0, run.m_vertexCount);
+    m_stats.addDraw(GL_TRIANGLES, run.m_vertexCount);
+    glBindVertexArray(0);
+}
 
-        int xPos = cursorX + bearingX;
-        int yPos = baseline - bearingY;
+void TextRun::setText(const char* text)
+{
+    if (m_text == text) return;
+    m_text.assign(text);
+    m_dirty = true;
+}
 
-        for (int row = 0; row < glyphH; ++row)
-        {
-            for (int col = 0; col < glyphW; ++col)
-            {
-                unsigned char alpha = face->glyph->bitmap.buffer[row * glyphW + col];
-                if (alpha == 0) continue;
-
-                int px = xPos + col;
-                int py = yPos + row;
-                if (px < 0 || py < 0 || px >= width || py >= height) continue;
-
-                size_t idx = (static_cast<size_t>(py) * static_cast<size_t>(width) + static_cast<size_t>(px)) * 4;
-                pixels[idx + 0] = textR;
-                pixels[idx + 1] = textG;
-                pixels[idx + 2] = textB;
-                pixels[idx + 3] = static_cast<unsigned char>(std::min(255.0f, alpha * textAlpha));
-            }
-        }
+void TextRun::setText(const std::string& text)
+{
+    if (m_text == text) return;
+    m_text = text;
+    m_dirty = true;
+}
 
-        cursorX += face->glyph->advance.x >> 6;
-    }
+void TextRun::setScale(float scale)
+{
+    if (m_scale == scale) return;
+    m_scale = scale;
+    m_dirty = true;
+}
 
-    glGenTextures(1, &outTexture);
-    glBindTexture(GL_TEXTURE_2D, outTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
+void TextRun::setColor(const Color& color)
+{
+    if (m_color.r == color.r && m_color.g == color.g && m_color.b == color.b && m_color.a == color.a) return;
+    m_color = color;
+    m_dirty = true;
+}
 
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
-    return true;
+void TextRun::setBackground(const Color& color, float padding)
+{
+    m_background = color;
+    m_backgroundPadding = padding;
+    m_hasBackground = true;
+    m_dirty = true;
 }
@@ -0,0 +1,192 @@
+#include "../Header/UiLayout.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    bool sameRect(const RectShape& a, const RectShape& b)
+    {
+        return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+    }
+}
+
+void UiLayout::setRoot(UiNodeId id, const RectShape& local, const glm::vec3& worldSize)
+{
+    UiNode& n = m_nodes[index(id)];
+    n = UiNode{};
+    n.local = local;
+    n.depth = worldSize.z;
+    m_rootWorldSize[index(id)] = worldSize;
+    markDirty(id);
+}
+
+void UiLayout::addNode(UiNodeId id, UiNodeId parent, const RectShape& local, UiPlacement placement, float offset, float depth)
+{
+    // update() walks nodes in enum order, so parents must come first
+    UiNode& n = m_nodes[index(id)];
+    n = UiNode{};
+    n.parent = parent;
+    n.placement = placement;
+    n.local = local;
+    n.offset = offset;
+    n.depth = depth;
+    markDirty(id);
+}
+
+void UiLayout::setHeightScale(UiNodeId id, float scale)
+{
+    m_nodes[index(id)].heightScale = scale;
+    markDirty(id);
+}
+
+void UiLayout::setRound(UiNodeId id, bool round)
+{
+    m_nodes[index(id)].round = round;
+}
+
+void UiLayout::setLocalRect(UiNodeId id, const RectShape& local)
+{
+    UiNode& n = m_nodes[index(id)];
+    n.local.color = local.color;
+    if (sameRect(n.local, local)) return;
+    n.local = local;
+    markDirty(id);
+}
+
+void UiLayout::setColor(UiNodeId id, const Color& color)
+{
+    UiNode& n = m_nodes[index(id)];
+    n.local.color = color;
+    n.screen.color = color;
+}
+
+void UiLayout::setWindowSize(float width, float height)
+{
+    if (width == m_windowWidth && height == m_windowHeight) return;
+    m_windowWidth = width;
+    m_windowHeight = height;
+    m_offsetDirty = true;
+}
+
+void UiLayout::markDirty(UiNodeId id)
+{
+    m_nodes[index(id)].dirty = true;
+    // the scene may have grown or shrunk, which moves the centring offset
+    m_offsetDirty = true;
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        if (m_nodes[i].parent == id) markDirty(static_cast<UiNodeId>(i));
+    }
+}
+
+UiNodeId UiLayout::rootOf(UiNodeId id) const
+{
+    while (m_nodes[index(id)].parent != UiNodeId::Count) id = m_nodes[index(id)].parent;
+    return id;
+}
+
+glm::vec2 UiLayout::worldPerPixel(UiNodeId id) const
+{
+    UiNodeId root = rootOf(id);
+    const RectShape& r = m_nodes[index(root)].local;
+    const glm::vec3& size = m_rootWorldSize[index(root)];
+    return glm::vec2(r.w > 0.0f ? size.x / r.w : 0.0f, r.h > 0.0f ? size.y / r.h : 0.0f);
+}
+
+int UiLayout::update()
+{
+    if (m_offsetDirty)
+    {
+        // centre the bounding box of the whole scene in the window
+        float minX = m_nodes[0].local.x;
+        float minY = m_nodes[0].local.y;
+        float maxX = minX + m_nodes[0].local.w;
+        float maxY = minY + m_nodes[0].local.h;
+        for (const UiNode& n : m_nodes)
+        {
+            minX = std::min(minX, n.local.x);
+            minY = std::min(minY, n.local.y);
+            maxX = std::max(maxX, n.local.x + n.local.w);
+            maxY = std::max(maxY, n.local.y + n.local.h);
+        }
+        float offsetX = (m_windowWidth - (maxX - minX)) * 0.5f - minX;
+        float offsetY = (m_windowHeight - (maxY - minY)) * 0.5f - minY;
+        if (offsetX != m_offsetX || offsetY != m_offsetY)
+        {
+            m_offsetX = offsetX;
+            m_offsetY = offsetY;
+            for (UiNode& n : m_nodes) n.dirty = true;
+        }
+        m_offsetDirty = false;
+    }
+
+    int rebuilt = 0;
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        if (!m_nodes[i].dirty) continue;
+        updateNode(static_cast<UiNodeId>(i));
+        ++rebuilt;
+    }
+    return rebuilt;
+}
+
+void UiLayout::updateNode(UiNodeId id)
+{
+    UiNode& n = m_nodes[index(id)];
+    n.screen = n.local;
+    n.screen.x += m_offsetX;
+    n.screen.y += m_offsetY;
+
+    // World boxes depend only on positions relative to the parent, never on the window offset.
+    if (n.placement == UiPlacement::Root)
+    {
+        n.worldCenter = glm::vec3(0.0f);
+        n.worldHalfExtents = m_rootWorldSize[index(id)] * 0.5f;
+    }
+    else
+    {
+        const UiNode& p = m_nodes[index(n.parent)];
+        glm::vec2 scale = worldPerPixel(id);
+        float halfW = n.local.w * scale.x * 0.5f;
+        float halfH = n.local.h * scale.y * n.heightScale * 0.5f;
+        n.worldHalfExtents = glm::vec3(halfW, halfH, n.depth * 0.5f);
+
+        if (n.placement == UiPlacement::FrontFace)
+        {
+            float dx = (n.local.x + n.local.w * 0.5f) - (p.local.x + p.local.w * 0.5f);
+            float dy = (n.local.y + n.local.h * 0.5f) - (p.local.y + p.local.h * 0.5f);
+            n.worldCenter = glm::vec3(p.worldCenter.x + dx * scale.x, p.worldCenter.y - dy * scale.y, n.offset);
+        }
+        else
+        {
+            n.worldCenter = glm::vec3(p.worldCenter.x, p.worldCenter.y - p.worldHalfExtents.y - halfH - n.offset, p.worldCenter.z);
+        }
+    }
+
+    n.world = glm::translate(glm::mat4(1.0f), n.worldCenter);
+    n.world = glm::scale(n.world, n.worldHalfExtents * 2.0f);
+    n.dirty = false;
+}
+
+CircleShape UiLayout::screenCircle(UiNodeId id) const
+{
+    const RectShape& r = m_nodes[index(id)].screen;
+    return CircleShape{ r.x + r.w * 0.5f, r.y + r.h * 0.5f, std::min(r.w, r.h) * 0.5f, r.color };
+}
+
+bool UiLayout::hitTest(UiNodeId id, double px, double py) const
+{
+    const UiNode& n = m_nodes[index(id)];
+    if (n.round)
+    {
+        CircleShape c = screenCircle(id);
+        double dx = px - c.x;
+        double dy = py - c.y;
+        return dx * dx + dy * dy <= static_cast<double>(c.radius) * c.radius;
+    }
+    const RectShape& r = n.screen;
+    return px >= r.x && px <= r.x + r.w && py >= r.y && py <= r.y + r.h;
+}
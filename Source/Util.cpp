@@ -1,5 +1,9 @@
 #include "../Header/Util.h"
 
+#include "../Header/GlBindings.h"
+#include "../Header/GlHandle.h"
+#include "../Header/MemoryLedger.h"
+
 #define _CRT_SECURE_NO_WARNINGS
 #include <fstream>
 #include <sstream>
@@ -130,9 +134,11 @@ unsigned loadImageToTexture(const char* filePath) {
 
         unsigned int Texture;
         glGenTextures(1, &Texture);
-        glBindTexture(GL_TEXTURE_2D, Texture);
+        GlBindings::bindTexture2D(Texture);
         glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, TextureWidth, TextureHeight, 0, InternalFormat, GL_UNSIGNED_BYTE, ImageData);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        MemoryLedger::trackGl(MemoryCategory::Textures, GlObjectType::Texture, Texture,
+                              MemoryLedger::texelBytes(InternalFormat) * TextureWidth * TextureHeight);
+        GlBindings::bindTexture2D(0);
         // oslobadjanje memorije zauzete sa stbi_load posto vise nije potrebna
         stbi_image_free(ImageData);
         return Texture;
@@ -0,0 +1,137 @@
+// Headless replay of a scripted session. Drives the simulation, picking, command recording and
+// the frame arena the way the main loop does, without a window or GL context, and fails if
+// anything allocates once the warm-up frames are over. Needs the AC_TRACK_ALLOCATIONS build.
+#include "../Header/AllocTracker.h"
+#include "../Header/Bvh.h"
+#include "../Header/CommandBuffer.h"
+#include "../Header/FrameArena.h"
+#include "../Header/JobSystem.h"
+#include "../Header/Simulation.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int kWarmupFrames = 120;
+    constexpr int kFrames = 900;
+    constexpr double kFrameSeconds = 1.0 / 240.0; // several frames per simulation step
+
+    // Input for one frame of the script; the session switches the AC on, changes the desired
+    // temperature both ways and presses space a few times while droplets fill the bowl.
+    SimEvent scriptedKeys(int frame)
+    {
+        SimEvent keys;
+        keys.type = SimEventType::Keys;
+        keys.upPressed = frame % 90 >= 30 && frame % 90 < 35;
+        keys.downPressed = frame % 150 >= 100 && frame % 150 < 104;
+        keys.spacePressed = frame % 200 >= 180;
+        keys.camPos = glm::vec3(0.0f, 0.0f, 600.0f);
+        keys.camForward = glm::vec3(0.0f, 0.0f, -1.0f);
+        return keys;
+    }
+
+    // Flat grid of triangles standing in for the toilet model.
+    std::vector<glm::vec3> gridMesh(int cells)
+    {
+        std::vector<glm::vec3> positions;
+        for (int z = 0; z < cells; ++z)
+        {
+            for (int x = 0; x < cells; ++x)
+            {
+                glm::vec3 a(x, 0.0f, z), b(x + 1, 0.0f, z), c(x, 0.0f, z + 1), d(x + 1, 0.0f, z + 1);
+                positions.insert(positions.end(), { a, b, c, b, d, c });
+            }
+        }
+        return positions;
+    }
+}
+
+int main()
+{
+    JobSystem jobs;
+
+    TriangleBvh mesh;
+    mesh.build(gridMesh(64), &jobs);
+    SceneBvh scene;
+    const int body = scene.addBox(glm::vec3(0.0f), glm::vec3(120.0f, 50.0f, 40.0f));
+    scene.addBox(glm::vec3(0.0f, -200.0f, 0.0f), glm::vec3(60.0f, 20.0f, 60.0f));
+    const int model = scene.addMesh(&mesh, glm::translate(glm::mat4(1.0f), glm::vec3(200.0f, -220.0f, -32.0f)));
+
+    SimWorld world;
+    world.bowlCenter = glm::vec3(0.0f, -200.0f, 0.0f);
+    world.bowlTopY = -185.0f;
+    world.bowlInnerRadius = 50.0f;
+    Simulation simulation(AppState{}, world, 120.0, 8, &jobs);
+    simulation.start();
+
+    // two lists like the render thread, so recording and execution alternate as in the app
+    CommandBuffer commands[2];
+    FrameArena arena;
+    float sink = 0.0f;
+
+    for (int frame = 0; frame < kFrames; ++frame)
+    {
+        auto frameStart = std::chrono::steady_clock::now();
+        if (frame == kWarmupFrames)
+        {
+            AllocTracker::endFrame();
+            AllocTracker::setForbidden(true);
+        }
+
+        simulation.push(scriptedKeys(frame));
+        if (frame == 10) simulation.push(SimEvent{ SimEventType::TogglePower });
+        if (frame % 120 == 60)
+        {
+            SimEvent change;
+            change.type = SimEventType::ChangeDesiredTemp;
+            change.tempSteps = frame % 240 == 60 ? 1 : -1;
+            simulation.push(change);
+        }
+        const SimSnapshot& snap = simulation.latest();
+
+        // sweep a picking ray across the scene
+        float sweep = static_cast<float>(frame % 100) / 100.0f;
+        scene.setTransform(model, glm::translate(glm::mat4(1.0f), glm::vec3(200.0f + sweep * 10.0f, -220.0f, -32.0f)));
+        scene.setEnabled(body, snap.state.isOn || frame % 2 == 0);
+        scene.update();
+        RayHit hit = scene.intersect(glm::vec3(-300.0f + sweep * 600.0f, 0.0f, 600.0f), glm::vec3(0.0f, -0.3f, -1.0f));
+
+        CommandBuffer& list = commands[frame % 2];
+        int drops = snap.dropletCount;
+        for (int i = 0; i < drops; ++i)
+        {
+            glm::vec3 pos = snap.droplets[static_cast<size_t>(i)].pos;
+            list.record([&sink, pos] { sink += pos.y; });
+        }
+        list.record([&sink, &arena, hit, water = snap.state.waterLevel]
+        {
+            std::pmr::vector<float> scratch(&arena);
+            scratch.resize(1024, water);
+            sink += scratch.back() + static_cast<float>(hit.objectId);
+        });
+        list.execute();
+        arena.reset();
+        AllocTracker::endFrame();
+
+        std::this_thread::sleep_until(frameStart + std::chrono::duration<double>(kFrameSeconds));
+    }
+
+    AllocTracker::setForbidden(false);
+    simulation.stop();
+
+    uint64_t violations = AllocTracker::violations();
+    if (violations != 0)
+    {
+        std::fprintf(stderr, "replay: %llu allocations after warm-up\n", static_cast<unsigned long long>(violations));
+        AllocTracker::writeReport(stderr);
+        return 1;
+    }
+    std::printf("replay: %d frames, no allocations after warm-up (checksum %.1f)\n", kFrames - kWarmupFrames, sink);
+    return 0;
+}
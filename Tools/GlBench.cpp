@@ -0,0 +1,130 @@
+#include "../Header/GlInterpose.h"
+#include "../Header/GlHandle.h"
+#include "../Header/GlResourcePool.h"
+#include "../Header/JobSystem.h"
+#include "../Header/Renderer.h"
+#include "../Header/Renderer2D.h"
+#include "../Header/TextRenderer.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// CPU cost of the renderers with the driver taken out: every GL call lands in the interposer's
+// null backend, so this needs no GPU, display or context and runs on any CI box.
+// Usage: ac-gl-bench [frames], from the repository root so the shader paths resolve.
+int main(int argc, char** argv)
+{
+    using Clock = std::chrono::steady_clock;
+    const int frames = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 600;
+    const int width = 1920;
+    const int height = 1080;
+
+    GlInterpose::setBackend(GlInterpose::Backend::Null);
+    {
+        JobSystem jobs;
+        Renderer2D renderer(width, height, "Shaders/basic.vert", "Shaders/basic.frag");
+        TextRenderer textRenderer(width, height, &jobs);
+        Renderer renderer3D;
+        if (!renderer3D.init())
+        {
+            std::fprintf(stderr, "3D renderer failed to initialize; run from the repository root\n");
+            return 1;
+        }
+
+        glm::mat4 proj = glm::perspective(glm::radians(60.0f), static_cast<float>(width) / height, 1.0f, 5000.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 200.0f, 900.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        TextRun runs[8];
+        for (int i = 0; i < 8; ++i)
+        {
+            runs[i].setText("Retained status line " + std::to_string(i));
+            runs[i].setBackground(Color{ 0.0f, 0.0f, 0.0f, 0.5f }, 4.0f);
+        }
+
+        Clock::duration time3D{}, time2D{}, timeText{};
+        RenderStats stats;
+        uint64_t callsBefore = 0;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            // the first frame shapes runs and fills caches; time the steady state only
+            const bool measured = frame > 0;
+            if (frame == 1) callsBefore = GlInterpose::callCount();
+            const float t = static_cast<float>(frame) / 60.0f;
+
+            Clock::time_point start = Clock::now();
+            renderer3D.beginScene(width, height);
+            renderer3D.setViewProjection(view, proj);
+            for (int i = 0; i < 200; ++i)
+            {
+                glm::vec3 at(std::cos(i * 0.7f) * 400.0f, std::sin(i * 0.3f + t) * 100.0f, std::sin(i * 0.7f) * 400.0f);
+                renderer3D.drawCube(glm::scale(glm::translate(glm::mat4(1.0f), at), glm::vec3(20.0f)), glm::vec3(0.4f, 0.6f, 0.9f));
+            }
+            for (int i = 0; i < 100; ++i)
+            {
+                glm::vec3 at(i * 3.0f - 150.0f, 50.0f - std::fmod(t * 80.0f + i * 7.0f, 100.0f), 0.0f);
+                renderer3D.drawParticle(glm::scale(glm::translate(glm::mat4(1.0f), at), glm::vec3(2.0f)), glm::vec3(0.3f, 0.5f, 1.0f), 0.6f);
+            }
+            renderer3D.drawHollowBoxAt(glm::vec3(0.0f, -60.0f, 0.0f), 300.0f, 60.0f, 120.0f, 4.0f, glm::vec3(0.8f));
+            renderer3D.render();
+            renderer3D.endScene();
+            Clock::time_point after3D = Clock::now();
+
+            renderer.beginBatch();
+            for (int i = 0; i < 300; ++i)
+            {
+                const float x = static_cast<float>(i % 30) * 60.0f;
+                const float y = static_cast<float>(i / 30) * 60.0f;
+                const Color color{ 0.2f, 0.3f + 0.002f * i, 0.5f, 1.0f };
+                if (i % 3 == 0) renderer.drawRect(x, y, 50.0f, 50.0f, color);
+                else if (i % 3 == 1) renderer.drawRoundedRect(x, y, 50.0f, 50.0f, 8.0f, color);
+                else renderer.drawCircle(x + 25.0f, y + 25.0f, 20.0f, color);
+            }
+            renderer.flush();
+            Clock::time_point after2D = Clock::now();
+
+            float y = 20.0f;
+            for (TextRun& run : runs)
+            {
+                textRenderer.drawRun(run, 20.0f, y);
+                y += textRenderer.layoutRun(run).height + 4.0f;
+            }
+            textRenderer.drawText("Frame " + std::to_string(frame), 20.0f, y, 1.0f, Color{ 1.0f, 1.0f, 1.0f, 1.0f });
+            Clock::time_point afterText = Clock::now();
+
+            GlDeletionQueue::endFrame();
+            if (measured)
+            {
+                time3D += after3D - start;
+                time2D += after2D - after3D;
+                timeText += afterText - after2D;
+                stats += renderer3D.stats();
+                stats += renderer.stats();
+                stats += textRenderer.stats();
+            }
+            renderer3D.resetStats();
+            renderer.resetStats();
+            textRenderer.resetStats();
+        }
+
+        const int measuredFrames = std::max(frames - 1, 1);
+        auto perFrameUs = [&](Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count() / measuredFrames; };
+        std::printf("%d frames on the null GL backend (CPU time per frame)\n", measuredFrames);
+        std::printf("  Renderer      %8.1f us\n", perFrameUs(time3D));
+        std::printf("  Renderer2D    %8.1f us\n", perFrameUs(time2D));
+        std::printf("  TextRenderer  %8.1f us\n", perFrameUs(timeText));
+        std::printf("  GL calls %.0f, draws %u, uniform uploads %u per frame\n",
+                    static_cast<double>(GlInterpose::callCount() - callsBefore) / measuredFrames,
+                    stats.drawCalls / measuredFrames, stats.uniformUploads / measuredFrames);
+        std::printf("  program switches %u, texture binds %u per frame\n",
+                    stats.programSwitches / measuredFrames, stats.textureBinds / measuredFrames);
+    }
+    GlResourcePool::shutdown();
+    GlDeletionQueue::shutdown();
+    return 0;
+}
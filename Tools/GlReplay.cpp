@@ -0,0 +1,55 @@
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "../Header/GlInterpose.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+// Re-executes a trace recorded with AC_GL_TRACE and times the captured frame on this machine's
+// driver. Usage: ac-gl-replay trace.bin [repeats]
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s trace.bin [repeats]\n", argv[0]);
+        return 2;
+    }
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    if (!glfwInit()) return 1;
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_DEPTH_BITS, 24);
+    // the trace draws into its own targets; the window only provides the context
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(1280, 720, "ac-gl-replay", nullptr, nullptr);
+    if (!window)
+    {
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    int status = 1;
+    GlInterpose::ReplayResult result;
+    if (glewInit() == GLEW_OK && GlInterpose::replay(argv[1], repeats, result, stdout))
+    {
+        std::printf("setup calls %llu, frame calls %llu\n", static_cast<unsigned long long>(result.setupCalls),
+                    static_cast<unsigned long long>(result.frameCalls));
+        std::printf("frame CPU time: captured %.3f ms, replayed %.3f ms (average of %d)\n", result.capturedFrameMs,
+                    result.replayFrameMs, repeats > 0 ? repeats : 1);
+        if (result.nameMismatches > 0)
+        {
+            std::printf("warning: %llu generated names differ from the capture; the replay may touch the wrong objects\n",
+                        static_cast<unsigned long long>(result.nameMismatches));
+        }
+        status = 0;
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return status;
+}
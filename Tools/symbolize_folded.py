@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Resolve the module+0xoffset frames written by the sampling profiler (AC_PROFILE) to function
+names, keeping the folded format, so the result can go straight to flamegraph.pl:
+
+    python3 Tools/symbolize_folded.py profile.folded > profile.sym.folded
+    flamegraph.pl profile.sym.folded > profile.svg
+
+Needs addr2line (binutils); run it on the machine that recorded the profile so the module paths
+match. Frames whose module has no symbols are kept as they are.
+"""
+
+import collections
+import subprocess
+import sys
+
+
+def parse(lines):
+    stacks = []
+    for line in lines:
+        line = line.rstrip("\n")
+        if not line:
+            continue
+        frames, _, count = line.rpartition(" ")
+        stacks.append((frames.split(";"), int(count)))
+    return stacks
+
+
+def split_frame(frame):
+    module, sep, offset = frame.rpartition("+0x")
+    if not sep or not module:
+        return None
+    return module, "0x" + offset
+
+
+def resolve(module, offsets):
+    # one addr2line process per module; -i would add inlined callers, which folded output cannot nest
+    try:
+        result = subprocess.run(["addr2line", "-f", "-C", "-e", module] + offsets,
+                                capture_output=True, text=True, check=True)
+    except (OSError, subprocess.CalledProcessError):
+        return {}
+    lines = result.stdout.splitlines()
+    names = {}
+    for i, offset in enumerate(offsets):
+        name = lines[2 * i] if 2 * i < len(lines) else "??"
+        if name != "??":
+            names[offset] = name
+    return names
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: symbolize_folded.py profile.folded")
+    with open(sys.argv[1]) as source:
+        stacks = parse(source)
+
+    wanted = collections.defaultdict(set)
+    for frames, _ in stacks:
+        for frame in frames[1:]:  # the first entry is the thread name
+            parts = split_frame(frame)
+            if parts:
+                wanted[parts[0]].add(parts[1])
+    names = {}
+    for module, offsets in wanted.items():
+        for offset, name in resolve(module, sorted(offsets)).items():
+            names[(module, offset)] = name
+
+    # frames inside one function collapse into a single node
+    merged = collections.Counter()
+    for frames, count in stacks:
+        out = [frames[0]]
+        for frame in frames[1:]:
+            parts = split_frame(frame)
+            name = names.get(parts, frame) if parts else frame
+            out.append(name.replace(";", ":").replace(" ", "_"))
+        merged[";".join(out)] += count
+    for stack, count in sorted(merged.items()):
+        print(stack, count)
+
+
+if __name__ == "__main__":
+    main()